@@ -0,0 +1,483 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+// Cycle counts of the hot paths on the chip itself. Nothing has to be wired, the bus is an
+// in-memory stream and the MQTT client a sink that is never connected. Results are printed
+// as CSV at 115200 baud, one row per benchmark with the chip in every row, so the output of
+// several boards can be concatenated. Send a newline to restart and run them again.
+//
+// Cycles are per operation: the median, the fastest and the 90th percentile of the samples,
+// interrupts land in the upper ones. Allocations count every malloc when the core is built
+// with CONFIG_HEAP_USE_HOOKS, otherwise only operator new, Arduino String then is not counted.
+
+#include <algorithm>
+#include <esp_cpu.h>
+#include <Buffer.h>
+#include <Config.h>
+#include <TFSXW1Bridge.h>
+
+#if CONFIG_IDF_TARGET_ESP32C3
+    #define RXD2 20
+    #define TXD2 21
+    #define UART_PORT UART_NUM_1
+#elif CONFIG_IDF_TARGET_ESP32C6
+    #define RXD2 4
+    #define TXD2 5
+    #define UART_PORT UART_NUM_1
+#else
+    #define RXD2 16
+    #define TXD2 17
+    #define UART_PORT UART_NUM_2
+#endif
+
+using namespace FujitsuAC;
+using Address = TFSXW1Controller::Address;
+
+namespace {
+
+    volatile bool isCountingAllocations = false;
+    uint32_t allocationCount = 0;
+    uint32_t allocationBytes = 0;
+
+    // Bus timers move only when a benchmark advances the clock, the wake sequence takes no real time
+    class ManualClock: public Clock {
+        public:
+            uint32_t millis() override {
+                return _micros / 1000;
+            }
+
+            uint32_t micros() override {
+                return _micros;
+            }
+
+            void advanceMillis(uint32_t millis) {
+                _micros += millis * 1000;
+            }
+
+        private:
+            uint32_t _micros = 0;
+    };
+
+    // UART stand-in: fed bytes are read by Buffer, writes are discarded
+    class MemoryStream: public Stream {
+        public:
+            void feed(const uint8_t *data, size_t size) {
+                for (size_t i = 0; i < size && _size < sizeof(_data); i++) {
+                    _data[(_start + _size++) % sizeof(_data)] = data[i];
+                }
+            }
+
+            int available() override {
+                return _size;
+            }
+
+            int read() override {
+                if (0 == _size) {
+                    return -1;
+                }
+
+                uint8_t value = _data[_start];
+                _start = (_start + 1) % sizeof(_data);
+                _size--;
+
+                return value;
+            }
+
+            int peek() override {
+                return 0 == _size ? -1 : _data[_start];
+            }
+
+            size_t write(uint8_t value) override {
+                return 1;
+            }
+
+            size_t write(const uint8_t *buffer, size_t size) override {
+                return size;
+            }
+
+        private:
+            uint8_t _data[512];
+            size_t _start = 0;
+            size_t _size = 0;
+    };
+
+    // MQTT client that accepts every publish and delivers commands handed to it
+    class SinkTransport: public IMqttTransport {
+        public:
+            uint32_t messages = 0;
+            uint32_t bytes = 0;
+
+            void setServer(const char *host, uint16_t port) override {}
+            void setServer(IPAddress ip, uint16_t port) override {}
+
+            bool connect(
+                const char *clientId,
+                const char *user,
+                const char *password,
+                const char *willTopic,
+                const char *willMessage
+            ) override {
+                return true;
+            }
+
+            // the bridge then skips the network updater and leaves queued states queued
+            bool connected() override {
+                return false;
+            }
+
+            void loop() override {}
+
+            bool publish(const char *topic, const char *payload, bool retained = false) override {
+                this->messages++;
+                this->bytes += strlen(topic) + strlen(payload);
+
+                return true;
+            }
+
+            bool subscribe(const char *topic, uint8_t qos = 0) override {
+                return true;
+            }
+
+            void deliver(const char *topic, const char *payload) {
+                char topicCopy[128];
+                strlcpy(topicCopy, topic, sizeof(topicCopy));
+
+                if (this->callback) {
+                    this->callback(topicCopy, (uint8_t*) payload, strlen(payload));
+                }
+            }
+    };
+
+    // Bridge on the in-memory bus, with discovery callable on its own
+    class BenchmarkBridge: public TFSXW1Bridge {
+        public:
+            BenchmarkBridge(Config &config, IMqttTransport &mqttClient, Stream &uart, Clock &clock):
+                TFSXW1Bridge(config, mqttClient, clock),
+                _line(uart)
+            {}
+
+            void discover() {
+                this->publishDiscovery();
+            }
+
+        protected:
+            Stream* createUart() override {
+                return &_line;
+            }
+
+        private:
+            Stream &_line;
+    };
+
+    // type, three zero bytes, length, payload and checksum, as the unit sends them
+    size_t makeFrame(uint8_t type, const uint8_t *payload, size_t size, uint8_t *frame) {
+        memset(frame, 0, 5);
+
+        frame[0] = type;
+        frame[4] = size;
+        memcpy(frame + 5, payload, size);
+
+        uint16_t checksum = Buffer::checksum(frame, size + 5);
+        frame[size + 5] = (checksum >> 8) & 0xFF;
+        frame[size + 6] = checksum & 0xFF;
+
+        return size + 7;
+    }
+
+    // frame B response, the largest frame the unit sends while polling
+    size_t makeFrameBResponse(uint16_t value, uint8_t *frame) {
+        static const uint16_t addresses[] = {
+            Address::EconomyMode, Address::MinimumHeat, Address::HumanSensor, Address::Register17,
+            Address::Register18, Address::Register19, Address::Register20, Address::Register21,
+            Address::EnergySavingFan, Address::Register23, Address::Powerful, Address::OutdoorUnitLowNoise,
+            Address::CoilDry, Address::Register27, Address::Register28, Address::Register29,
+            Address::Register30, Address::Register31, Address::Register32,
+        };
+
+        uint8_t payload[1 + 4 * 19] = {0x01};
+
+        for (size_t i = 0; i < 19; i++) {
+            payload[1 + 4 * i] = (addresses[i] >> 8) & 0xFF;
+            payload[2 + 4 * i] = addresses[i] & 0xFF;
+            payload[3 + 4 * i] = (value >> 8) & 0xFF;
+            payload[4 + 4 * i] = value & 0xFF;
+        }
+
+        return makeFrame(0x03, payload, sizeof(payload), frame);
+    }
+
+    // Controller past the Init1/Init2 handshake, polling frame A next
+    void startController(TFSXW1Controller &controller, MemoryStream &uart, ManualClock &clock) {
+        const uint8_t status[] = {0x01};
+        uint8_t frames[5][8];
+
+        makeFrame(0x00, status, sizeof(status), frames[0]);
+        makeFrame(0x01, status, sizeof(status), frames[1]);
+
+        for (int i = 2; i < 5; i++) {
+            makeFrame(0x03, status, sizeof(status), frames[i]);
+        }
+
+        controller.setup();
+
+        for (int i = 0; i < 5; i++) {
+            clock.advanceMillis(400);
+            controller.loop();
+
+            uart.feed(frames[i], sizeof(frames[i]));
+            controller.loop();
+        }
+    }
+
+    constexpr int sampleCount = 101;
+    uint32_t samples[sampleCount];
+
+    // runs operation batch times per sample and prints one row
+    template<typename Operation>
+    void measure(const char *name, uint16_t batch, Operation operation) {
+        // caches, lazily created strings and queue slots
+        for (uint16_t i = 0; i < batch; i++) {
+            operation();
+        }
+
+        allocationCount = 0;
+        allocationBytes = 0;
+
+        for (int sample = 0; sample < sampleCount; sample++) {
+            isCountingAllocations = true;
+            uint32_t startedAt = esp_cpu_get_cycle_count();
+
+            for (uint16_t i = 0; i < batch; i++) {
+                operation();
+            }
+
+            uint32_t cycles = esp_cpu_get_cycle_count() - startedAt;
+            isCountingAllocations = false;
+
+            samples[sample] = cycles / batch;
+        }
+
+        std::sort(samples, samples + sampleCount);
+
+        uint32_t mhz = ESP.getCpuFreqMHz();
+        float operations = (float) sampleCount * batch;
+        uint32_t median = samples[sampleCount / 2];
+
+        Serial.printf(
+            "%s,%u,%s,%u,%u,%u,%u,%.2f,%.2f,%.1f\n",
+            ESP.getChipModel(),
+            mhz,
+            name,
+            median,
+            samples[0],
+            samples[sampleCount * 9 / 10],
+            batch * sampleCount,
+            (float) median / mhz,
+            allocationCount / operations,
+            allocationBytes / operations
+        );
+
+        // the idle task of a single core chip would trip the task watchdog
+        delay(1);
+    }
+
+    void runBenchmarks() {
+        Serial.printf(
+            "# FujitsuAC benchmark, %s rev %u, %u MHz, IDF %s, free heap %u, allocations by %s\n",
+            ESP.getChipModel(),
+            ESP.getChipRevision(),
+            ESP.getCpuFreqMHz(),
+            ESP.getSdkVersion(),
+            ESP.getFreeHeap(),
+#if CONFIG_HEAP_USE_HOOKS
+            "malloc"
+#else
+            "operator new"
+#endif
+        );
+        Serial.println("chip,mhz,benchmark,median_cycles,min_cycles,p90_cycles,operations,median_us,allocs_per_op,alloc_bytes_per_op");
+
+        ManualClock clock;
+        uint8_t frames[2][7 + 1 + 4 * 19];
+        size_t frameSize = makeFrameBResponse(0x0000, frames[0]);
+        makeFrameBResponse(0x0001, frames[1]);
+
+        // Buffer::loop: one frame B response, the gap before it ends the previous frame
+        {
+            MemoryStream uart;
+            Buffer buffer(uart, clock);
+            uint32_t validFrames = 0;
+
+            measure("buffer_loop_frame", 1, [&]() {
+                clock.advanceMillis(20);
+                uart.feed(frames[0], frameSize);
+
+                buffer.loop([&validFrames](uint8_t data[128], int size, bool isValid) {
+                    validFrames += isValid;
+                });
+            });
+        }
+
+        // parse and updateRegistries of frame B, all 19 registers change on every frame.
+        // A poll request goes out every 20th frame, as often as on the bus
+        {
+            MemoryStream uart;
+            TFSXW1Controller controller(uart, clock);
+            startController(controller, uart, clock);
+
+            uint32_t changes = 0;
+            controller.setOnRegisterChangeCallback([&changes](const RegistryTable::Register *reg) {
+                changes++;
+            });
+
+            size_t index = 0;
+
+            measure("controller_decode_frame", 1, [&]() {
+                clock.advanceMillis(20);
+                uart.feed(frames[index], frameSize);
+                index ^= 1;
+
+                controller.loop();
+            });
+
+            size_t count;
+            const RegistryTable::Register *registers = controller.getAllRegisters(count);
+            index = 0;
+
+            // RegistryTable::getRegister for every known address in turn
+            measure("registry_get_register", count, [&]() {
+                controller.getRegister(registers[index].address);
+                index = index + 1 == count ? 0 : index + 1;
+            });
+        }
+
+        MemoryStream uart;
+        SinkTransport mqttClient;
+        Config config("benchmark", UART_PORT, RXD2, TXD2, -1, -1, -1);
+        config.load();
+
+        BenchmarkBridge bridge(config, mqttClient, uart, clock);
+        bridge.setup();
+
+        // UART wake sequence, then the controller exists and entities can be described
+        while (nullptr == bridge.getController()) {
+            clock.advanceMillis(100);
+            bridge.loop();
+        }
+
+        bridge.configureMqtt();
+
+        // onRegisterChange: valueToString and the publish queue, climate registers in turn
+        {
+            static const Address addresses[] = {
+                Address::Power, Address::Mode, Address::SetpointTemp,
+                Address::FanSpeed, Address::VerticalAirflow, Address::VerticalSwing,
+            };
+
+            TFSXW1Controller *controller = bridge.getController();
+            size_t index = 0;
+
+            measure("register_to_state", 60, [&]() {
+                bridge.onRegisterChange(controller->getRegister(addresses[index]));
+                index = index + 1 == 6 ? 0 : index + 1;
+            });
+        }
+
+        // every discovery config of a connect, per entity and as one device document
+        uint32_t messages = mqttClient.messages;
+        uint32_t bytes = mqttClient.bytes;
+
+        measure("discovery_entity", 1, [&]() {
+            bridge.discover();
+        });
+
+        Serial.printf(
+            "# discovery_entity publishes %u messages, %u bytes\n",
+            (mqttClient.messages - messages) / (sampleCount + 1),
+            (mqttClient.bytes - bytes) / (sampleCount + 1)
+        );
+
+        bridge.setDiscoveryMode(DiscoveryMode::DEVICE);
+        messages = mqttClient.messages;
+        bytes = mqttClient.bytes;
+
+        measure("discovery_device", 1, [&]() {
+            bridge.discover();
+        });
+
+        Serial.printf(
+            "# discovery_device publishes %u messages, %u bytes\n",
+            (mqttClient.messages - messages) / (sampleCount + 1),
+            (mqttClient.bytes - bytes) / (sampleCount + 1)
+        );
+
+        // onMqtt: topic check, command lookup and the controller setter
+        {
+            char topic[64];
+            snprintf(topic, sizeof(topic), "fujitsu/%s/set/fan", config.getUniqueId());
+
+            bool isLow = false;
+
+            measure("mqtt_command_dispatch", 20, [&]() {
+                mqttClient.deliver(topic, isLow ? "low" : "auto");
+                isLow = !isLow;
+            });
+        }
+
+        Serial.println("# done");
+    }
+
+}
+
+#if CONFIG_HEAP_USE_HOOKS
+// called from IRAM with the flash cache possibly disabled, the counting is inlined
+extern "C" void IRAM_ATTR esp_heap_trace_alloc_hook(void *pointer, size_t size, uint32_t caps) {
+    if (isCountingAllocations) {
+        allocationCount++;
+        allocationBytes += size;
+    }
+}
+
+extern "C" void IRAM_ATTR esp_heap_trace_free_hook(void *pointer) {}
+#else
+void* operator new(size_t size) {
+    if (isCountingAllocations) {
+        allocationCount++;
+        allocationBytes += size;
+    }
+
+    void *pointer = malloc(0 == size ? 1 : size);
+
+    if (nullptr == pointer) {
+        abort();
+    }
+
+    return pointer;
+}
+
+void operator delete(void *pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t size) noexcept {
+    free(pointer);
+}
+#endif
+
+void setup() {
+    Serial.begin(115200);
+    delay(2000);
+
+    runBenchmarks();
+}
+
+void loop() {
+    // the bridge and its controller live until the restart
+    if (Serial.available() > 0 && '\n' == Serial.read()) {
+        ESP.restart();
+    }
+}
\ No newline at end of file
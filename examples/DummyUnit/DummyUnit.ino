@@ -13,16 +13,38 @@
 SoftwareSerial controllerUart(RXD2, TXD2, true); //RX, TX
 FujitsuAC::DummyUnit dummyUnit = FujitsuAC::DummyUnit(controllerUart);
 
-void onConnectionEstablished() {}
-
 void setup() {
     Serial.begin(115200);
     Serial.println("Dummy start");
 
+    // answers like a real unit by default, faults are optional
+    FujitsuAC::DummyUnit::Faults faults;
+    faults.responseDelayMillis = 20;
+    faults.dropPercent = 0;
+    faults.corruptPercent = 0;
+    faults.invalidStatusPercent = 0;
+
     controllerUart.begin(9600);
+    dummyUnit.setFaults(faults);
     dummyUnit.setup();
 }
 
 void loop() {
     dummyUnit.loop();
+
+    static uint32_t lastReportMillis = 0;
+
+    if (millis() - lastReportMillis >= 10000) {
+        lastReportMillis = millis();
+
+        const FujitsuAC::DummyUnit::Metrics &metrics = dummyUnit.getMetrics();
+        Serial.printf(
+            "received %u, answered %u, dropped %u, corrupted %u, invalid status %u\n",
+            metrics.received,
+            metrics.answered,
+            metrics.dropped,
+            metrics.corrupted,
+            metrics.invalidStatus
+        );
+    }
 }
\ No newline at end of file
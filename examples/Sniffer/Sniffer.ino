@@ -13,7 +13,9 @@
 #include <PubSubClient.h>
 
 #include <SoftwareSerial.h>
+#include <esp_timer.h>
 #include <Buffer.h>
+#include <BusTrace.h>
 
 #define WIFI_SSID "your-ssid"
 #define WIFI_PASSWORD "your-pw"
@@ -22,7 +24,19 @@
 #define MQTT_SERVER "192.168.1.100"
 #define MQTT_PORT 1883
 
-//mosquitto_sub -h 192.168.1.100 -t fujitsu/sniffer/# -v >> log.txt
+// Frames are collected into binary bus trace chunks (src/BusTrace.h) with microsecond
+// timestamps and published once a second or when a chunk is full. Chunks can be appended
+// to one file as they arrive and analysed with extras/host (fujitsu_trace_analyze):
+//
+//mosquitto_sub -h 192.168.1.100 -t fujitsu/sniffer/trace -N >> bus.fjt
+//
+// Set PUBLISH_HEX to 1 to also publish every frame as text, as earlier versions did:
+//
+//mosquitto_sub -h 192.168.1.100 -t fujitsu/sniffer/tx -t fujitsu/sniffer/rx -v >> log.txt
+#define PUBLISH_HEX 0
+
+#define TRACE_CHUNK_SIZE 1024
+#define TRACE_FLUSH_INTERVAL 1000
 
 SoftwareSerial controllerUart(16, 25, true); //RX, TX
 FujitsuAC::Buffer controllerBuffer = FujitsuAC::Buffer(controllerUart);
@@ -33,6 +47,10 @@ FujitsuAC::Buffer acBuffer = FujitsuAC::Buffer(acUart);
 WiFiClient espClient;
 PubSubClient mqttClient = PubSubClient(espClient);
 
+uint8_t traceChunk[TRACE_CHUNK_SIZE];
+FujitsuAC::BusTrace::Writer traceWriter = FujitsuAC::BusTrace::Writer(traceChunk, sizeof(traceChunk));
+unsigned long lastTraceFlush = 0;
+
 void setup() {
     WiFi.setHostname(DEVICE_NAME);
     WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
@@ -42,29 +60,38 @@ void setup() {
     }
 
     mqttClient.setServer(MQTT_SERVER, MQTT_PORT);
-    mqttClient.setBufferSize(1024);
+    // a full trace chunk, topic and MQTT header
+    mqttClient.setBufferSize(TRACE_CHUNK_SIZE + 64);
 
-    controllerBuffer.setup();
     controllerUart.begin(9600);
-
-    acBuffer.setup();
     acUart.begin(9600);
 }
 
-void onControllerFrame(uint8_t buffer[128], int size, bool isValid) {
-    String msg = String("");
+void flushTrace() {
+    if (!traceWriter.isEmpty()) {
+        mqttClient.publish("fujitsu/sniffer/trace", traceWriter.getData(), traceWriter.getSize(), false);
+    }
 
-    for (int i = 0; i < size; i++) {
-        msg += String(buffer[i], HEX);
-        if (i < size - 1) msg += " ";
+    traceWriter.clear();
+    lastTraceFlush = millis();
+}
+
+void recordFrame(FujitsuAC::BusTrace::Direction direction, uint8_t buffer[128], int size, bool isValid) {
+    uint64_t now = esp_timer_get_time();
+
+    if (0 == traceWriter.getSize()) {
+        traceWriter.begin(now);
     }
 
-    msg.toUpperCase();
+    if (!traceWriter.write(now, direction, isValid, buffer, size)) {
+        flushTrace();
 
-    mqttClient.publish("fujitsu/sniffer/tx", msg.c_str());
+        traceWriter.begin(now);
+        traceWriter.write(now, direction, isValid, buffer, size);
+    }
 }
 
-void onAcFrame(uint8_t buffer[128], int size, bool isValid) {
+void publishHex(const char *topic, uint8_t buffer[128], int size) {
     String msg = String("");
 
     for (int i = 0; i < size; i++) {
@@ -74,7 +101,23 @@ void onAcFrame(uint8_t buffer[128], int size, bool isValid) {
 
     msg.toUpperCase();
 
-    mqttClient.publish("fujitsu/sniffer/rx", msg.c_str());
+    mqttClient.publish(topic, msg.c_str());
+}
+
+void onControllerFrame(uint8_t buffer[128], int size, bool isValid) {
+    recordFrame(FujitsuAC::BusTrace::Direction::REQUEST, buffer, size, isValid);
+
+#if PUBLISH_HEX
+    publishHex("fujitsu/sniffer/tx", buffer, size);
+#endif
+}
+
+void onAcFrame(uint8_t buffer[128], int size, bool isValid) {
+    recordFrame(FujitsuAC::BusTrace::Direction::RESPONSE, buffer, size, isValid);
+
+#if PUBLISH_HEX
+    publishHex("fujitsu/sniffer/rx", buffer, size);
+#endif
 }
 
 void reconnect() {
@@ -92,4 +135,10 @@ void loop() {
 
     controllerBuffer.loop(onControllerFrame);
     acBuffer.loop(onAcFrame);
+
+    if (millis() - lastTraceFlush >= TRACE_FLUSH_INTERVAL) {
+        flushTrace();
+    }
+
+    mqttClient.loop();
 }
\ No newline at end of file
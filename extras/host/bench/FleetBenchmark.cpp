@@ -0,0 +1,610 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+// Broker load of a fleet of dongles: N emulated devices (bridge, controller and DummyUnit)
+// in one process boot against one broker, the traffic they send is counted.
+//
+//   fujitsu_fleet --devices 200 --scenario simultaneous
+//   fujitsu_fleet --devices 200 --scenario staggered --stagger 500
+//   fujitsu_fleet --devices 200 --scenario reconnect --jitter 5000
+//   fujitsu_fleet --devices 50 --broker 127.0.0.1:1883
+//
+// simultaneous  every device boots at once, as after a power outage
+// staggered     device n boots n * --stagger ms after the first one
+// reconnect     the fleet boots staggered and settles, then every connection is dropped
+//               at once, as on a broker restart, and the devices reconnect
+//
+// --jitter adds a random delay of up to that many ms to every boot and reconnect. A device
+// is online once it has published the AC state (state/temp) after connecting. Without
+// --broker the broker runs in the same process under simulated time, with --broker the
+// devices connect to a real broker and run in real time.
+
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "EmulatedDevice.h"
+#include "MemoryBroker.h"
+#include "SimulatedClock.h"
+#include "SocketMqttTransport.h"
+
+using namespace FujitsuAC;
+
+namespace {
+
+    struct Options {
+        std::string scenario = "simultaneous";
+        std::string brokerHost;
+        uint16_t brokerPort = 1883;
+        int devices = 100;
+        uint32_t staggerMillis = 1000;
+        uint32_t jitterMillis = 0;
+        uint32_t settleMillis = 10000;
+        uint32_t timeoutMillis = 300000;
+        uint32_t stepMillis = 10;
+        uint32_t seed = 1;
+        bool isTimeline = false;
+    };
+
+    enum class TopicKind: uint8_t {
+        DISCOVERY,
+        STATE,
+        DEBUG,
+        OTHER,
+        COUNT,
+    };
+
+    const char* topicKindName(int kind) {
+        switch (static_cast<TopicKind>(kind)) {
+            case TopicKind::DISCOVERY: return "discovery";
+            case TopicKind::STATE: return "state";
+            case TopicKind::DEBUG: return "debug";
+            default: return "other";
+        }
+    }
+
+    // Messages sent to the broker by the whole fleet, in 100 ms buckets from the start of a phase
+    class Traffic {
+        public:
+            static constexpr uint32_t bucketMillis = 100;
+
+            void reset(uint32_t startMillis) {
+                _startMillis = startMillis;
+                _messages.clear();
+                _bytes.clear();
+
+                for (int kind = 0; kind < static_cast<int>(TopicKind::COUNT); kind++) {
+                    _kindMessages[kind] = 0;
+                    _kindBytes[kind] = 0;
+                }
+            }
+
+            // topic and payload, the MQTT header adds a few bytes per message
+            void add(uint32_t nowMillis, const char *topic, size_t bytes) {
+                size_t bucket = (nowMillis - _startMillis) / bucketMillis;
+
+                if (bucket >= _messages.size()) {
+                    _messages.resize(bucket + 1, 0);
+                    _bytes.resize(bucket + 1, 0);
+                }
+
+                _messages[bucket]++;
+                _bytes[bucket] += bytes;
+
+                int kind = static_cast<int>(getKind(topic));
+                _kindMessages[kind]++;
+                _kindBytes[kind] += bytes;
+            }
+
+            uint64_t getMessages() const {
+                return this->sum(_messages, 0, _messages.size());
+            }
+
+            uint64_t getBytes() const {
+                return this->sum(_bytes, 0, _bytes.size());
+            }
+
+            uint64_t getKindMessages(int kind) const {
+                return _kindMessages[kind];
+            }
+
+            uint64_t getKindBytes(int kind) const {
+                return _kindBytes[kind];
+            }
+
+            // highest sum over a window of one second, with the bucket it starts in
+            void getPeak(uint64_t &messages, uint64_t &bytes, size_t &startBucket) const {
+                const size_t window = 1000 / bucketMillis;
+
+                messages = 0;
+                bytes = 0;
+                startBucket = 0;
+
+                for (size_t i = 0; i < _messages.size(); i++) {
+                    uint64_t count = this->sum(_messages, i, i + window);
+
+                    if (count > messages) {
+                        messages = count;
+                        bytes = this->sum(_bytes, i, i + window);
+                        startBucket = i;
+                    }
+                }
+            }
+
+            void printTimeline() const {
+                const size_t window = 1000 / bucketMillis;
+
+                printf("\n  second  messages     bytes\n");
+
+                for (size_t i = 0; i < _messages.size(); i += window) {
+                    printf(
+                        "  %6zu %9llu %9llu\n",
+                        i / window,
+                        (unsigned long long) this->sum(_messages, i, i + window),
+                        (unsigned long long) this->sum(_bytes, i, i + window)
+                    );
+                }
+            }
+
+        private:
+            uint32_t _startMillis = 0;
+            std::vector<uint64_t> _messages;
+            std::vector<uint64_t> _bytes;
+            uint64_t _kindMessages[static_cast<int>(TopicKind::COUNT)] = {};
+            uint64_t _kindBytes[static_cast<int>(TopicKind::COUNT)] = {};
+
+            static TopicKind getKind(const char *topic) {
+                if (0 == strncmp(topic, "homeassistant/", 14)) {
+                    return TopicKind::DISCOVERY;
+                }
+
+                if (nullptr != strstr(topic, "/state")) {
+                    return TopicKind::STATE;
+                }
+
+                if (nullptr != strstr(topic, "/debug")) {
+                    return TopicKind::DEBUG;
+                }
+
+                return TopicKind::OTHER;
+            }
+
+            static uint64_t sum(const std::vector<uint64_t> &values, size_t from, size_t to) {
+                uint64_t total = 0;
+
+                for (size_t i = from; i < to && i < values.size(); i++) {
+                    total += values[i];
+                }
+
+                return total;
+            }
+    };
+
+    // Transport of one device: counts what it publishes and notes when the AC state went out
+    class CountingTransport: public IMqttTransport {
+        public:
+            CountingTransport(IMqttTransport &transport, Traffic &traffic, Clock &clock):
+                _transport(transport),
+                _traffic(traffic),
+                _clock(clock)
+            {
+                _transport.setCallback([this](char *topic, uint8_t *payload, unsigned int length) {
+                    if (this->callback) {
+                        this->callback(topic, payload, length);
+                    }
+                });
+            }
+
+            void setServer(const char *host, uint16_t port) override {
+                _transport.setServer(host, port);
+            }
+
+            void setServer(IPAddress ip, uint16_t port) override {
+                _transport.setServer(ip, port);
+            }
+
+            bool connect(
+                const char *clientId,
+                const char *user,
+                const char *password,
+                const char *willTopic,
+                const char *willMessage
+            ) override {
+                _isOnline = false;
+
+                return _transport.connect(clientId, user, password, willTopic, willMessage);
+            }
+
+            bool connected() override {
+                return _transport.connected();
+            }
+
+            void loop() override {
+                _transport.loop();
+            }
+
+            bool publish(const char *topic, const char *payload, bool retained = false) override {
+                if (!_transport.publish(topic, payload, retained)) {
+                    return false;
+                }
+
+                uint32_t now = _clock.millis();
+                size_t topicLength = strlen(topic);
+
+                _traffic.add(now, topic, topicLength + strlen(payload));
+
+                if (!_isOnline && topicLength > 11 && 0 == strcmp(topic + topicLength - 11, "/state/temp")) {
+                    _isOnline = true;
+                    _onlineMillis = now;
+                }
+
+                return true;
+            }
+
+            bool subscribe(const char *topic, uint8_t qos = 0) override {
+                return _transport.subscribe(topic, qos);
+            }
+
+            bool isOnline() const {
+                return _isOnline;
+            }
+
+            uint32_t getOnlineMillis() const {
+                return _onlineMillis;
+            }
+
+        private:
+            IMqttTransport &_transport;
+            Traffic &_traffic;
+            Clock &_clock;
+            bool _isOnline = false;
+            uint32_t _onlineMillis = 0;
+    };
+
+    // One dongle of the fleet, booted and reconnected on schedule
+    struct Slot {
+        uint64_t mac;
+        uint32_t bootMillis;
+        uint32_t connectMillis;
+        uint32_t retryDelayMillis = 0;
+        bool isBooted = false;
+
+        Host::MemoryBroker::Client *memoryClient = nullptr;
+        std::unique_ptr<Host::SocketMqttTransport> socket;
+        std::unique_ptr<CountingTransport> transport;
+        std::unique_ptr<Host::EmulatedDevice> device;
+    };
+
+    class Fleet {
+        public:
+            Fleet(const Options &options): _options(options), _random(0 == options.seed ? 1 : options.seed) {
+                _clock = options.brokerHost.empty() ? static_cast<Clock*>(&_simulatedClock) : &Clock::system();
+                _slots.resize(options.devices);
+
+                for (int i = 0; i < options.devices; i++) {
+                    Slot &slot = _slots[i];
+                    IMqttTransport *transport;
+
+                    if (options.brokerHost.empty()) {
+                        slot.memoryClient = &_broker.createClient();
+                        transport = slot.memoryClient;
+                    } else {
+                        slot.socket.reset(new Host::SocketMqttTransport());
+                        slot.socket->setServer(options.brokerHost.c_str(), options.brokerPort);
+                        transport = slot.socket.get();
+                    }
+
+                    slot.mac = 0x0000F1EE70000000ULL + i;
+                    slot.transport.reset(new CountingTransport(*transport, _traffic, *_clock));
+                }
+            }
+
+            // boots device n at start + n * stagger, plus jitter
+            void boot(uint32_t staggerMillis) {
+                _phaseMillis = _clock->millis();
+                _traffic.reset(_phaseMillis);
+
+                for (size_t i = 0; i < _slots.size(); i++) {
+                    _slots[i].bootMillis = _phaseMillis + i * staggerMillis + this->jitter();
+                }
+            }
+
+            // drops every connection, devices reconnect after the jitter
+            void dropConnections() {
+                _phaseMillis = _clock->millis();
+                _traffic.reset(_phaseMillis);
+
+                for (Slot &slot: _slots) {
+                    if (nullptr != slot.memoryClient) {
+                        slot.memoryClient->disconnect();
+                    } else {
+                        slot.socket->disconnect();
+                    }
+
+                    slot.connectMillis = _phaseMillis + this->jitter();
+                    slot.retryDelayMillis = 0;
+                }
+            }
+
+            // false when the timeout passed first
+            bool runUntilOnline() {
+                while (this->getOnlineCount() < _slots.size()) {
+                    if ((_clock->millis() - _phaseMillis) >= _options.timeoutMillis) {
+                        return false;
+                    }
+
+                    this->step();
+                }
+
+                return true;
+            }
+
+            void run(uint32_t millis) {
+                uint32_t startedAt = _clock->millis();
+
+                while ((_clock->millis() - startedAt) < millis) {
+                    this->step();
+                }
+            }
+
+            size_t getOnlineCount() const {
+                size_t count = 0;
+
+                for (const Slot &slot: _slots) {
+                    count += slot.transport->isOnline() ? 1 : 0;
+                }
+
+                return count;
+            }
+
+            // milliseconds from the start of the phase until each device was online
+            std::vector<uint32_t> getOnlineTimes() const {
+                std::vector<uint32_t> times;
+
+                for (const Slot &slot: _slots) {
+                    if (slot.transport->isOnline()) {
+                        times.push_back(slot.transport->getOnlineMillis() - _phaseMillis);
+                    }
+                }
+
+                std::sort(times.begin(), times.end());
+
+                return times;
+            }
+
+            const Traffic& getTraffic() const {
+                return _traffic;
+            }
+
+            uint32_t getElapsedMillis() {
+                return _clock->millis() - _phaseMillis;
+            }
+
+        private:
+            const Options &_options;
+
+            Host::SimulatedClock _simulatedClock;
+            Host::MemoryBroker _broker;
+            Clock *_clock;
+
+            std::vector<Slot> _slots;
+            Traffic _traffic;
+            uint32_t _phaseMillis = 0;
+            uint32_t _random;
+
+            uint32_t jitter() {
+                if (0 == _options.jitterMillis) {
+                    return 0;
+                }
+
+                // xorshift, repeatable for the same seed
+                _random ^= _random << 13;
+                _random ^= _random >> 17;
+                _random ^= _random << 5;
+
+                return _random % _options.jitterMillis;
+            }
+
+            void step() {
+                if (_clock == &_simulatedClock) {
+                    _simulatedClock.advanceMillis(_options.stepMillis);
+                } else {
+                    usleep(1000);
+                }
+
+                uint32_t now = _clock->millis();
+
+                for (Slot &slot: _slots) {
+                    if (!slot.isBooted) {
+                        if ((int32_t) (now - slot.bootMillis) < 0) {
+                            continue;
+                        }
+
+                        // the unique id is taken from the MAC while the device is constructed
+                        slot.device.reset(new Host::EmulatedDevice(*slot.transport, *_clock, "fleet", slot.mac));
+                        slot.isBooted = true;
+                        slot.connectMillis = now;
+                    }
+
+                    if (!slot.transport->connected() && (int32_t) (now - slot.connectMillis) >= 0) {
+                        this->connect(slot, now);
+                    }
+
+                    slot.device->loop();
+                }
+            }
+
+            // first attempt right away, then backing off like ConnectionManager does
+            void connect(Slot &slot, uint32_t now) {
+                if (slot.device->connect()) {
+                    slot.retryDelayMillis = 0;
+
+                    return;
+                }
+
+                slot.retryDelayMillis = 0 == slot.retryDelayMillis ? 1000 : std::min<uint32_t>(slot.retryDelayMillis * 2, 30000);
+                slot.connectMillis = now + slot.retryDelayMillis;
+            }
+    };
+
+    uint32_t percentile(const std::vector<uint32_t> &sorted, int percent) {
+        if (sorted.empty()) {
+            return 0;
+        }
+
+        size_t rank = (sorted.size() * percent + 99) / 100;
+
+        return sorted[rank > 0 ? rank - 1 : 0];
+    }
+
+    void printReport(const char *phase, Fleet &fleet, const Options &options, bool isComplete) {
+        const Traffic &traffic = fleet.getTraffic();
+        std::vector<uint32_t> online = fleet.getOnlineTimes();
+
+        uint64_t peakMessages;
+        uint64_t peakBytes;
+        size_t peakBucket;
+        traffic.getPeak(peakMessages, peakBytes, peakBucket);
+
+        printf("\n%s, %d devices, %.1f s\n", phase, options.devices, fleet.getElapsedMillis() / 1000.0);
+        printf(
+            "  online      %zu/%d, p50 %.1f s, p95 %.1f s, max %.1f s%s\n",
+            online.size(),
+            options.devices,
+            percentile(online, 50) / 1000.0,
+            percentile(online, 95) / 1000.0,
+            percentile(online, 100) / 1000.0,
+            isComplete ? "" : ", timed out"
+        );
+        printf(
+            "  messages    %llu (%.1f per device)\n",
+            (unsigned long long) traffic.getMessages(),
+            (double) traffic.getMessages() / options.devices
+        );
+        printf(
+            "  bytes       %llu (%.0f per device)\n",
+            (unsigned long long) traffic.getBytes(),
+            (double) traffic.getBytes() / options.devices
+        );
+        printf(
+            "  peak        %llu msg/s, %llu B/s in the second from %.1f s\n",
+            (unsigned long long) peakMessages,
+            (unsigned long long) peakBytes,
+            peakBucket * Traffic::bucketMillis / 1000.0
+        );
+
+        for (int kind = 0; kind < static_cast<int>(TopicKind::COUNT); kind++) {
+            printf(
+                "  %-11s %llu messages, %llu bytes\n",
+                topicKindName(kind),
+                (unsigned long long) traffic.getKindMessages(kind),
+                (unsigned long long) traffic.getKindBytes(kind)
+            );
+        }
+
+        if (options.isTimeline) {
+            traffic.printTimeline();
+        }
+    }
+
+    void printUsage(const char *name) {
+        fprintf(
+            stderr,
+            "Usage: %s [--devices n] [--scenario simultaneous|staggered|reconnect] [--stagger ms] [--jitter ms]\n"
+            "          [--settle ms] [--timeout ms] [--step ms] [--seed n] [--broker host:port] [--timeline]\n",
+            name
+        );
+    }
+
+}
+
+int main(int argc, char **argv) {
+    Options options;
+
+    static const struct option longOptions[] = {
+        {"devices", required_argument, nullptr, 'n'},
+        {"scenario", required_argument, nullptr, 's'},
+        {"stagger", required_argument, nullptr, 'g'},
+        {"jitter", required_argument, nullptr, 'j'},
+        {"settle", required_argument, nullptr, 'e'},
+        {"timeout", required_argument, nullptr, 't'},
+        {"step", required_argument, nullptr, 'p'},
+        {"seed", required_argument, nullptr, 'r'},
+        {"broker", required_argument, nullptr, 'b'},
+        {"timeline", no_argument, nullptr, 'l'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    int option;
+
+    while (-1 != (option = getopt_long(argc, argv, "n:s:g:j:e:t:p:r:b:lh", longOptions, nullptr))) {
+        switch (option) {
+            case 'n': options.devices = atoi(optarg); break;
+            case 's': options.scenario = optarg; break;
+            case 'g': options.staggerMillis = atoi(optarg); break;
+            case 'j': options.jitterMillis = atoi(optarg); break;
+            case 'e': options.settleMillis = atoi(optarg); break;
+            case 't': options.timeoutMillis = atoi(optarg); break;
+            case 'p': options.stepMillis = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+            case 'r': options.seed = atoi(optarg); break;
+            case 'b': {
+                std::string broker = optarg;
+                size_t colon = broker.rfind(':');
+
+                options.brokerHost = broker.substr(0, colon);
+
+                if (std::string::npos != colon) {
+                    options.brokerPort = atoi(broker.c_str() + colon + 1);
+                }
+
+                break;
+            }
+            case 'l': options.isTimeline = true; break;
+            default:
+                printUsage(argv[0]);
+
+                return 'h' == option ? 0 : 1;
+        }
+    }
+
+    bool isReconnect = "reconnect" == options.scenario;
+
+    if (
+        options.devices <= 0
+        || ("simultaneous" != options.scenario && "staggered" != options.scenario && !isReconnect)
+    ) {
+        printUsage(argv[0]);
+
+        return 1;
+    }
+
+    Fleet fleet(options);
+
+    fleet.boot("simultaneous" == options.scenario ? 0 : options.staggerMillis);
+
+    bool isComplete = fleet.runUntilOnline();
+    fleet.run(options.settleMillis);
+
+    printReport("boot", fleet, options, isComplete);
+
+    if (isComplete && isReconnect) {
+        fleet.dropConnections();
+
+        isComplete = fleet.runUntilOnline();
+        fleet.run(options.settleMillis);
+
+        printReport("reconnect", fleet, options, isComplete);
+    }
+
+    return isComplete ? 0 : 1;
+}
\ No newline at end of file
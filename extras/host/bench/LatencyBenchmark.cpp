@@ -0,0 +1,530 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+// User visible command latency: from the set/<property> publish to the state/<name> publish
+// carrying the requested value. The bridge and controller of the host build drive the
+// emulated indoor unit, scripted sequences play the part of HomeAssistant.
+//
+// Without --broker everything runs in one process under simulated time, results are
+// deterministic and a run takes a second. With --broker the bridge and the scripted client
+// connect to a real broker (mosquitto) and run in real time.
+//
+//   fujitsu_latency --scenario all --rounds 50
+//   fujitsu_latency --broker 127.0.0.1:1883 --scenario slider --drop 2
+//
+// A command is confirmed when its value is published as state, superseded when a later
+// command of the same sequence for the same state was confirmed and dropped otherwise.
+
+#include <getopt.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "EmulatedDevice.h"
+#include "MemoryBroker.h"
+#include "SimulatedClock.h"
+#include "SocketMqttTransport.h"
+
+using namespace FujitsuAC;
+
+namespace {
+
+    struct Options {
+        std::string scenario = "all";
+        std::string brokerHost;
+        uint16_t brokerPort = 1883;
+        int rounds = 20;
+        uint32_t timeoutMillis = 10000;
+        bool isVerbose = false;
+        DummyUnit::Faults faults;
+    };
+
+    struct Command {
+        std::string property;
+        std::string value;
+        // commands sent before the same settle() form one sequence
+        uint32_t sequence;
+        uint32_t sentAtMicros;
+        bool isConfirmed;
+        uint32_t latencyMicros;
+    };
+
+    struct Result {
+        std::string scenario;
+        uint32_t confirmed = 0;
+        uint32_t superseded = 0;
+        uint32_t dropped = 0;
+        std::vector<uint32_t> latencies;
+        std::vector<Command> commands;
+    };
+
+    // Owns the device, the scripted client and time, in one of the two modes
+    class Harness {
+        public:
+            Harness(const Options &options): _options(options) {
+                if (options.brokerHost.empty()) {
+                    _clock = &_simulatedClock;
+                    _deviceClient = &_broker.createClient();
+                    _userClient = &_broker.createClient();
+                } else {
+                    _clock = &Clock::system();
+                    _deviceSocket.reset(new Host::SocketMqttTransport());
+                    _userSocket.reset(new Host::SocketMqttTransport());
+                    _deviceSocket->setServer(options.brokerHost.c_str(), options.brokerPort);
+                    _userSocket->setServer(options.brokerHost.c_str(), options.brokerPort);
+                    _deviceClient = _deviceSocket.get();
+                    _userClient = _userSocket.get();
+                }
+
+                _device.reset(new Host::EmulatedDevice(*_deviceClient, *_clock, "latency", 0x00000000BE0C0001ULL));
+                _device->getUnit().setFaults(options.faults);
+            }
+
+            bool start() {
+                if (!_device->connect()) {
+                    return false;
+                }
+
+                if (!_userClient->connect("fujitsu-latency", nullptr, nullptr, nullptr, nullptr)) {
+                    return false;
+                }
+
+                snprintf(_stateTopic, sizeof(_stateTopic), "fujitsu/%s/state/", _device->getUniqueId());
+                snprintf(_setTopic, sizeof(_setTopic), "fujitsu/%s/set/", _device->getUniqueId());
+
+                _userClient->setCallback([this](char *topic, uint8_t *payload, unsigned int length) {
+                    this->onMessage(topic, payload, length);
+                });
+
+                std::string filter = std::string(_stateTopic) + "#";
+                _userClient->subscribe(filter.c_str(), 0);
+
+                // UART wake sequence, handshake and the first full read of the unit
+                return this->runUntil([this]() { return this->hasState("temp") && this->hasState("fan"); }, 30000);
+            }
+
+            void send(const char *property, const char *value) {
+                std::string topic = std::string(_setTopic) + property;
+
+                _commands.push_back({property, value, _sequence, _clock->micros(), false, 0});
+                _userClient->publish(topic.c_str(), value);
+            }
+
+            void run(uint32_t millis) {
+                uint32_t startedAt = _clock->millis();
+
+                while ((_clock->millis() - startedAt) < millis) {
+                    this->step();
+                }
+            }
+
+            template <typename Predicate>
+            bool runUntil(Predicate predicate, uint32_t timeoutMillis) {
+                uint32_t startedAt = _clock->millis();
+
+                while (!predicate()) {
+                    if ((_clock->millis() - startedAt) >= timeoutMillis) {
+                        return false;
+                    }
+
+                    this->step();
+                }
+
+                return true;
+            }
+
+            // Waits until every command is confirmed or the timeout passes
+            void settle() {
+                this->runUntil([this]() { return this->isLastOfEachConfirmed(); }, _options.timeoutMillis);
+                _sequence++;
+            }
+
+            bool hasState(const std::string &name) {
+                for (auto &state: _states) {
+                    if (state.first == name) {
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+            const std::string& getState(const std::string &name) {
+                static const std::string empty;
+
+                for (auto &state: _states) {
+                    if (state.first == name) {
+                        return state.second;
+                    }
+                }
+
+                return empty;
+            }
+
+            Result collect(const char *scenario) {
+                Result result;
+                result.scenario = scenario;
+
+                for (size_t i = 0; i < _commands.size(); i++) {
+                    Command &command = _commands[i];
+
+                    if (command.isConfirmed) {
+                        result.confirmed++;
+                        result.latencies.push_back(command.latencyMicros);
+
+                        continue;
+                    }
+
+                    bool isSuperseded = false;
+
+                    for (size_t j = i + 1; j < _commands.size(); j++) {
+                        if (
+                            _commands[j].sequence == command.sequence
+                            && _commands[j].property == command.property
+                            && _commands[j].isConfirmed
+                        ) {
+                            isSuperseded = true;
+
+                            break;
+                        }
+                    }
+
+                    isSuperseded ? result.superseded++ : result.dropped++;
+                }
+
+                result.commands.swap(_commands);
+
+                return result;
+            }
+
+            uint32_t getInboundDropped() {
+                return _device->getBridge().getInboundDroppedCount();
+            }
+
+            const DummyUnit::Metrics& getUnitMetrics() {
+                return _device->getUnit().getMetrics();
+            }
+
+        private:
+            const Options &_options;
+
+            Host::SimulatedClock _simulatedClock;
+            Host::MemoryBroker _broker;
+            std::unique_ptr<Host::SocketMqttTransport> _deviceSocket;
+            std::unique_ptr<Host::SocketMqttTransport> _userSocket;
+
+            Clock *_clock;
+            IMqttTransport *_deviceClient;
+            IMqttTransport *_userClient;
+            std::unique_ptr<Host::EmulatedDevice> _device;
+
+            char _stateTopic[64];
+            char _setTopic[64];
+
+            uint32_t _sequence = 0;
+            std::vector<Command> _commands;
+            std::vector<std::pair<std::string, std::string>> _states;
+
+            void step() {
+                if (_clock == &_simulatedClock) {
+                    _simulatedClock.advanceMillis(1);
+                } else {
+                    usleep(200);
+                }
+
+                _device->loop();
+                _userClient->loop();
+            }
+
+            void onMessage(const char *topic, const uint8_t *payload, unsigned int length) {
+                size_t prefixLength = strlen(_stateTopic);
+
+                if (0 != strncmp(topic, _stateTopic, prefixLength)) {
+                    return;
+                }
+
+                std::string name = topic + prefixLength;
+                std::string value(reinterpret_cast<const char*>(payload), length);
+                uint32_t now = _clock->micros();
+
+                this->setState(name, value);
+
+                // the oldest pending command of the sequence asking for this value is the one answered
+                for (auto &command: _commands) {
+                    if (
+                        _sequence == command.sequence
+                        && !command.isConfirmed
+                        && command.property == name
+                        && command.value == value
+                    ) {
+                        command.isConfirmed = true;
+                        command.latencyMicros = now - command.sentAtMicros;
+
+                        break;
+                    }
+                }
+            }
+
+            void setState(const std::string &name, const std::string &value) {
+                for (auto &state: _states) {
+                    if (state.first == name) {
+                        state.second = value;
+
+                        return;
+                    }
+                }
+
+                _states.emplace_back(name, value);
+            }
+
+            bool isLastOfEachConfirmed() {
+                for (size_t i = 0; i < _commands.size(); i++) {
+                    if (_sequence != _commands[i].sequence || _commands[i].isConfirmed) {
+                        continue;
+                    }
+
+                    bool hasLater = false;
+
+                    for (size_t j = i + 1; j < _commands.size(); j++) {
+                        hasLater = hasLater || _commands[j].property == _commands[i].property;
+                    }
+
+                    if (!hasLater) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+    };
+
+    const char *temps[] = {"20.0", "21.5", "23.0", "24.5", "22.0", "19.5", "25.0", "21.0"};
+    const char *fans[] = {"low", "high", "quiet", "medium", "auto"};
+    const char *modes[] = {"heat", "dry", "cool", "auto"};
+
+    // A value is only published when it changes, the one equal to the current state is skipped
+    template <size_t size>
+    const char* pick(Harness &harness, const char *property, const char *(&values)[size], int index) {
+        const char *value = values[index % size];
+
+        return value == harness.getState(property) ? values[(index + 1) % size] : value;
+    }
+
+    // Makes sure the unit is on and the value that comes next differs from the current one
+    void prepare(Harness &harness) {
+        if ("on" != harness.getState("power")) {
+            harness.send("power", "on");
+            harness.settle();
+        }
+
+        harness.run(2000);
+        harness.collect("prepare");
+    }
+
+    // One command at a time, the next one after the previous was confirmed and the bus settled
+    void runSingle(Harness &harness, int rounds) {
+        for (int i = 0; i < rounds; i++) {
+            switch (i % 3) {
+                case 0: harness.send("temp", pick(harness, "temp", temps, i / 3)); break;
+                case 1: harness.send("fan", pick(harness, "fan", fans, i / 3)); break;
+                default: harness.send("mode", pick(harness, "mode", modes, i / 3)); break;
+            }
+
+            harness.settle();
+            harness.run(1000);
+        }
+    }
+
+    // Dragging the temperature slider, a step every 100 ms
+    void runSlider(Harness &harness, int rounds) {
+        char value[8];
+
+        for (int i = 0; i < rounds; i++) {
+            bool isUp = 0 == i % 2;
+
+            for (int step = 1; step <= 8; step++) {
+                int temp = isUp ? 180 + step * 5 : 220 - step * 5;
+                snprintf(value, sizeof(value), "%d.%d", temp / 10, temp % 10);
+
+                harness.send("temp", value);
+                harness.run(100);
+            }
+
+            harness.settle();
+            harness.run(1000);
+        }
+    }
+
+    // Mode, temperature and fan at once, as a climate card or an automation sends them
+    void runMixed(Harness &harness, int rounds) {
+        for (int i = 0; i < rounds; i++) {
+            harness.send("mode", pick(harness, "mode", modes, i));
+            harness.send("temp", pick(harness, "temp", temps, i));
+            harness.send("fan", pick(harness, "fan", fans, i));
+
+            harness.settle();
+            harness.run(1000);
+        }
+    }
+
+    uint32_t percentile(std::vector<uint32_t> &values, int percent) {
+        if (values.empty()) {
+            return 0;
+        }
+
+        std::sort(values.begin(), values.end());
+        size_t rank = (values.size() * percent + 99) / 100;
+
+        return values[rank > 0 ? rank - 1 : 0];
+    }
+
+    void printCommands(const Result &result) {
+        for (const Command &command: result.commands) {
+            if (command.isConfirmed) {
+                printf("  %-8s %-6s %-9s %8.1f ms\n", result.scenario.c_str(), command.property.c_str(), command.value.c_str(), command.latencyMicros / 1000.0);
+            } else {
+                printf("  %-8s %-6s %-9s unconfirmed\n", result.scenario.c_str(), command.property.c_str(), command.value.c_str());
+            }
+        }
+    }
+
+    void printResult(Result &result) {
+        printf(
+            "%-8s %8u %9u %10u %7u %8.1f %8.1f %8.1f %8.1f\n",
+            result.scenario.c_str(),
+            (unsigned int) result.commands.size(),
+            result.confirmed,
+            result.superseded,
+            result.dropped,
+            percentile(result.latencies, 50) / 1000.0,
+            percentile(result.latencies, 95) / 1000.0,
+            percentile(result.latencies, 99) / 1000.0,
+            percentile(result.latencies, 100) / 1000.0
+        );
+    }
+
+    void printUsage(const char *name) {
+        fprintf(
+            stderr,
+            "Usage: %s [--scenario all|single|slider|mixed] [--rounds n] [--timeout ms] [--broker host:port] [--verbose]\n"
+            "          [--delay ms] [--drop %%] [--corrupt %%] [--invalid-status %%]\n",
+            name
+        );
+    }
+
+}
+
+int main(int argc, char **argv) {
+    Options options;
+
+    static const struct option longOptions[] = {
+        {"scenario", required_argument, nullptr, 's'},
+        {"rounds", required_argument, nullptr, 'r'},
+        {"timeout", required_argument, nullptr, 't'},
+        {"broker", required_argument, nullptr, 'b'},
+        {"delay", required_argument, nullptr, 'd'},
+        {"drop", required_argument, nullptr, 'x'},
+        {"corrupt", required_argument, nullptr, 'c'},
+        {"invalid-status", required_argument, nullptr, 'i'},
+        {"verbose", no_argument, nullptr, 'v'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    int option;
+
+    while (-1 != (option = getopt_long(argc, argv, "s:r:t:b:d:x:c:i:vh", longOptions, nullptr))) {
+        switch (option) {
+            case 's': options.scenario = optarg; break;
+            case 'r': options.rounds = atoi(optarg); break;
+            case 't': options.timeoutMillis = atoi(optarg); break;
+            case 'b': {
+                std::string broker = optarg;
+                size_t colon = broker.rfind(':');
+
+                options.brokerHost = broker.substr(0, colon);
+
+                if (std::string::npos != colon) {
+                    options.brokerPort = atoi(broker.c_str() + colon + 1);
+                }
+
+                break;
+            }
+            case 'd': options.faults.responseDelayMillis = atoi(optarg); break;
+            case 'x': options.faults.dropPercent = atoi(optarg); break;
+            case 'c': options.faults.corruptPercent = atoi(optarg); break;
+            case 'i': options.faults.invalidStatusPercent = atoi(optarg); break;
+            case 'v': options.isVerbose = true; break;
+            default:
+                printUsage(argv[0]);
+
+                return 'h' == option ? 0 : 1;
+        }
+    }
+
+    struct Scenario {
+        const char *name;
+        void (*run)(Harness &harness, int rounds);
+    };
+
+    static const Scenario scenarios[] = {
+        {"single", runSingle},
+        {"slider", runSlider},
+        {"mixed", runMixed},
+    };
+
+    Harness harness(options);
+
+    if (!harness.start()) {
+        fprintf(stderr, "The bridge did not come up, is the broker running?\n");
+
+        return 1;
+    }
+
+    prepare(harness);
+
+    printf("scenario commands confirmed superseded dropped  p50[ms]  p95[ms]  p99[ms]  max[ms]\n");
+
+    bool isKnown = false;
+
+    for (const Scenario &scenario: scenarios) {
+        if ("all" != options.scenario && scenario.name != options.scenario) {
+            continue;
+        }
+
+        isKnown = true;
+        scenario.run(harness, options.rounds);
+
+        Result result = harness.collect(scenario.name);
+        printResult(result);
+
+        if (options.isVerbose) {
+            printCommands(result);
+        }
+    }
+
+    if (!isKnown) {
+        printUsage(argv[0]);
+
+        return 1;
+    }
+
+    const DummyUnit::Metrics &metrics = harness.getUnitMetrics();
+
+    printf(
+        "\nbridge dropped %u inbound, unit received %u frames, dropped %u, corrupted %u, invalid status %u\n",
+        harness.getInboundDropped(),
+        metrics.received,
+        metrics.dropped,
+        metrics.corrupted,
+        metrics.invalidStatus
+    );
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,238 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include <benchmark/benchmark.h>
+#include "Buffer.h"
+#include "Frames.h"
+#include "MemoryStream.h"
+#include "SimulatedClock.h"
+#include "TFSXW1Controller.h"
+
+using namespace FujitsuAC;
+
+namespace {
+
+    using Address = TFSXW1Controller::Address;
+
+    // frame B response, the largest frame the unit sends while polling
+    std::vector<uint8_t> frameBResponse(uint16_t value) {
+        static const uint16_t addresses[] = {
+            Address::EconomyMode, Address::MinimumHeat, Address::HumanSensor, Address::Register17,
+            Address::Register18, Address::Register19, Address::Register20, Address::Register21,
+            Address::EnergySavingFan, Address::Register23, Address::Powerful, Address::OutdoorUnitLowNoise,
+            Address::CoilDry, Address::Register27, Address::Register28, Address::Register29,
+            Address::Register30, Address::Register31, Address::Register32,
+        };
+
+        std::vector<RegistryTable::Register> registers;
+
+        for (uint16_t address : addresses) {
+            registers.push_back({address, value});
+        }
+
+        return Host::makeReadResponse(registers);
+    }
+
+    // Controller past the Init1/Init2 handshake, polling frame A next
+    void startController(TFSXW1Controller &controller, Host::MemoryStream &uart, Host::SimulatedClock &clock) {
+        controller.setup();
+
+        const std::vector<uint8_t> responses[] = {
+            Host::makeInit1Response(),
+            Host::makeInit2Response(),
+            Host::makeReadResponse({}),
+            Host::makeReadResponse({}),
+            Host::makeReadResponse({}),
+        };
+
+        for (const std::vector<uint8_t> &response : responses) {
+            clock.advanceMillis(400);
+            controller.loop();
+
+            uart.feed(response);
+            controller.loop();
+        }
+
+        uart.written.clear();
+    }
+
+}
+
+static void BM_Checksum(benchmark::State &state) {
+    std::vector<uint8_t> frame = frameBResponse(0x1234);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Buffer::checksum(frame.data(), frame.size() - 2));
+    }
+
+    state.SetBytesProcessed(state.iterations() * (frame.size() - 2));
+}
+BENCHMARK(BM_Checksum);
+
+static void BM_BufferParse(benchmark::State &state) {
+    Host::MemoryStream uart;
+    Host::SimulatedClock clock;
+    Buffer buffer(uart, clock);
+
+    std::vector<uint8_t> frame = frameBResponse(0x1234);
+    size_t frames = 0;
+
+    for (auto _ : state) {
+        // the gap between frames resets the parser like on the bus
+        clock.advanceMillis(20);
+        uart.feed(frame);
+
+        buffer.loop([&frames](uint8_t data[128], int size, bool isValid) {
+            frames += isValid;
+        });
+    }
+
+    state.SetItemsProcessed(frames);
+    state.SetBytesProcessed(state.iterations() * frame.size());
+}
+BENCHMARK(BM_BufferParse);
+
+static void BM_RegisterLookup(benchmark::State &state) {
+    Host::MemoryStream uart;
+    Host::SimulatedClock clock;
+    TFSXW1Controller controller(uart, clock);
+    controller.setup();
+
+    size_t count = 0;
+    const RegistryTable::Register *all = controller.getAllRegisters(count);
+
+    std::vector<uint16_t> addresses;
+
+    for (size_t i = 0; i < count; i++) {
+        addresses.push_back(all[i].address);
+    }
+
+    for (auto _ : state) {
+        for (uint16_t address : addresses) {
+            benchmark::DoNotOptimize(controller.getRegister(address));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * addresses.size());
+}
+BENCHMARK(BM_RegisterLookup);
+
+// Parse and decode of a 19 register response, every register changes when Arg(0) is 1
+static void BM_Decode(benchmark::State &state) {
+    Host::MemoryStream uart;
+    Host::SimulatedClock clock;
+    TFSXW1Controller controller(uart, clock);
+    startController(controller, uart, clock);
+
+    size_t changes = 0;
+    controller.setOnRegisterChangeCallback([&changes](const RegistryTable::Register *reg) {
+        changes++;
+    });
+
+    bool alternate = 1 == state.range(0);
+    std::vector<uint8_t> responses[] = {frameBResponse(0x0000), frameBResponse(0x0001)};
+    size_t index = 0;
+
+    for (auto _ : state) {
+        clock.advanceMillis(20);
+        uart.feed(responses[index]);
+
+        // a poll request goes out every 20th iteration, as often as on the bus
+        controller.loop();
+        uart.written.clear();
+
+        if (alternate) {
+            index ^= 1;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * 19);
+    state.counters["changes"] = benchmark::Counter(changes, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Decode)->Arg(0)->Arg(1);
+
+// requestRegistries: one poll frame per iteration, cycling frames A, B and C
+static void BM_RequestRegistries(benchmark::State &state) {
+    Host::MemoryStream uart;
+    Host::SimulatedClock clock;
+    TFSXW1Controller controller(uart, clock);
+    startController(controller, uart, clock);
+
+    std::vector<uint8_t> ack = Host::makeReadResponse({});
+
+    for (auto _ : state) {
+        clock.advanceMillis(400);
+        uart.feed(ack);
+
+        controller.loop();
+        uart.written.clear();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RequestRegistries);
+
+// sendRegistries: a full climate command written and read back, per iteration
+// frame A, the write, the check read, frame B and frame C are sent
+static void BM_SendRegistries(benchmark::State &state) {
+    Host::MemoryStream uart;
+    Host::SimulatedClock clock;
+    TFSXW1Controller controller(uart, clock);
+    startController(controller, uart, clock);
+
+    std::vector<uint8_t> readAck = Host::makeReadResponse({});
+    std::vector<uint8_t> writeAck = Host::makeWriteResponse();
+
+    TFSXW1Controller::ClimateRequest request;
+    request.hasPower = true;
+    request.power = TFSXW1Enums::Power::On;
+    request.hasMode = true;
+    request.mode = TFSXW1Enums::Mode::Cool;
+    request.hasTemp = true;
+    request.temp = 22.5;
+    request.hasFanSpeed = true;
+    request.fanSpeed = TFSXW1Enums::FanSpeed::Low;
+
+    for (auto _ : state) {
+        controller.setClimate(request);
+
+        for (int i = 0; i < 5; i++) {
+            clock.advanceMillis(400);
+            controller.loop();
+
+            uart.feed(0x02 == uart.written[0] ? writeAck : readAck);
+            controller.loop();
+            uart.written.clear();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SendRegistries);
+
+// An hour of polling a responsive unit in simulated time
+static void BM_SimulatedHour(benchmark::State &state) {
+    std::vector<uint8_t> ack = Host::makeReadResponse({});
+
+    for (auto _ : state) {
+        Host::MemoryStream uart;
+        Host::SimulatedClock clock;
+        TFSXW1Controller controller(uart, clock);
+        startController(controller, uart, clock);
+
+        while (clock.elapsedMicros() < 3600ull * 1000 * 1000) {
+            clock.advanceMillis(400);
+            controller.loop();
+
+            clock.advanceMillis(20);
+            uart.feed(ack);
+            controller.loop();
+            uart.written.clear();
+        }
+    }
+}
+BENCHMARK(BM_SimulatedHour)->Unit(benchmark::kMillisecond);
\ No newline at end of file
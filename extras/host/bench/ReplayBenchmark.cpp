@@ -0,0 +1,230 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+// Replays the AC responses of a recorded bus trace (BusTrace.h) into Buffer, the controller
+// and the MQTT bridge under simulated time, as fast as the CPU allows. The publishes and the
+// final register values are compared with a golden file, so a capture of real traffic checks
+// every change to the parser, decoder and bridge.
+//
+//   fujitsu_replay --update bus.golden bus.fjt    writes the golden file
+//   fujitsu_replay --golden bus.golden bus.fjt    exits with 1 on the first difference
+//
+// Throughput counts decoded response frames per second of wall time, allocations are
+// counted by the global operator new while the trace is played.
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "Files.h"
+#include "TraceReplay.h"
+
+using namespace FujitsuAC;
+
+namespace {
+
+    struct Allocations {
+        uint64_t count = 0;
+        uint64_t bytes = 0;
+    };
+
+    Allocations allocations;
+
+    struct Options {
+        Host::TraceReplay::Options replay;
+        std::string goldenPath;
+        bool isUpdate = false;
+    };
+
+    bool readLines(const std::string &path, std::vector<std::string> &lines) {
+        std::ifstream file(path);
+
+        if (!file) {
+            return false;
+        }
+
+        for (std::string line; std::getline(file, line); ) {
+            lines.push_back(line);
+        }
+
+        return true;
+    }
+
+    bool writeLines(const std::string &path, const std::vector<std::string> &lines) {
+        std::ofstream file(path);
+
+        for (const std::string &line: lines) {
+            file << line << '\n';
+        }
+
+        return file.good();
+    }
+
+    // prints the first difference, true when equal
+    bool compare(const std::vector<std::string> &expected, const std::vector<std::string> &actual) {
+        size_t size = std::max(expected.size(), actual.size());
+
+        for (size_t i = 0; i < size; i++) {
+            const char *left = i < expected.size() ? expected[i].c_str() : "<end>";
+            const char *right = i < actual.size() ? actual[i].c_str() : "<end>";
+
+            if (i >= expected.size() || i >= actual.size() || expected[i] != actual[i]) {
+                fprintf(stderr, "Golden output differs at line %zu\n  expected %s\n  actual   %s\n", i + 1, left, right);
+
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void printUsage(const char *name) {
+        fprintf(
+            stderr,
+            "Usage: %s [--golden file | --update file] [--filter topic] [--step ms] <trace.fjt>\n",
+            name
+        );
+    }
+
+}
+
+void* operator new(std::size_t size) {
+    allocations.count++;
+    allocations.bytes += size;
+
+    void *pointer = malloc(0 == size ? 1 : size);
+
+    if (nullptr == pointer) {
+        throw std::bad_alloc();
+    }
+
+    return pointer;
+}
+
+void operator delete(void *pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t size) noexcept {
+    free(pointer);
+}
+
+int main(int argc, char **argv) {
+    Options options;
+
+    static const struct option longOptions[] = {
+        {"golden", required_argument, nullptr, 'g'},
+        {"update", required_argument, nullptr, 'u'},
+        {"filter", required_argument, nullptr, 'f'},
+        {"step", required_argument, nullptr, 's'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    int option;
+
+    while (-1 != (option = getopt_long(argc, argv, "g:u:f:s:h", longOptions, nullptr))) {
+        switch (option) {
+            case 'g': options.goldenPath = optarg; break;
+            case 'u': options.goldenPath = optarg; options.isUpdate = true; break;
+            case 'f': options.replay.filter = optarg; break;
+            case 's': options.replay.stepMillis = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+            default:
+                printUsage(argv[0]);
+
+                return 'h' == option ? 0 : 1;
+        }
+    }
+
+    if (optind + 1 != argc) {
+        printUsage(argv[0]);
+
+        return 1;
+    }
+
+    std::vector<uint8_t> trace;
+
+    if (!Host::readFile(argv[optind], trace)) {
+        perror("Could not read the trace");
+
+        return 1;
+    }
+
+    Host::TraceReplay replay(trace.data(), trace.size(), options.replay);
+
+    if (!replay.start()) {
+        fprintf(stderr, "The device did not finish the handshake\n");
+
+        return 1;
+    }
+
+    Allocations before = allocations;
+    uint64_t simulatedBefore = replay.getClock().elapsedMicros();
+    auto startedAt = std::chrono::steady_clock::now();
+
+    bool isWellFormed = replay.run();
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startedAt).count();
+    double simulatedSeconds = (replay.getClock().elapsedMicros() - simulatedBefore) / 1000000.0;
+    uint64_t allocationCount = allocations.count - before.count;
+    uint64_t allocationBytes = allocations.bytes - before.bytes;
+
+    const Host::TraceReplayUnit::Metrics &metrics = replay.getDevice().getUnit().getMetrics();
+    double frames = metrics.responses > 0 ? metrics.responses : 1;
+
+    fprintf(stderr, "Responses      %u (%u invalid), %u dongle requests\n", metrics.responses, metrics.invalidResponses, metrics.requests);
+    fprintf(stderr, "Simulated      %.1f s in %.3f s wall time (%.0fx)\n", simulatedSeconds, wallSeconds, simulatedSeconds / wallSeconds);
+    fprintf(stderr, "Throughput     %.0f frames/s, %.0f bytes/s\n", metrics.responses / wallSeconds, metrics.bytes / wallSeconds);
+    fprintf(stderr, "Allocations    %.2f per frame, %.1f bytes per frame\n", allocationCount / frames, allocationBytes / frames);
+    fprintf(stderr, "Publishes      %zu matching %s\n", replay.getPublishCount(), options.replay.filter.c_str());
+
+    if (!isWellFormed) {
+        fprintf(stderr, "The trace is malformed, records after the first broken one were not played\n");
+
+        return 1;
+    }
+
+    if (options.goldenPath.empty()) {
+        return 0;
+    }
+
+    std::vector<std::string> output = replay.getOutput();
+
+    if (options.isUpdate) {
+        if (!writeLines(options.goldenPath, output)) {
+            perror("Could not write the golden file");
+
+            return 1;
+        }
+
+        fprintf(stderr, "Golden output  written, %zu lines\n", output.size());
+
+        return 0;
+    }
+
+    std::vector<std::string> expected;
+
+    if (!readLines(options.goldenPath, expected)) {
+        perror("Could not read the golden file");
+
+        return 1;
+    }
+
+    if (!compare(expected, output)) {
+        return 1;
+    }
+
+    fprintf(stderr, "Golden output  matches, %zu lines\n", output.size());
+
+    return 0;
+}
\ No newline at end of file
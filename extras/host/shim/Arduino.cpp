@@ -0,0 +1,47 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include "Arduino.h"
+#include <chrono>
+#include <thread>
+
+namespace {
+
+    const std::chrono::steady_clock::time_point startedAt = std::chrono::steady_clock::now();
+
+    uint64_t elapsedMicros() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - startedAt
+        ).count();
+    }
+
+}
+
+uint32_t millis() {
+    return (uint32_t) (elapsedMicros() / 1000);
+}
+
+uint32_t micros() {
+    return (uint32_t) elapsedMicros();
+}
+
+void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+size_t strlcpy(char *dst, const char *src, size_t size) {
+    size_t length = strlen(src);
+
+    if (size > 0) {
+        size_t copied = std::min(length, size - 1);
+
+        memcpy(dst, src, copied);
+        dst[copied] = '\0';
+    }
+
+    return length;
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+// Minimal stand-in for the Arduino core, just enough to build the library on Linux.
+// millis() and micros() follow the wall clock, tests inject Host::SimulatedClock instead.
+// Pins, LEDs and the CPU clock are no-ops, see Esp32.cpp.
+
+#include <math.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+typedef uint8_t byte;
+
+#define LOW 0x0
+#define HIGH 0x1
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+
+size_t strlcpy(char *dst, const char *src, size_t size);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+bool ledcAttach(uint8_t pin, uint32_t frequency, uint8_t resolution);
+bool ledcWrite(uint8_t pin, uint32_t duty);
+
+bool setCpuFrequencyMhz(uint32_t mhz);
+float temperatureRead();
+void configTime(long gmtOffset, int daylightOffset, const char *server1, const char *server2 = nullptr, const char *server3 = nullptr);
+
+class String {
+    public:
+        String() {}
+        String(const char *value): _value(nullptr == value ? "" : value) {}
+        String(const std::string &value): _value(value) {}
+        String(int value): _value(std::to_string(value)) {}
+        String(unsigned int value): _value(std::to_string(value)) {}
+        String(long value): _value(std::to_string(value)) {}
+        String(unsigned long value): _value(std::to_string(value)) {}
+
+        const char* c_str() const { return _value.c_str(); }
+        unsigned int length() const { return _value.size(); }
+        bool isEmpty() const { return _value.empty(); }
+        void reserve(unsigned int size) { _value.reserve(size); }
+
+        String& operator+=(const String &value) { _value += value._value; return *this; }
+        String& operator+=(const char *value) { _value += value; return *this; }
+        String& operator+=(char value) { _value += value; return *this; }
+        String& operator+=(int value) { _value += std::to_string(value); return *this; }
+        String& operator+=(unsigned int value) { _value += std::to_string(value); return *this; }
+
+        bool operator==(const String &value) const { return _value == value._value; }
+        bool operator==(const char *value) const { return _value == value; }
+        bool operator!=(const String &value) const { return _value != value._value; }
+
+        friend String operator+(const String &a, const String &b) { return a._value + b._value; }
+        friend String operator+(const String &a, const char *b) { return a._value + b; }
+        friend String operator+(const char *a, const String &b) { return a + b._value; }
+
+    private:
+        std::string _value;
+};
+
+class Print {
+    public:
+        virtual ~Print() = default;
+
+        virtual size_t write(uint8_t value) = 0;
+
+        virtual size_t write(const uint8_t *buffer, size_t size) {
+            for (size_t i = 0; i < size; i++) {
+                this->write(buffer[i]);
+            }
+
+            return size;
+        }
+
+        virtual void flush() {}
+};
+
+class Stream: public Print {
+    public:
+        virtual int available() = 0;
+        virtual int read() = 0;
+        virtual int peek() = 0;
+};
+
+class EspClass {
+    public:
+        // what getEfuseMac() returns, the unique id of the device is derived from it.
+        // unsigned long long like uint64_t on the ESP32, the id is formatted with %llx
+        unsigned long long efuseMac = 0x0000A1B2C3D4E5F6ULL;
+        // restart() only counts, the process keeps running
+        uint32_t restartCount = 0;
+
+        unsigned long long getEfuseMac() { return this->efuseMac; }
+        const char* getChipModel() { return "ESP32"; }
+        void restart() { this->restartCount++; }
+};
+
+extern EspClass ESP;
\ No newline at end of file
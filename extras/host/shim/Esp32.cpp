@@ -0,0 +1,43 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include "Arduino.h"
+#include "WiFi.h"
+#include "esp_system.h"
+
+EspClass ESP;
+WiFiClass WiFi;
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+void digitalWrite(uint8_t pin, uint8_t value) {}
+
+int digitalRead(uint8_t pin) {
+    // buttons are wired with pull-ups, released
+    return HIGH;
+}
+
+bool ledcAttach(uint8_t pin, uint32_t frequency, uint8_t resolution) {
+    return true;
+}
+
+bool ledcWrite(uint8_t pin, uint32_t duty) {
+    return true;
+}
+
+bool setCpuFrequencyMhz(uint32_t mhz) {
+    return true;
+}
+
+float temperatureRead() {
+    return 45.0f;
+}
+
+void configTime(long gmtOffset, int daylightOffset, const char *server1, const char *server2, const char *server3) {}
+
+esp_reset_reason_t esp_reset_reason() {
+    return ESP_RST_POWERON;
+}
\ No newline at end of file
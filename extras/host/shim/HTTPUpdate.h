@@ -0,0 +1,10 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+// Firmware updates are not part of the host build, see NetworkUpdater.cpp
\ No newline at end of file
@@ -0,0 +1,28 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+class IPAddress {
+    public:
+        IPAddress(): IPAddress(0, 0, 0, 0) {}
+        IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d): _octets{a, b, c, d} {}
+
+        uint8_t operator[](int index) const { return _octets[index]; }
+
+        String toString() const {
+            char buffer[16];
+            snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", _octets[0], _octets[1], _octets[2], _octets[3]);
+
+            return String(buffer);
+        }
+
+    private:
+        uint8_t _octets[4];
+};
\ No newline at end of file
@@ -0,0 +1,27 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+// Host replacement of src/NetworkUpdater.cpp. Setting the system clock, the version check
+// and firmware updates need the device, the host bridge reports that they are unavailable.
+
+#include "NetworkUpdater.h"
+
+namespace FujitsuAC {
+
+    NetworkUpdater::NetworkUpdater() {}
+
+    void NetworkUpdater::loop() {}
+
+    void NetworkUpdater::updateFirmware(const char *branch) {
+        this->debug("info", "NetworkUpdater: Firmware updates are not available on the host");
+    }
+
+    void NetworkUpdater::debug(const char* name, const char* message) {
+        this->debugCallback(name, message);
+    }
+
+}
\ No newline at end of file
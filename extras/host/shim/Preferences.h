@@ -0,0 +1,102 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+// NVS namespace in memory. Every instance has its own storage, so several devices can live in
+// one process, and it is gone when the instance is destroyed.
+
+#include <Arduino.h>
+#include <map>
+#include <vector>
+
+class Preferences {
+    public:
+        bool begin(const char *name, bool readOnly = false) { return true; }
+        void end() {}
+
+        bool clear() {
+            _values.clear();
+
+            return true;
+        }
+
+        bool remove(const char *key) {
+            return _values.erase(key) > 0;
+        }
+
+        size_t putBytes(const char *key, const void *value, size_t length) {
+            const uint8_t *bytes = static_cast<const uint8_t*>(value);
+            _values[key].assign(bytes, bytes + length);
+
+            return length;
+        }
+
+        size_t getBytesLength(const char *key) {
+            auto it = _values.find(key);
+
+            return _values.end() == it ? 0 : it->second.size();
+        }
+
+        size_t getBytes(const char *key, void *buffer, size_t length) {
+            auto it = _values.find(key);
+
+            if (_values.end() == it || it->second.size() > length) {
+                return 0;
+            }
+
+            memcpy(buffer, it->second.data(), it->second.size());
+
+            return it->second.size();
+        }
+
+        size_t getString(const char *key, char *value, size_t length) {
+            auto it = _values.find(key);
+
+            if (_values.end() == it || it->second.size() + 1 > length) {
+                return 0;
+            }
+
+            memcpy(value, it->second.data(), it->second.size());
+            value[it->second.size()] = '\0';
+
+            return it->second.size() + 1;
+        }
+
+        String getString(const char *key, const String defaultValue = String()) {
+            auto it = _values.find(key);
+
+            if (_values.end() == it) {
+                return defaultValue;
+            }
+
+            return std::string(it->second.begin(), it->second.end());
+        }
+
+        bool isKey(const char *key) {
+            return _values.end() != _values.find(key);
+        }
+
+        size_t putString(const char *key, const char *value) {
+            return this->putBytes(key, value, strlen(value));
+        }
+
+        size_t putBool(const char *key, bool value) {
+            uint8_t byte = value ? 1 : 0;
+
+            return this->putBytes(key, &byte, 1);
+        }
+
+        bool getBool(const char *key, bool defaultValue = false) {
+            auto it = _values.find(key);
+
+            return _values.end() == it || it->second.empty() ? defaultValue : 0 != it->second[0];
+        }
+
+    private:
+        std::map<std::string, std::vector<uint8_t>> _values;
+};
\ No newline at end of file
@@ -0,0 +1,25 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+// Station that is always connected, for the host build of the bridge
+
+#include <Arduino.h>
+#include <IPAddress.h>
+// pulled in by the Arduino core as well
+#include "driver/uart.h"
+
+class WiFiClass {
+    public:
+        IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+        String macAddress() { return String("A1:B2:C3:D4:E5:F6"); }
+        int8_t RSSI() { return -50; }
+        bool setSleep(bool enabled) { return true; }
+};
+
+extern WiFiClass WiFi;
\ No newline at end of file
@@ -0,0 +1,14 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+// Only declared, the host NetworkUpdater does not open connections
+
+#include <Arduino.h>
+
+class WiFiClientSecure;
\ No newline at end of file
@@ -0,0 +1,49 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+// UART driver of ESP-IDF without hardware, the host bridge hands the controller a Stream instead
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int uart_port_t;
+
+#define UART_NUM_0 0
+#define UART_NUM_1 1
+#define UART_NUM_2 2
+
+#define UART_PIN_NO_CHANGE (-1)
+#define UART_SIGNAL_RXD_INV (1 << 0)
+#define UART_SIGNAL_TXD_INV (1 << 5)
+
+#define portTICK_PERIOD_MS 1
+
+typedef enum { UART_DATA_8_BITS = 3 } uart_word_length_t;
+typedef enum { UART_PARITY_DISABLE = 0 } uart_parity_t;
+typedef enum { UART_STOP_BITS_1 = 1 } uart_stop_bits_t;
+typedef enum { UART_HW_FLOWCTRL_DISABLE = 0 } uart_hw_flowcontrol_t;
+typedef enum { UART_SCLK_DEFAULT = 0 } uart_sclk_t;
+
+typedef struct {
+    int baud_rate;
+    uart_word_length_t data_bits;
+    uart_parity_t parity;
+    uart_stop_bits_t stop_bits;
+    uart_hw_flowcontrol_t flow_ctrl;
+    uart_sclk_t source_clk;
+} uart_config_t;
+
+inline int uart_driver_install(uart_port_t port, int rxSize, int txSize, int queueSize, void *queue, int flags) { return 0; }
+inline int uart_param_config(uart_port_t port, const uart_config_t *config) { return 0; }
+inline int uart_set_pin(uart_port_t port, int tx, int rx, int rts, int cts) { return 0; }
+inline int uart_set_line_inverse(uart_port_t port, uint32_t mask) { return 0; }
+inline int uart_get_buffered_data_len(uart_port_t port, size_t *size) { *size = 0; return 0; }
+inline int uart_read_bytes(uart_port_t port, void *buffer, uint32_t length, uint32_t ticks) { return 0; }
+inline int uart_write_bytes(uart_port_t port, const void *buffer, size_t size) { return size; }
+inline int uart_flush(uart_port_t port) { return 0; }
\ No newline at end of file
@@ -0,0 +1,19 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+typedef enum {
+    CHIP_ESP32 = 1,
+    CHIP_ESP32S3 = 9,
+    CHIP_ESP32C3 = 5,
+    CHIP_ESP32C6 = 13,
+} esp_chip_model_t;
+
+typedef struct {
+    esp_chip_model_t model;
+} esp_chip_info_t;
\ No newline at end of file
@@ -0,0 +1,26 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Same result as the ROM function: reflected CRC-32 (0xEDB88320), the seed is the previous CRC
+inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *data, uint32_t length) {
+    crc = ~crc;
+
+    for (uint32_t i = 0; i < length; i++) {
+        crc ^= data[i];
+
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+
+    return ~crc;
+}
\ No newline at end of file
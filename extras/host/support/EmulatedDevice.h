@@ -0,0 +1,97 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include "Config.h"
+#include "DummyUnit.h"
+#include "StreamPair.h"
+#include "TFSXW1Bridge.h"
+
+namespace FujitsuAC {
+
+    namespace Host {
+
+        // TFSXW1Bridge talking to any Stream instead of the UART driver
+        class StreamBridge: public TFSXW1Bridge {
+            public:
+                StreamBridge(Config &config, IMqttTransport &mqttClient, Stream &uart, Clock &clock):
+                    TFSXW1Bridge(config, mqttClient, clock),
+                    _line(uart)
+                {}
+
+            protected:
+                Stream* createUart() override {
+                    return &_line;
+                }
+
+            private:
+                Stream &_line;
+        };
+
+        // One dongle with its indoor unit, wired like FujitsuAC does on the device:
+        // the bridge starts with setup(), MQTT is attached once the transport has connected
+        class EmulatedDevice {
+            public:
+                EmulatedDevice(IMqttTransport &mqttClient, Clock &clock, const char *name, uint64_t mac):
+                    _mqttClient(mqttClient),
+                    _config("host", UART_NUM_1, 16, 17, 0, 0, 0),
+                    _unit(_line.unit, clock),
+                    _bridge(_config, mqttClient, _line.dongle, clock)
+                {
+                    // the unique id is derived from the MAC
+                    ESP.efuseMac = mac;
+
+                    _config.load();
+                    _config.setValue("device-name", name);
+
+                    _bridge.setup();
+                    _unit.setup();
+                }
+
+                bool connect() {
+                    char topic[64];
+                    snprintf(topic, sizeof(topic), "fujitsu/%s/status", _config.getUniqueId());
+
+                    if (!_mqttClient.connect(_config.getDeviceName(), nullptr, "", topic, "offline")) {
+                        return false;
+                    }
+
+                    _bridge.configureMqtt();
+
+                    return true;
+                }
+
+                void loop() {
+                    _mqttClient.loop();
+                    _bridge.loop();
+                    _unit.loop();
+                }
+
+                const char* getUniqueId() const {
+                    return _config.getUniqueId();
+                }
+
+                TFSXW1Bridge& getBridge() {
+                    return _bridge;
+                }
+
+                DummyUnit& getUnit() {
+                    return _unit;
+                }
+
+            private:
+                IMqttTransport &_mqttClient;
+                StreamPair _line;
+                Config _config;
+                DummyUnit _unit;
+                StreamBridge _bridge;
+        };
+
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace FujitsuAC {
+
+    namespace Host {
+
+        // Stream over a non-blocking file descriptor (PTY or serial port)
+        class FdStream: public Stream {
+            public:
+                explicit FdStream(int fd): _fd(fd) {
+                    fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) | O_NONBLOCK);
+                }
+
+                int available() override {
+                    this->fill();
+
+                    return _size - _position;
+                }
+
+                int read() override {
+                    this->fill();
+
+                    return _position < _size ? _buffer[_position++] : -1;
+                }
+
+                int peek() override {
+                    this->fill();
+
+                    return _position < _size ? _buffer[_position] : -1;
+                }
+
+                size_t write(uint8_t value) override {
+                    return this->write(&value, 1);
+                }
+
+                size_t write(const uint8_t *buffer, size_t size) override {
+                    size_t written = 0;
+
+                    while (written < size) {
+                        ssize_t result = ::write(_fd, buffer + written, size - written);
+
+                        if (result < 0 && EAGAIN != errno && EINTR != errno) {
+                            break;
+                        }
+
+                        written += result > 0 ? result : 0;
+                    }
+
+                    return written;
+                }
+
+                int getFd() const { return _fd; }
+
+            private:
+                int _fd;
+                uint8_t _buffer[256];
+                size_t _size = 0;
+                size_t _position = 0;
+
+                void fill() {
+                    if (_position < _size) {
+                        return;
+                    }
+
+                    ssize_t result = ::read(_fd, _buffer, sizeof(_buffer));
+
+                    _position = 0;
+                    _size = result > 0 ? result : 0;
+                }
+        };
+
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace FujitsuAC {
+
+    namespace Host {
+
+        // Whole file into memory, "-" reads stdin
+        inline bool readFile(const char *path, std::vector<uint8_t> &data) {
+            FILE *file = 0 == strcmp(path, "-") ? stdin : fopen(path, "rb");
+
+            if (nullptr == file) {
+                return false;
+            }
+
+            uint8_t chunk[65536];
+            size_t size;
+
+            while ((size = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+                data.insert(data.end(), chunk, chunk + size);
+            }
+
+            if (stdin != file) {
+                fclose(file);
+            }
+
+            return true;
+        }
+
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <algorithm>
+#include <vector>
+#include "Buffer.h"
+#include "RegistryTable.h"
+
+namespace FujitsuAC {
+
+    namespace Host {
+
+        // Appends the checksum to type, three zero bytes, length and payload
+        inline std::vector<uint8_t> makeFrame(uint8_t type, const std::vector<uint8_t> &payload) {
+            std::vector<uint8_t> frame(payload.size() + 7, 0x00);
+
+            frame[0] = type;
+            frame[4] = (uint8_t) payload.size();
+            std::copy(payload.begin(), payload.end(), frame.begin() + 5);
+
+            uint16_t checksum = Buffer::checksum(frame.data(), frame.size() - 2);
+
+            frame[frame.size() - 2] = (checksum >> 8) & 0xFF;
+            frame[frame.size() - 1] = checksum & 0xFF;
+
+            return frame;
+        }
+
+        // Indoor unit answer to a register read (0x03) with status 0x01
+        inline std::vector<uint8_t> makeReadResponse(const std::vector<RegistryTable::Register> &registers) {
+            std::vector<uint8_t> payload = {0x01};
+
+            for (const RegistryTable::Register &reg : registers) {
+                payload.push_back((reg.address >> 8) & 0xFF);
+                payload.push_back(reg.address & 0xFF);
+                payload.push_back((reg.value >> 8) & 0xFF);
+                payload.push_back(reg.value & 0xFF);
+            }
+
+            return makeFrame(0x03, payload);
+        }
+
+        // Indoor unit answer to a register write (0x02)
+        inline std::vector<uint8_t> makeWriteResponse(uint8_t status = 0x01) {
+            return makeFrame(0x02, {status});
+        }
+
+        inline std::vector<uint8_t> makeInit1Response() {
+            return makeFrame(0x00, {0x01});
+        }
+
+        inline std::vector<uint8_t> makeInit2Response() {
+            return makeFrame(0x01, {0x01});
+        }
+
+    }
+
+}
\ No newline at end of file
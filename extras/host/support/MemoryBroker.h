@@ -0,0 +1,219 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <IMqttTransport.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace FujitsuAC {
+
+    namespace Host {
+
+        // MQTT broker inside the process. Messages are queued per client and handed to its
+        // callback from loop(), like a socket based client would do, retained messages are
+        // replayed on subscribe. QoS and sessions are not modelled.
+        class MemoryBroker {
+            public:
+                struct Metrics {
+                    uint32_t messages = 0;
+                    uint32_t bytes = 0;
+                    uint32_t delivered = 0;
+                };
+
+                class Client: public IMqttTransport {
+                    public:
+                        Client(MemoryBroker &broker): _broker(broker) {}
+
+                        ~Client() override {
+                            this->disconnect();
+                        }
+
+                        void setServer(const char *host, uint16_t port) override {}
+                        void setServer(IPAddress ip, uint16_t port) override {}
+
+                        bool connect(
+                            const char *clientId,
+                            const char *user,
+                            const char *password,
+                            const char *willTopic,
+                            const char *willMessage
+                        ) override {
+                            _willTopic = nullptr != willTopic ? willTopic : "";
+                            _willMessage = nullptr != willMessage ? willMessage : "";
+                            _isConnected = true;
+
+                            return true;
+                        }
+
+                        // Drops the connection without DISCONNECT, the broker publishes the will
+                        void disconnect() {
+                            if (!_isConnected) {
+                                return;
+                            }
+
+                            _isConnected = false;
+                            _filters.clear();
+                            _inbox.clear();
+
+                            if (!_willTopic.empty()) {
+                                _broker.route(_willTopic, _willMessage, true);
+                            }
+                        }
+
+                        bool connected() override {
+                            return _isConnected;
+                        }
+
+                        void loop() override {
+                            // callbacks may publish, which can append to the inbox again
+                            std::vector<std::pair<std::string, std::string>> messages;
+                            messages.swap(_inbox);
+
+                            for (auto &message: messages) {
+                                if (!this->callback) {
+                                    continue;
+                                }
+
+                                this->callback(
+                                    &message.first[0],
+                                    reinterpret_cast<uint8_t*>(&message.second[0]),
+                                    message.second.size()
+                                );
+                            }
+                        }
+
+                        bool publish(const char *topic, const char *payload, bool retained = false) override {
+                            if (!_isConnected) {
+                                return false;
+                            }
+
+                            _broker.route(topic, payload, retained);
+
+                            return true;
+                        }
+
+                        bool subscribe(const char *topic, uint8_t qos = 0) override {
+                            if (!_isConnected) {
+                                return false;
+                            }
+
+                            _filters.push_back(topic);
+
+                            for (auto &retained: _broker._retained) {
+                                if (MemoryBroker::matches(topic, retained.first)) {
+                                    _inbox.emplace_back(retained.first, retained.second);
+                                }
+                            }
+
+                            return true;
+                        }
+
+                    private:
+                        friend class MemoryBroker;
+
+                        MemoryBroker &_broker;
+                        bool _isConnected = false;
+                        std::string _willTopic;
+                        std::string _willMessage;
+                        std::vector<std::string> _filters;
+                        std::vector<std::pair<std::string, std::string>> _inbox;
+
+                        void deliver(const std::string &topic, const std::string &payload) {
+                            for (auto &filter: _filters) {
+                                if (MemoryBroker::matches(filter, topic)) {
+                                    _inbox.emplace_back(topic, payload);
+                                    _broker._metrics.delivered++;
+
+                                    return;
+                                }
+                            }
+                        }
+                };
+
+                Client& createClient() {
+                    _clients.emplace_back(new Client(*this));
+
+                    return *_clients.back();
+                }
+
+                const Metrics& getMetrics() const {
+                    return _metrics;
+                }
+
+                const std::map<std::string, std::string>& getRetained() const {
+                    return _retained;
+                }
+
+                // MQTT topic filter with + and # wildcards
+                static bool matches(const std::string &filter, const std::string &topic) {
+                    size_t f = 0;
+                    size_t t = 0;
+
+                    while (f < filter.size()) {
+                        if ('#' == filter[f]) {
+                            return true;
+                        }
+
+                        if ('+' == filter[f]) {
+                            while (t < topic.size() && '/' != topic[t]) {
+                                t++;
+                            }
+
+                            f++;
+
+                            continue;
+                        }
+
+                        if (t >= topic.size() || filter[f] != topic[t]) {
+                            return false;
+                        }
+
+                        f++;
+                        t++;
+                    }
+
+                    return t == topic.size();
+                }
+
+                ~MemoryBroker() {
+                    for (Client *client: _clients) {
+                        client->_isConnected = false;
+                        delete client;
+                    }
+                }
+
+            private:
+                std::vector<Client*> _clients;
+                std::map<std::string, std::string> _retained;
+                Metrics _metrics;
+
+                void route(const std::string &topic, const std::string &payload, bool retained) {
+                    _metrics.messages++;
+                    _metrics.bytes += topic.size() + payload.size();
+
+                    if (retained) {
+                        if (payload.empty()) {
+                            _retained.erase(topic);
+                        } else {
+                            _retained[topic] = payload;
+                        }
+                    }
+
+                    for (Client *client: _clients) {
+                        if (client->_isConnected) {
+                            client->deliver(topic, payload);
+                        }
+                    }
+                }
+        };
+
+    }
+
+}
\ No newline at end of file
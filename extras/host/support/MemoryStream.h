@@ -0,0 +1,69 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <deque>
+#include <vector>
+
+namespace FujitsuAC {
+
+    namespace Host {
+
+        // UART stand-in: bytes pushed with feed() are read by the code under test,
+        // everything it writes ends up in written
+        class MemoryStream: public Stream {
+            public:
+                std::vector<uint8_t> written;
+
+                void feed(const uint8_t *data, size_t size) {
+                    _input.insert(_input.end(), data, data + size);
+                }
+
+                void feed(const std::vector<uint8_t> &data) {
+                    this->feed(data.data(), data.size());
+                }
+
+                int available() override {
+                    return _input.size();
+                }
+
+                int read() override {
+                    if (_input.empty()) {
+                        return -1;
+                    }
+
+                    uint8_t value = _input.front();
+                    _input.pop_front();
+
+                    return value;
+                }
+
+                int peek() override {
+                    return _input.empty() ? -1 : _input.front();
+                }
+
+                size_t write(uint8_t value) override {
+                    this->written.push_back(value);
+
+                    return 1;
+                }
+
+                size_t write(const uint8_t *buffer, size_t size) override {
+                    this->written.insert(this->written.end(), buffer, buffer + size);
+
+                    return size;
+                }
+
+            private:
+                std::deque<uint8_t> _input;
+        };
+
+    }
+
+}
\ No newline at end of file
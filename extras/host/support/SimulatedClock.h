@@ -0,0 +1,46 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include "Clock.h"
+
+namespace FujitsuAC {
+
+    namespace Host {
+
+        // Time moves only when advanced, runs are deterministic and as fast as the CPU allows
+        class SimulatedClock: public Clock {
+            public:
+                uint32_t millis() override {
+                    return (uint32_t) (_micros / 1000);
+                }
+
+                uint32_t micros() override {
+                    return (uint32_t) _micros;
+                }
+
+                void advanceMillis(uint32_t value) {
+                    _micros += (uint64_t) value * 1000;
+                }
+
+                void advanceMicros(uint32_t value) {
+                    _micros += value;
+                }
+
+                // total time since the start, does not wrap like millis()
+                uint64_t elapsedMicros() const {
+                    return _micros;
+                }
+
+            private:
+                uint64_t _micros = 0;
+        };
+
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,367 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+// MQTT 3.1.1 client over a TCP socket, enough to run the host bridge against a real broker
+// (mosquitto). Clean session, QoS 0 publishes, incoming QoS 1 publishes are acknowledged.
+
+#include <IMqttTransport.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+namespace FujitsuAC {
+
+    namespace Host {
+
+        class SocketMqttTransport: public IMqttTransport {
+            public:
+                ~SocketMqttTransport() override {
+                    this->close();
+                }
+
+                void setServer(const char *host, uint16_t port) override {
+                    _host = host;
+                    _port = port;
+                }
+
+                void setServer(IPAddress ip, uint16_t port) override {
+                    this->setServer(ip.toString().c_str(), port);
+                }
+
+                bool connect(
+                    const char *clientId,
+                    const char *user,
+                    const char *password,
+                    const char *willTopic,
+                    const char *willMessage
+                ) override {
+                    this->close();
+
+                    if (!this->open()) {
+                        return false;
+                    }
+
+                    std::vector<uint8_t> body;
+                    appendString(body, "MQTT");
+                    body.push_back(4);
+
+                    uint8_t flags = 0x02;
+
+                    if (nullptr != willTopic) {
+                        // retained will with QoS 0
+                        flags |= 0x04 | 0x20;
+                    }
+
+                    if (nullptr != user) {
+                        flags |= 0x80 | (nullptr != password ? 0x40 : 0);
+                    }
+
+                    body.push_back(flags);
+                    body.push_back(keepAliveSeconds >> 8);
+                    body.push_back(keepAliveSeconds & 0xFF);
+
+                    appendString(body, clientId);
+
+                    if (nullptr != willTopic) {
+                        appendString(body, willTopic);
+                        appendString(body, willMessage);
+                    }
+
+                    if (nullptr != user) {
+                        appendString(body, user);
+
+                        if (nullptr != password) {
+                            appendString(body, password);
+                        }
+                    }
+
+                    if (!this->send(0x10, body)) {
+                        return false;
+                    }
+
+                    // CONNACK: 0x20, 2, session present, return code
+                    uint8_t connack[4];
+
+                    if (!this->receiveExactly(connack, sizeof(connack), 5000) || 0x20 != connack[0] || 0 != connack[3]) {
+                        this->close();
+
+                        return false;
+                    }
+
+                    return true;
+                }
+
+                bool connected() override {
+                    return _socket >= 0;
+                }
+
+                // Drops the connection without DISCONNECT, the broker publishes the will
+                void disconnect() {
+                    this->close();
+                }
+
+                void loop() override {
+                    if (_socket < 0) {
+                        return;
+                    }
+
+                    uint8_t chunk[1024];
+
+                    while (true) {
+                        ssize_t size = recv(_socket, chunk, sizeof(chunk), MSG_DONTWAIT);
+
+                        if (size > 0) {
+                            _input.insert(_input.end(), chunk, chunk + size);
+
+                            continue;
+                        }
+
+                        if (0 == size || (EAGAIN != errno && EWOULDBLOCK != errno)) {
+                            this->close();
+
+                            return;
+                        }
+
+                        break;
+                    }
+
+                    while (this->handlePacket()) {}
+
+                    if ((::millis() - _lastSentMillis) >= keepAliveSeconds * 1000 / 2) {
+                        std::vector<uint8_t> empty;
+                        this->send(0xC0, empty);
+                    }
+                }
+
+                bool publish(const char *topic, const char *payload, bool retained = false) override {
+                    std::vector<uint8_t> body;
+                    appendString(body, topic);
+                    body.insert(body.end(), payload, payload + strlen(payload));
+
+                    return this->send(0x30 | (retained ? 0x01 : 0x00), body);
+                }
+
+                bool subscribe(const char *topic, uint8_t qos = 0) override {
+                    std::vector<uint8_t> body;
+                    uint16_t packetId = this->nextPacketId();
+
+                    body.push_back(packetId >> 8);
+                    body.push_back(packetId & 0xFF);
+                    appendString(body, topic);
+                    body.push_back(qos > 1 ? 1 : qos);
+
+                    return this->send(0x82, body);
+                }
+
+            private:
+                static constexpr uint16_t keepAliveSeconds = 30;
+
+                std::string _host = "127.0.0.1";
+                uint16_t _port = 1883;
+                int _socket = -1;
+                uint16_t _packetId = 0;
+                uint32_t _lastSentMillis = 0;
+                std::vector<uint8_t> _input;
+
+                bool open() {
+                    struct addrinfo hints = {};
+                    struct addrinfo *addresses = nullptr;
+
+                    hints.ai_family = AF_UNSPEC;
+                    hints.ai_socktype = SOCK_STREAM;
+
+                    std::string port = std::to_string(_port);
+
+                    if (0 != getaddrinfo(_host.c_str(), port.c_str(), &hints, &addresses)) {
+                        return false;
+                    }
+
+                    for (struct addrinfo *address = addresses; nullptr != address; address = address->ai_next) {
+                        _socket = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+
+                        if (_socket < 0) {
+                            continue;
+                        }
+
+                        if (0 == ::connect(_socket, address->ai_addr, address->ai_addrlen)) {
+                            // small packets are the whole traffic, do not wait to coalesce them
+                            int enabled = 1;
+                            setsockopt(_socket, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+
+                            break;
+                        }
+
+                        ::close(_socket);
+                        _socket = -1;
+                    }
+
+                    freeaddrinfo(addresses);
+
+                    return _socket >= 0;
+                }
+
+                void close() {
+                    if (_socket >= 0) {
+                        ::close(_socket);
+                        _socket = -1;
+                    }
+
+                    _input.clear();
+                }
+
+                uint16_t nextPacketId() {
+                    _packetId = 0 == ++_packetId ? 1 : _packetId;
+
+                    return _packetId;
+                }
+
+                static void appendString(std::vector<uint8_t> &body, const char *value) {
+                    size_t length = strlen(value);
+
+                    body.push_back(length >> 8);
+                    body.push_back(length & 0xFF);
+                    body.insert(body.end(), value, value + length);
+                }
+
+                bool send(uint8_t header, const std::vector<uint8_t> &body) {
+                    if (_socket < 0) {
+                        return false;
+                    }
+
+                    std::vector<uint8_t> packet;
+                    packet.reserve(body.size() + 5);
+                    packet.push_back(header);
+
+                    size_t length = body.size();
+
+                    do {
+                        uint8_t digit = length % 128;
+                        length /= 128;
+                        packet.push_back(length > 0 ? digit | 0x80 : digit);
+                    } while (length > 0);
+
+                    packet.insert(packet.end(), body.begin(), body.end());
+
+                    size_t sent = 0;
+
+                    while (sent < packet.size()) {
+                        ssize_t size = ::send(_socket, packet.data() + sent, packet.size() - sent, MSG_NOSIGNAL);
+
+                        if (size <= 0) {
+                            this->close();
+
+                            return false;
+                        }
+
+                        sent += size;
+                    }
+
+                    _lastSentMillis = ::millis();
+
+                    return true;
+                }
+
+                bool receiveExactly(uint8_t *buffer, size_t size, int timeoutMillis) {
+                    size_t received = 0;
+
+                    while (received < size) {
+                        struct pollfd descriptor = {_socket, POLLIN, 0};
+
+                        if (poll(&descriptor, 1, timeoutMillis) <= 0) {
+                            return false;
+                        }
+
+                        ssize_t chunk = recv(_socket, buffer + received, size - received, 0);
+
+                        if (chunk <= 0) {
+                            return false;
+                        }
+
+                        received += chunk;
+                    }
+
+                    return true;
+                }
+
+                // Handles one complete packet from the input, false when more bytes are needed
+                bool handlePacket() {
+                    size_t length = 0;
+                    size_t multiplier = 1;
+                    size_t position = 1;
+
+                    while (true) {
+                        if (position >= _input.size() || position > 4) {
+                            return false;
+                        }
+
+                        uint8_t digit = _input[position++];
+                        length += (digit & 0x7F) * multiplier;
+                        multiplier *= 128;
+
+                        if (0 == (digit & 0x80)) {
+                            break;
+                        }
+                    }
+
+                    if (_input.size() < position + length) {
+                        return false;
+                    }
+
+                    uint8_t header = _input[0];
+                    std::vector<uint8_t> body(_input.begin() + position, _input.begin() + position + length);
+                    _input.erase(_input.begin(), _input.begin() + position + length);
+
+                    if (0x30 == (header & 0xF0) && body.size() >= 2) {
+                        this->onPublish(header, body);
+                    }
+
+                    // SUBACK, PINGRESP and the rest need no answer
+                    return true;
+                }
+
+                void onPublish(uint8_t header, std::vector<uint8_t> &body) {
+                    size_t topicLength = (body[0] << 8) | body[1];
+                    size_t offset = 2 + topicLength;
+                    uint8_t qos = (header >> 1) & 0x03;
+
+                    if (body.size() < offset) {
+                        return;
+                    }
+
+                    if (qos > 0) {
+                        if (body.size() < offset + 2) {
+                            return;
+                        }
+
+                        std::vector<uint8_t> ack = {body[offset], body[offset + 1]};
+                        offset += 2;
+
+                        this->send(0x40, ack);
+                    }
+
+                    std::string topic(body.begin() + 2, body.begin() + 2 + topicLength);
+                    std::vector<uint8_t> payload(body.begin() + offset, body.end());
+                    // callbacks expect a terminated payload as PubSubClient hands over
+                    payload.push_back('\0');
+
+                    if (this->callback) {
+                        this->callback(&topic[0], payload.data(), payload.size() - 1);
+                    }
+                }
+        };
+
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+namespace FujitsuAC {
+
+    namespace Host {
+
+        // Two crossed ends of a serial line in memory, what one writes the other reads.
+        // Read bytes are dropped once a direction is drained, so a running line allocates
+        // nothing after its first frames.
+        class StreamPair {
+            private:
+                struct Channel {
+                    std::vector<uint8_t> data;
+                    size_t position = 0;
+                };
+
+                // declared first, the ends keep references to them
+                Channel _toDongle;
+                Channel _toUnit;
+
+            public:
+                class End: public Stream {
+                    public:
+                        End(Channel &input, Channel &output):
+                            _input(input),
+                            _output(output)
+                        {}
+
+                        int available() override {
+                            return _input.data.size() - _input.position;
+                        }
+
+                        int read() override {
+                            if (_input.position >= _input.data.size()) {
+                                return -1;
+                            }
+
+                            uint8_t value = _input.data[_input.position++];
+
+                            if (_input.position == _input.data.size()) {
+                                _input.data.clear();
+                                _input.position = 0;
+                            }
+
+                            return value;
+                        }
+
+                        int peek() override {
+                            return _input.position < _input.data.size() ? _input.data[_input.position] : -1;
+                        }
+
+                        size_t write(uint8_t value) override {
+                            _output.data.push_back(value);
+
+                            return 1;
+                        }
+
+                        size_t write(const uint8_t *buffer, size_t size) override {
+                            _output.data.insert(_output.data.end(), buffer, buffer + size);
+
+                            return size;
+                        }
+
+                    private:
+                        Channel &_input;
+                        Channel &_output;
+                };
+
+                // dongle side and indoor unit side
+                End dongle{_toDongle, _toUnit};
+                End unit{_toUnit, _toDongle};
+        };
+
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,329 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Buffer.h"
+#include "BusTrace.h"
+#include "Config.h"
+#include "EmulatedDevice.h"
+#include "MemoryBroker.h"
+#include "SimulatedClock.h"
+#include "StreamPair.h"
+
+namespace FujitsuAC {
+
+    namespace Host {
+
+        // Indoor unit side that plays back the responses of a recorded bus trace. It answers
+        // Init1/Init2 itself, then writes every recorded response to the dongle at its
+        // recorded time, counted from one poll interval after the handshake. Requests of the dongle are
+        // read and counted but not matched against the recording, the controller keeps its
+        // own poll schedule and decodes whatever the unit sent.
+        class TraceReplayUnit {
+            public:
+                struct Metrics {
+                    uint32_t requests = 0;
+                    uint32_t responses = 0;
+                    uint32_t invalidResponses = 0;
+                    // requests of the recording, they are not sent to the dongle
+                    uint32_t recordedRequests = 0;
+                    uint64_t bytes = 0;
+                };
+
+                // poll interval of the controller, traces converted without timestamps are paced with it
+                static constexpr uint64_t untimedIntervalMicros = 400000;
+
+                TraceReplayUnit(Stream &uart, SimulatedClock &clock, const uint8_t *trace, size_t size):
+                    _uart(uart),
+                    _clock(clock),
+                    _buffer(uart, clock),
+                    _reader(trace, size)
+                {
+                    _hasNext = _reader.next(_next);
+                }
+
+                void loop() {
+                    _buffer.loop([this](uint8_t buffer[128], int size, bool isValid) {
+                        this->onRequest(buffer, size, isValid);
+                    });
+
+                    if (!_isStarted) {
+                        return;
+                    }
+
+                    while (_hasNext && this->getDueMicros() <= _clock.elapsedMicros()) {
+                        if (BusTrace::Direction::RESPONSE == _next.direction) {
+                            _uart.write(_next.data, _next.size);
+
+                            _metrics.responses++;
+                            _metrics.bytes += _next.size;
+
+                            if (!_next.isValid) {
+                                _metrics.invalidResponses++;
+                            }
+
+                            _untimedIndex++;
+                        } else {
+                            _metrics.recordedRequests++;
+                        }
+
+                        _hasNext = _reader.next(_next);
+                    }
+                }
+
+                // handshake done, the recording is being played
+                bool isStarted() const {
+                    return _isStarted;
+                }
+
+                bool isFinished() const {
+                    return _isStarted && !_hasNext;
+                }
+
+                bool isMalformed() const {
+                    return _reader.isMalformed();
+                }
+
+                const Metrics& getMetrics() const {
+                    return _metrics;
+                }
+
+            private:
+                Stream &_uart;
+                SimulatedClock &_clock;
+                Buffer _buffer;
+                BusTrace::Reader _reader;
+
+                BusTrace::Record _next;
+                bool _hasNext = false;
+                bool _isStarted = false;
+
+                // trace time of the first record and simulated time it is played at
+                uint64_t _traceStartMicros = 0;
+                uint64_t _startMicros = 0;
+                uint64_t _untimedIndex = 0;
+
+                Metrics _metrics;
+
+                uint64_t getDueMicros() const {
+                    if (_next.blockFlags & BusTrace::NO_TIMESTAMPS) {
+                        return _startMicros + _untimedIndex * untimedIntervalMicros;
+                    }
+
+                    // records of a later block may start an earlier time base
+                    return _next.micros > _traceStartMicros
+                        ? _startMicros + (_next.micros - _traceStartMicros)
+                        : _startMicros;
+                }
+
+                void onRequest(uint8_t buffer[128], int size, bool isValid) {
+                    _metrics.requests++;
+
+                    if (!isValid) {
+                        return;
+                    }
+
+                    if (0x00 == buffer[0]) {
+                        const uint8_t response[] = {0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0xFF, 0xFD};
+                        _uart.write(response, sizeof(response));
+                    }
+
+                    if (0x01 == buffer[0]) {
+                        const uint8_t response[] = {0x01, 0x00, 0x00, 0x00, 0x01, 0x01, 0xFF, 0xFC};
+                        _uart.write(response, sizeof(response));
+
+                        if (!_isStarted) {
+                            // the controller reads registers only after the next poll interval,
+                            // a frame arriving before that would be taken as a bad Init2 answer
+                            _isStarted = true;
+                            _startMicros = _clock.elapsedMicros() + untimedIntervalMicros;
+                            _traceStartMicros = _hasNext ? _next.micros : 0;
+                        }
+                    }
+                }
+        };
+
+        // Dongle wired to a TraceReplayUnit instead of DummyUnit, see EmulatedDevice
+        class ReplayDevice {
+            public:
+                ReplayDevice(
+                    IMqttTransport &mqttClient,
+                    SimulatedClock &clock,
+                    const char *name,
+                    uint64_t mac,
+                    const uint8_t *trace,
+                    size_t size
+                ):
+                    _mqttClient(mqttClient),
+                    _config("host", UART_NUM_1, 16, 17, 0, 0, 0),
+                    _unit(_line.unit, clock, trace, size),
+                    _bridge(_config, mqttClient, _line.dongle, clock)
+                {
+                    ESP.efuseMac = mac;
+
+                    _config.load();
+                    _config.setValue("device-name", name);
+
+                    _bridge.setup();
+                }
+
+                bool connect() {
+                    char topic[64];
+                    snprintf(topic, sizeof(topic), "fujitsu/%s/status", _config.getUniqueId());
+
+                    if (!_mqttClient.connect(_config.getDeviceName(), nullptr, "", topic, "offline")) {
+                        return false;
+                    }
+
+                    _bridge.configureMqtt();
+
+                    return true;
+                }
+
+                void loop() {
+                    _mqttClient.loop();
+                    _bridge.loop();
+                    _unit.loop();
+                }
+
+                const char* getUniqueId() const {
+                    return _config.getUniqueId();
+                }
+
+                TFSXW1Bridge& getBridge() {
+                    return _bridge;
+                }
+
+                TraceReplayUnit& getUnit() {
+                    return _unit;
+                }
+
+            private:
+                IMqttTransport &_mqttClient;
+                StreamPair _line;
+                Config _config;
+                TraceReplayUnit _unit;
+                StreamBridge _bridge;
+        };
+
+        // Plays a trace through a ReplayDevice and an in-process broker under simulated time
+        // and collects what a golden file is compared with: the publishes matching a filter
+        // in order, then the final value of every register of the controller.
+        //
+        //   publish fujitsu/<uniqueId>/state/temp 22.5
+        //   register 1002 00E1
+        class TraceReplay {
+            public:
+                struct Options {
+                    // the device and the broker run once per step of simulated time
+                    uint32_t stepMillis = 10;
+                    std::string filter = "fujitsu/+/state/#";
+                    // bridge start, UART wake sequence and handshake
+                    uint32_t startTimeoutMillis = 120000;
+                    // after the last record, for the publishes it caused
+                    uint32_t settleMillis = 2000;
+                };
+
+                TraceReplay(const uint8_t *trace, size_t size, const Options &options):
+                    _options(options),
+                    _device(_broker.createClient(), _clock, "replay", 0x0000000000000001ULL, trace, size),
+                    _observer(_broker.createClient())
+                {}
+
+                // false when the device did not connect or finish the handshake in time
+                bool start() {
+                    if (!_device.connect() || !_observer.connect("replay-observer", nullptr, nullptr, nullptr, nullptr)) {
+                        return false;
+                    }
+
+                    _observer.setCallback([this](char *topic, uint8_t *payload, unsigned int length) {
+                        _output.push_back(
+                            std::string("publish ") + topic + " " + std::string(reinterpret_cast<char*>(payload), length)
+                        );
+                    });
+
+                    _observer.subscribe(_options.filter.c_str());
+
+                    while (!_device.getUnit().isStarted()) {
+                        if (_clock.elapsedMicros() >= (uint64_t) _options.startTimeoutMillis * 1000) {
+                            return false;
+                        }
+
+                        this->step();
+                    }
+
+                    return true;
+                }
+
+                // plays the rest of the trace, false when it is malformed
+                bool run() {
+                    while (!_device.getUnit().isFinished()) {
+                        this->step();
+                    }
+
+                    for (uint32_t elapsed = 0; elapsed < _options.settleMillis; elapsed += _options.stepMillis) {
+                        this->step();
+                    }
+
+                    return !_device.getUnit().isMalformed();
+                }
+
+                std::vector<std::string> getOutput() {
+                    std::vector<std::string> output = _output;
+                    TFSXW1Controller *controller = _device.getBridge().getController();
+
+                    if (nullptr == controller) {
+                        return output;
+                    }
+
+                    size_t size;
+                    const RegistryTable::Register *registers = controller->getAllRegisters(size);
+
+                    for (size_t i = 0; i < size; i++) {
+                        char line[32];
+                        snprintf(line, sizeof(line), "register %04X %04X", registers[i].address, registers[i].value);
+
+                        output.push_back(line);
+                    }
+
+                    return output;
+                }
+
+                size_t getPublishCount() const {
+                    return _output.size();
+                }
+
+                ReplayDevice& getDevice() {
+                    return _device;
+                }
+
+                SimulatedClock& getClock() {
+                    return _clock;
+                }
+
+            private:
+                Options _options;
+                SimulatedClock _clock;
+                MemoryBroker _broker;
+                ReplayDevice _device;
+                MemoryBroker::Client &_observer;
+                std::vector<std::string> _output;
+
+                void step() {
+                    _clock.advanceMillis(_options.stepMillis);
+
+                    _device.loop();
+                    _observer.loop();
+                }
+        };
+
+    }
+
+}
\ No newline at end of file
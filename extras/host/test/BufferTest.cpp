@@ -0,0 +1,168 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include <gtest/gtest.h>
+#include "Buffer.h"
+#include "Frames.h"
+#include "MemoryStream.h"
+#include "SimulatedClock.h"
+
+using namespace FujitsuAC;
+
+namespace {
+
+    struct Received {
+        std::vector<uint8_t> frame;
+        bool isValid;
+    };
+
+    std::vector<Received> drain(Buffer &buffer) {
+        std::vector<Received> received;
+
+        buffer.loop([&received](uint8_t data[128], int size, bool isValid) {
+            received.push_back({std::vector<uint8_t>(data, data + size), isValid});
+        });
+
+        return received;
+    }
+
+}
+
+TEST(BufferTest, ChecksumMatchesKnownFrames) {
+    const uint8_t init1[] = {0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00};
+    const uint8_t init2[] = {0x01, 0x00, 0x00, 0x00, 0x04, 0x00, 0x04, 0x00, 0x01};
+
+    EXPECT_EQ(0xFFFB, Buffer::checksum(init1, sizeof(init1)));
+    EXPECT_EQ(0xFFF5, Buffer::checksum(init2, sizeof(init2)));
+    EXPECT_EQ(0xFFFF, Buffer::checksum(init1, 0));
+}
+
+TEST(BufferTest, ReportsCompleteFrame) {
+    Host::MemoryStream uart;
+    Host::SimulatedClock clock;
+    Buffer buffer(uart, clock);
+
+    std::vector<uint8_t> frame = Host::makeReadResponse({{0x1000, 0x0001}, {0x1002, 0x0016}});
+    uart.feed(frame);
+
+    std::vector<Received> received = drain(buffer);
+
+    ASSERT_EQ(1u, received.size());
+    EXPECT_EQ(frame, received[0].frame);
+    EXPECT_TRUE(received[0].isValid);
+}
+
+TEST(BufferTest, FlagsInvalidChecksum) {
+    Host::MemoryStream uart;
+    Host::SimulatedClock clock;
+    Buffer buffer(uart, clock);
+
+    std::vector<uint8_t> frame = Host::makeWriteResponse();
+    frame.back() ^= 0x01;
+    uart.feed(frame);
+
+    std::vector<Received> received = drain(buffer);
+
+    ASSERT_EQ(1u, received.size());
+    EXPECT_FALSE(received[0].isValid);
+}
+
+TEST(BufferTest, AssemblesFrameSplitAcrossReads) {
+    Host::MemoryStream uart;
+    Host::SimulatedClock clock;
+    Buffer buffer(uart, clock);
+
+    std::vector<uint8_t> frame = Host::makeReadResponse({{0x1033, 0x1234}});
+
+    uart.feed(frame.data(), 4);
+    EXPECT_TRUE(drain(buffer).empty());
+
+    clock.advanceMillis(5);
+    uart.feed(frame.data() + 4, frame.size() - 4);
+
+    std::vector<Received> received = drain(buffer);
+
+    ASSERT_EQ(1u, received.size());
+    EXPECT_EQ(frame, received[0].frame);
+    EXPECT_TRUE(received[0].isValid);
+}
+
+TEST(BufferTest, SilenceDropsPartialFrame) {
+    Host::MemoryStream uart;
+    Host::SimulatedClock clock;
+    Buffer buffer(uart, clock);
+
+    std::vector<uint8_t> frame = Host::makeWriteResponse();
+
+    // first frame is cut short, the rest arrives after the 20 ms gap
+    uart.feed(frame.data(), 3);
+    drain(buffer);
+
+    clock.advanceMillis(20);
+    uart.feed(frame);
+
+    std::vector<Received> received = drain(buffer);
+
+    ASSERT_EQ(1u, received.size());
+    EXPECT_EQ(frame, received[0].frame);
+    EXPECT_TRUE(received[0].isValid);
+}
+
+TEST(BufferTest, ReportsBackToBackFrames) {
+    Host::MemoryStream uart;
+    Host::SimulatedClock clock;
+    Buffer buffer(uart, clock);
+
+    std::vector<uint8_t> first = Host::makeInit1Response();
+    std::vector<uint8_t> second = Host::makeInit2Response();
+
+    uart.feed(first);
+    EXPECT_EQ(1u, drain(buffer).size());
+
+    clock.advanceMillis(20);
+    uart.feed(second);
+
+    std::vector<Received> received = drain(buffer);
+
+    ASSERT_EQ(1u, received.size());
+    EXPECT_EQ(second, received[0].frame);
+}
+
+TEST(BufferTest, ReportsFramesWithoutGap) {
+    Host::MemoryStream uart;
+    Host::SimulatedClock clock;
+    Buffer buffer(uart, clock);
+
+    std::vector<uint8_t> first = Host::makeReadResponse({{0x1000, 0x0001}});
+    std::vector<uint8_t> second = Host::makeWriteResponse();
+
+    uart.feed(first);
+    uart.feed(second);
+
+    std::vector<Received> received = drain(buffer);
+
+    ASSERT_EQ(2u, received.size());
+    EXPECT_EQ(first, received[0].frame);
+    EXPECT_EQ(second, received[1].frame);
+}
+
+TEST(BufferTest, DropsFrameLongerThanBuffer) {
+    Host::MemoryStream uart;
+    Host::SimulatedClock clock;
+    Buffer buffer(uart, clock);
+
+    // length byte of 0xF0 announces more than 128 bytes
+    std::vector<uint8_t> noise(300, 0xF0);
+    uart.feed(noise);
+
+    EXPECT_TRUE(drain(buffer).empty());
+
+    clock.advanceMillis(20);
+    uart.feed(Host::makeWriteResponse());
+
+    EXPECT_EQ(1u, drain(buffer).size());
+}
\ No newline at end of file
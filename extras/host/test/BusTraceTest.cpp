@@ -0,0 +1,117 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include <gtest/gtest.h>
+#include "BusTrace.h"
+#include "Frames.h"
+
+using namespace FujitsuAC;
+
+TEST(BusTraceTest, RecordsSurviveRoundTrip) {
+    uint8_t buffer[256];
+    BusTrace::Writer writer(buffer, sizeof(buffer));
+
+    std::vector<uint8_t> request = Host::makeFrame(0x03, {0x10, 0x00});
+    std::vector<uint8_t> response = Host::makeReadResponse({{0x1000, 0x0001}});
+
+    ASSERT_TRUE(writer.begin(1000000000ULL));
+    EXPECT_TRUE(writer.isEmpty());
+    ASSERT_TRUE(writer.write(1000000000ULL, BusTrace::Direction::REQUEST, true, request.data(), request.size()));
+    ASSERT_TRUE(writer.write(1000045000ULL, BusTrace::Direction::RESPONSE, false, response.data(), response.size()));
+    EXPECT_FALSE(writer.isEmpty());
+
+    BusTrace::Reader reader(writer.getData(), writer.getSize());
+    BusTrace::Record record;
+
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(1000000000ULL, record.micros);
+    EXPECT_EQ(BusTrace::Direction::REQUEST, record.direction);
+    EXPECT_TRUE(record.isValid);
+    EXPECT_EQ(request, std::vector<uint8_t>(record.data, record.data + record.size));
+
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(1000045000ULL, record.micros);
+    EXPECT_EQ(BusTrace::Direction::RESPONSE, record.direction);
+    EXPECT_FALSE(record.isValid);
+    EXPECT_EQ(response, std::vector<uint8_t>(record.data, record.data + record.size));
+
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_FALSE(reader.isMalformed());
+}
+
+TEST(BusTraceTest, AppendedBlocksStartNewTimeBase) {
+    std::vector<uint8_t> frame = Host::makeWriteResponse();
+    std::vector<uint8_t> trace;
+    uint8_t buffer[64];
+    BusTrace::Writer writer(buffer, sizeof(buffer));
+
+    for (uint64_t base: {5000000ULL, 2000000ULL}) {
+        writer.clear();
+        writer.begin(base, BusTrace::NO_TIMESTAMPS);
+        writer.write(base + 400000, BusTrace::Direction::RESPONSE, true, frame.data(), frame.size());
+
+        trace.insert(trace.end(), writer.getData(), writer.getData() + writer.getSize());
+    }
+
+    BusTrace::Reader reader(trace.data(), trace.size());
+    BusTrace::Record record;
+
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(5400000ULL, record.micros);
+    EXPECT_EQ(BusTrace::NO_TIMESTAMPS, record.blockFlags);
+
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(2400000ULL, record.micros);
+
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_FALSE(reader.isMalformed());
+}
+
+TEST(BusTraceTest, WriterRefusesRecordsThatDoNotFit) {
+    std::vector<uint8_t> frame = Host::makeReadResponse({{0x1000, 0x0001}, {0x1001, 0x0002}});
+    uint8_t buffer[BusTrace::blockHeaderSize + 20];
+    BusTrace::Writer writer(buffer, sizeof(buffer));
+
+    ASSERT_TRUE(writer.begin(0));
+    EXPECT_FALSE(writer.write(0, BusTrace::Direction::RESPONSE, true, frame.data(), frame.size()));
+    EXPECT_EQ(BusTrace::blockHeaderSize, writer.getSize());
+}
+
+TEST(BusTraceTest, ReaderStopsAtMalformedRecord) {
+    std::vector<uint8_t> frame = Host::makeWriteResponse();
+    uint8_t buffer[64];
+    BusTrace::Writer writer(buffer, sizeof(buffer));
+
+    writer.begin(0);
+    writer.write(100, BusTrace::Direction::RESPONSE, true, frame.data(), frame.size());
+
+    // the frame size claims more bytes than there are
+    std::vector<uint8_t> truncated(writer.getData(), writer.getData() + writer.getSize() - 1);
+    BusTrace::Reader reader(truncated.data(), truncated.size());
+    BusTrace::Record record;
+
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_TRUE(reader.isMalformed());
+
+    // records before any block
+    const uint8_t orphan[] = {0x00, 0x00, 0x00};
+    BusTrace::Reader orphanReader(orphan, sizeof(orphan));
+
+    EXPECT_FALSE(orphanReader.next(record));
+    EXPECT_TRUE(orphanReader.isMalformed());
+}
+
+TEST(BusTraceTest, ValidatesFrameChecksum) {
+    std::vector<uint8_t> frame = Host::makeInit1Response();
+
+    EXPECT_TRUE(BusTrace::isValidFrame(frame.data(), frame.size()));
+
+    frame[5] ^= 0x01;
+
+    EXPECT_FALSE(BusTrace::isValidFrame(frame.data(), frame.size()));
+    EXPECT_FALSE(BusTrace::isValidFrame(frame.data(), 3));
+}
\ No newline at end of file
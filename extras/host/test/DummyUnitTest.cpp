@@ -0,0 +1,165 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include <gtest/gtest.h>
+#include <string>
+#include "DummyUnit.h"
+#include "SimulatedClock.h"
+#include "StreamPair.h"
+#include "TFSXW1Controller.h"
+
+using namespace FujitsuAC;
+
+namespace {
+
+    using Address = TFSXW1Controller::Address;
+
+    class DummyUnitTest: public ::testing::Test {
+        protected:
+            Host::StreamPair line;
+            Host::SimulatedClock clock;
+            TFSXW1Controller controller{line.dongle, clock};
+            DummyUnit unit{line.unit, clock};
+
+            std::vector<std::string> errors;
+
+            void SetUp() override {
+                controller.setDebugCallback([this](const char *name, const char *message) {
+                    if (0 == strcmp(name, "error")) {
+                        errors.push_back(message);
+                    }
+                });
+
+                controller.setup();
+                unit.setup();
+            }
+
+            void run(uint32_t millis) {
+                for (uint32_t i = 0; i < millis; i++) {
+                    clock.advanceMillis(1);
+
+                    controller.loop();
+                    unit.loop();
+                }
+            }
+
+            bool hasError(const char *message) {
+                return std::find(errors.begin(), errors.end(), message) != errors.end();
+            }
+    };
+
+}
+
+TEST_F(DummyUnitTest, ControllerReadsAllRegisters) {
+    // handshake, initial registries and frames A, B and C
+    this->run(10 * 420);
+
+    EXPECT_TRUE(errors.empty());
+    EXPECT_EQ(0x00FA, controller.getRegister(Address::SetpointTemp)->value);
+    EXPECT_EQ(0x1964, controller.getRegister(Address::OutdoorTemp)->value);
+    EXPECT_TRUE(controller.isFeatureSupported(Address::PowerfulSupported));
+}
+
+TEST_F(DummyUnitTest, CommandIsWrittenAndReadBack) {
+    this->run(10 * 420);
+
+    controller.setPower(TFSXW1Enums::Power::Off);
+    this->run(4 * 420);
+
+    EXPECT_EQ(0x0000, unit.getRegister(Address::Power)->value);
+    EXPECT_FALSE(controller.isPoweredOn());
+    EXPECT_TRUE(errors.empty());
+}
+
+TEST_F(DummyUnitTest, AirflowSetterIsReadBackFromState) {
+    this->run(10 * 420);
+
+    controller.setVerticalAirflow(TFSXW1Enums::VerticalAirflow::Position4);
+    this->run(4 * 420);
+
+    EXPECT_EQ(0x0004, unit.getRegister(Address::VerticalAirflow)->value);
+    EXPECT_EQ(0x0004, unit.getRegister(Address::VerticalAirflowSetterRegistry)->value);
+}
+
+TEST_F(DummyUnitTest, DroppedAnswerTimesOut) {
+    this->run(10 * 420);
+
+    DummyUnit::Faults faults;
+    faults.dropPercent = 100;
+    unit.setFaults(faults);
+
+    this->run(420);
+
+    EXPECT_TRUE(this->hasError("No response for 200 ms"));
+    EXPECT_GT(unit.getMetrics().dropped, 0u);
+}
+
+TEST_F(DummyUnitTest, CorruptedAnswerIsRejected) {
+    this->run(10 * 420);
+
+    DummyUnit::Faults faults;
+    faults.corruptPercent = 100;
+    unit.setFaults(faults);
+
+    this->run(420);
+
+    EXPECT_TRUE(this->hasError("invalid checksum"));
+}
+
+TEST_F(DummyUnitTest, InvalidStatusIsReported) {
+    this->run(10 * 420);
+
+    DummyUnit::Faults faults;
+    faults.invalidStatusPercent = 100;
+    unit.setFaults(faults);
+
+    this->run(420);
+
+    EXPECT_TRUE(this->hasError("Invalid status"));
+}
+
+TEST_F(DummyUnitTest, SlowAnswerWithinTimeoutIsAccepted) {
+    DummyUnit::Faults faults;
+    faults.responseDelayMillis = 150;
+    unit.setFaults(faults);
+
+    this->run(10 * 550);
+
+    EXPECT_TRUE(errors.empty());
+    EXPECT_EQ(0x1964, controller.getRegister(Address::OutdoorTemp)->value);
+}
+
+TEST_F(DummyUnitTest, SceneWithUnsupportedValuesIsNotRestored) {
+    this->run(10 * 420);
+
+    const RegistryTable::Register unknownFanSpeed[] = {{Address::FanSpeed, 0x0003}};
+    const RegistryTable::Register tempTooHigh[] = {{Address::SetpointTemp, 0x0190}};
+    const RegistryTable::Register unknownRegister[] = {{Address::OutdoorTemp, 0x0000}};
+
+    EXPECT_FALSE(controller.restoreState(unknownFanSpeed, 1));
+    EXPECT_FALSE(controller.restoreState(tempTooHigh, 1));
+    EXPECT_FALSE(controller.restoreState(unknownRegister, 1));
+
+    RegistryTable::Register captured[12];
+    size_t size = controller.captureState(captured, 12);
+
+    EXPECT_TRUE(controller.restoreState(captured, size));
+}
+
+TEST_F(DummyUnitTest, SetupAgainResetsRegisters) {
+    this->run(10 * 420);
+
+    controller.setPower(TFSXW1Enums::Power::Off);
+    this->run(4 * 420);
+
+    ASSERT_EQ(0x0000, unit.getRegister(Address::Power)->value);
+
+    unit.setup();
+
+    EXPECT_EQ(0x0001, unit.getRegister(Address::Power)->value);
+    EXPECT_EQ(0x00FA, unit.getRegister(Address::SetpointTemp)->value);
+}
\ No newline at end of file
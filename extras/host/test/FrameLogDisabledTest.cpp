@@ -0,0 +1,31 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+// Built with FUJITSU_FRAME_LOG_SIZE=0
+
+#include <gtest/gtest.h>
+#include "FrameLog.h"
+#include "SimulatedClock.h"
+
+using namespace FujitsuAC;
+
+TEST(FrameLogDisabledTest, CapturesNothingAndDumpsNothing) {
+    Host::SimulatedClock clock;
+    FrameLog log(clock);
+
+    const uint8_t data[] = {0x00, 0x1F, 0xA0};
+    log.capture(FrameLog::Direction::SENT, data, sizeof(data));
+
+    size_t frames = 0;
+    log.forEach([&](const FrameLog::Frame &frame) {
+        frames++;
+    });
+
+    EXPECT_EQ(0u, frames);
+    EXPECT_EQ(0u, log.getCount());
+    EXPECT_EQ(0u, log.getOverwrittenCount());
+}
\ No newline at end of file
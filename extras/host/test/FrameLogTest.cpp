@@ -0,0 +1,58 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include <gtest/gtest.h>
+#include "FrameLog.h"
+#include "SimulatedClock.h"
+
+using namespace FujitsuAC;
+
+TEST(FrameLogTest, ReturnsFramesOldestFirst) {
+    Host::SimulatedClock clock;
+    FrameLog log(clock);
+
+    const uint8_t first[] = {0x00, 0x1F};
+    const uint8_t second[] = {0xA0};
+
+    log.capture(FrameLog::Direction::SENT, first, sizeof(first));
+    clock.advanceMillis(5);
+    log.capture(FrameLog::Direction::RECEIVED, second, sizeof(second));
+
+    std::vector<FrameLog::Frame> frames;
+    log.forEach([&](const FrameLog::Frame &frame) {
+        frames.push_back(frame);
+    });
+
+    ASSERT_EQ(2u, frames.size());
+    EXPECT_EQ(FrameLog::Direction::SENT, frames[0].direction);
+    EXPECT_EQ(2, frames[0].size);
+    EXPECT_EQ(0x1F, frames[0].data[1]);
+    EXPECT_EQ(5u, frames[1].millis - frames[0].millis);
+}
+
+TEST(FrameLogTest, OverwritesOldestWhenFull) {
+    Host::SimulatedClock clock;
+    FrameLog log(clock);
+
+    uint8_t data[128] = {};
+
+    for (int i = 0; i < 100; i++) {
+        data[0] = i;
+        log.capture(FrameLog::Direction::SENT, data, sizeof(data));
+    }
+
+    EXPECT_GT(log.getOverwrittenCount(), 0u);
+    EXPECT_EQ(100u, log.getCount() + log.getOverwrittenCount());
+
+    std::vector<uint8_t> firstBytes;
+    log.forEach([&](const FrameLog::Frame &frame) {
+        firstBytes.push_back(frame.data[0]);
+    });
+
+    ASSERT_FALSE(firstBytes.empty());
+    EXPECT_EQ(99, firstBytes.back());
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include <gtest/gtest.h>
+#include "JsonWriter.h"
+
+using namespace FujitsuAC;
+
+TEST(JsonWriterTest, WritesValuesAsStringsUnlessNumeric) {
+    char buffer[128];
+    JsonWriter writer(buffer, sizeof(buffer));
+
+    // raw hex register values read the same way whether or not they look like a number
+    ASSERT_TRUE(writer.add("address_1234", "1234"));
+    ASSERT_TRUE(writer.add("address_5678", "00E7"));
+    ASSERT_TRUE(writer.add("actual_temp", "22.4", true));
+    ASSERT_TRUE(writer.end());
+
+    EXPECT_STREQ(R"({"address_1234":"1234","address_5678":"00E7","actual_temp":22.4})", writer.c_str());
+}
+
+TEST(JsonWriterTest, WritesInvalidNumericValueAsString) {
+    char buffer[64];
+    JsonWriter writer(buffer, sizeof(buffer));
+
+    ASSERT_TRUE(writer.add("temp", "0012", true));
+    ASSERT_TRUE(writer.end());
+
+    EXPECT_STREQ(R"({"temp":"0012"})", writer.c_str());
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include <gtest/gtest.h>
+#include "RegistryTable.h"
+
+using namespace FujitsuAC;
+
+TEST(RegistryTableTest, SortsRegistersByAddress) {
+    RegistryTable::Register registers[] = {
+        {0x2020, 3},
+        {0x1000, 1},
+        {0x1033, 2},
+    };
+
+    RegistryTable table(3, registers);
+
+    size_t size = 0;
+    const RegistryTable::Register *all = table.getAllRegisters(size);
+
+    ASSERT_EQ(3u, size);
+    EXPECT_EQ(0x1000, all[0].address);
+    EXPECT_EQ(0x1033, all[1].address);
+    EXPECT_EQ(0x2020, all[2].address);
+}
+
+TEST(RegistryTableTest, FindsRegisterByAddress) {
+    RegistryTable::Register registers[] = {
+        {0x1000, 1},
+        {0x1033, 2},
+        {0x2020, 3},
+    };
+
+    RegistryTable table(3, registers);
+
+    RegistryTable::Register *reg = table.getRegister(0x1033);
+
+    ASSERT_NE(nullptr, reg);
+    EXPECT_EQ(2, reg->value);
+
+    reg->value = 7;
+    EXPECT_EQ(7, table.getRegister(0x1033)->value);
+}
+
+TEST(RegistryTableTest, ReturnsNullForUnknownAddress) {
+    RegistryTable::Register registers[] = {
+        {0x1000, 1},
+        {0x2020, 3},
+    };
+
+    RegistryTable table(2, registers);
+
+    EXPECT_EQ(nullptr, table.getRegister(0x0000));
+    EXPECT_EQ(nullptr, table.getRegister(0x1001));
+    EXPECT_EQ(nullptr, table.getRegister(0xFFFF));
+}
\ No newline at end of file
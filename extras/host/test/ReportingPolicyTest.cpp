@@ -0,0 +1,41 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include <gtest/gtest.h>
+#include "ReportingPolicy.h"
+
+using namespace FujitsuAC;
+
+TEST(ReportingPolicyTest, ReportsFirstValueRightAway) {
+    ReportingPolicy policy({60, 0, 5});
+
+    EXPECT_TRUE(policy.shouldReport(220, 0));
+}
+
+TEST(ReportingPolicyTest, ReportsChangeBiggerThanDeadband) {
+    ReportingPolicy policy({60, 0, 5});
+    policy.onReported(220, 0);
+
+    EXPECT_FALSE(policy.shouldReport(224, 60000));
+    EXPECT_TRUE(policy.shouldReport(225, 60000));
+}
+
+TEST(ReportingPolicyTest, ZeroDeadbandSkipsUnchangedValue) {
+    ReportingPolicy policy({60, 0, 0});
+    policy.onReported(220, 0);
+
+    EXPECT_FALSE(policy.shouldReport(220, 60000));
+    EXPECT_TRUE(policy.shouldReport(221, 60000));
+}
+
+TEST(ReportingPolicyTest, RepeatsUnchangedValueAfterMaxInterval) {
+    ReportingPolicy policy({60, 600, 0});
+    policy.onReported(220, 0);
+
+    EXPECT_FALSE(policy.shouldReport(220, 599999));
+    EXPECT_TRUE(policy.shouldReport(220, 600000));
+}
\ No newline at end of file
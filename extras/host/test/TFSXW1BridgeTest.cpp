@@ -0,0 +1,209 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include "EmulatedDevice.h"
+#include "MemoryBroker.h"
+#include "SimulatedClock.h"
+
+using namespace FujitsuAC;
+
+namespace {
+
+    class TFSXW1BridgeTest: public ::testing::Test {
+        protected:
+            Host::SimulatedClock clock;
+            Host::MemoryBroker broker;
+            Host::MemoryBroker::Client &user = broker.createClient();
+            Host::EmulatedDevice device{broker.createClient(), clock, "test", 0x0000000000000001ULL};
+
+            std::map<std::string, std::string> states;
+
+            void SetUp() override {
+                ASSERT_TRUE(device.connect());
+                ASSERT_TRUE(user.connect("user", nullptr, nullptr, nullptr, nullptr));
+
+                user.setCallback([this](char *topic, uint8_t *payload, unsigned int length) {
+                    states[topic] = std::string(reinterpret_cast<char*>(payload), length);
+                });
+
+                user.subscribe("fujitsu/+/state/#");
+
+                // UART wake sequence, handshake and the first reads
+                this->run(25000);
+            }
+
+            void run(uint32_t millis) {
+                for (uint32_t i = 0; i < millis; i++) {
+                    clock.advanceMillis(1);
+
+                    device.loop();
+                    user.loop();
+                }
+            }
+
+            std::string topic(const char *kind, const char *name) {
+                return std::string("fujitsu/") + device.getUniqueId() + "/" + kind + "/" + name;
+            }
+    };
+
+}
+
+TEST_F(TFSXW1BridgeTest, PublishesUnitStateAfterWakeSequence) {
+    EXPECT_EQ("25.0", states[this->topic("state", "temp")]);
+    EXPECT_EQ("on", states[this->topic("state", "power")]);
+    EXPECT_EQ("online", broker.getRetained().at(std::string("fujitsu/") + device.getUniqueId() + "/status"));
+}
+
+TEST_F(TFSXW1BridgeTest, CommandIsWrittenToUnitAndPublished) {
+    user.publish(this->topic("set", "temp").c_str(), "21.5");
+    this->run(2000);
+
+    EXPECT_EQ(215, device.getUnit().getRegister(TFSXW1Controller::Address::SetpointTemp)->value);
+    EXPECT_EQ("21.5", states[this->topic("state", "temp")]);
+    EXPECT_EQ(0u, device.getBridge().getInboundDroppedCount());
+}
+
+TEST_F(TFSXW1BridgeTest, UnknownCommandIsCountedAsDropped) {
+    user.publish(this->topic("set", "unknown").c_str(), "1");
+    this->run(10);
+
+    EXPECT_EQ(1u, device.getBridge().getInboundDroppedCount());
+}
+
+TEST_F(TFSXW1BridgeTest, ClimateCommandIsWrittenInOneFrame) {
+    uint32_t written = device.getUnit().getMetrics().written;
+
+    user.publish(this->topic("set", "climate").c_str(), "{\"mode\":\"heat\",\"temp\":22,\"fan\":\"low\"}");
+    this->run(2000);
+
+    EXPECT_EQ(written + 1, device.getUnit().getMetrics().written);
+    EXPECT_EQ(220, device.getUnit().getRegister(TFSXW1Controller::Address::SetpointTemp)->value);
+
+    // read back from the unit
+    EXPECT_EQ("heat", states[this->topic("state", "mode")]);
+    EXPECT_EQ("22.0", states[this->topic("state", "temp")]);
+    EXPECT_EQ("low", states[this->topic("state", "fan")]);
+}
+
+TEST_F(TFSXW1BridgeTest, ClimateCommandWithModeOffAndPowerOnIsRejected) {
+    uint32_t written = device.getUnit().getMetrics().written;
+
+    user.publish(this->topic("set", "climate").c_str(), "{\"power\":\"on\",\"mode\":\"off\"}");
+    user.publish(this->topic("set", "climate").c_str(), "{\"mode\":\"off\",\"power\":\"on\"}");
+    this->run(2000);
+
+    EXPECT_EQ(written, device.getUnit().getMetrics().written);
+    EXPECT_EQ("on", states[this->topic("state", "power")]);
+}
+
+TEST_F(TFSXW1BridgeTest, SavedSceneIsRestored) {
+    user.publish(this->topic("set", "save_scene").c_str(), "evening");
+    user.publish(this->topic("set", "temp").c_str(), "21");
+    this->run(2000);
+
+    ASSERT_EQ(210, device.getUnit().getRegister(TFSXW1Controller::Address::SetpointTemp)->value);
+
+    user.publish(this->topic("set", "scene").c_str(), "evening");
+    this->run(2000);
+
+    EXPECT_EQ(250, device.getUnit().getRegister(TFSXW1Controller::Address::SetpointTemp)->value);
+    EXPECT_EQ("25.0", states[this->topic("state", "temp")]);
+    EXPECT_EQ("evening", states[this->topic("state", "scene")]);
+}
+
+TEST_F(TFSXW1BridgeTest, UnknownSceneIsNotRestored) {
+    uint32_t written = device.getUnit().getMetrics().written;
+
+    user.publish(this->topic("set", "scene").c_str(), "unknown");
+    this->run(2000);
+
+    EXPECT_EQ(written, device.getUnit().getMetrics().written);
+    EXPECT_EQ(0u, states.count(this->topic("state", "scene")));
+}
+
+TEST_F(TFSXW1BridgeTest, ScenePoweringOnStartsPowerOnRetry) {
+    std::vector<std::string> infos;
+
+    user.setCallback([&](char *topic, uint8_t *payload, unsigned int length) {
+        std::string value(reinterpret_cast<char*>(payload), length);
+        states[topic] = value;
+
+        if (this->topic("debug", "info") == topic) {
+            infos.push_back(value);
+        }
+    });
+
+    user.subscribe("fujitsu/+/debug/#");
+
+    user.publish(this->topic("set", "save_scene").c_str(), "on");
+    user.publish(this->topic("set", "power").c_str(), "off");
+    this->run(2000);
+
+    ASSERT_EQ("off", states[this->topic("state", "power")]);
+
+    user.publish(this->topic("set", "scene").c_str(), "on");
+    this->run(2000);
+
+    EXPECT_NE(infos.end(), std::find(infos.begin(), infos.end(), "Power-on pending"));
+    EXPECT_EQ("on", states[this->topic("state", "power")]);
+}
+
+TEST_F(TFSXW1BridgeTest, NonFiniteTempIsRejected) {
+    user.publish(this->topic("set", "climate").c_str(), "{\"temp\":\"nan\"}");
+    user.publish(this->topic("set", "climate").c_str(), "{\"temp\":1e400}");
+    user.publish(this->topic("set", "temp").c_str(), "nan");
+    user.publish(this->topic("set", "temp").c_str(), "1e400");
+    this->run(2000);
+
+    EXPECT_EQ(250, device.getUnit().getRegister(TFSXW1Controller::Address::SetpointTemp)->value);
+
+    user.publish(this->topic("set", "climate").c_str(), "{\"temp\":21}");
+    this->run(2000);
+
+    EXPECT_EQ(210, device.getUnit().getRegister(TFSXW1Controller::Address::SetpointTemp)->value);
+}
+
+TEST_F(TFSXW1BridgeTest, LongValueIsAcceptedOnlyForFirmwareUpdate) {
+    std::string branch(600, 'b');
+
+    user.publish(this->topic("set", "update_firmware").c_str(), branch.c_str());
+    this->run(10);
+
+    EXPECT_EQ(1u, device.getBridge().getInboundHandledCount());
+    EXPECT_EQ(0u, device.getBridge().getInboundDroppedCount());
+
+    user.publish(this->topic("set", "temp").c_str(), branch.c_str());
+    this->run(10);
+
+    EXPECT_EQ(1u, device.getBridge().getInboundDroppedCount());
+}
+
+TEST_F(TFSXW1BridgeTest, PublishStateFailsWhenQueueIsFull) {
+    IMqttBridge &bridge = device.getBridge();
+    bool isPublished = true;
+
+    // more distinct names than the queue has slots, nothing is drained in between
+    for (unsigned int i = 0; i <= 96; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "test_%u", i);
+
+        isPublished = bridge.publishState(name, "1");
+    }
+
+    EXPECT_FALSE(isPublished);
+}
+
+TEST(MemoryBrokerTest, MatchesWildcards) {
+    EXPECT_TRUE(Host::MemoryBroker::matches("fujitsu/#", "fujitsu/a/state/temp"));
+    EXPECT_TRUE(Host::MemoryBroker::matches("fujitsu/+/state/temp", "fujitsu/a/state/temp"));
+    EXPECT_FALSE(Host::MemoryBroker::matches("fujitsu/+/state", "fujitsu/a/state/temp"));
+    EXPECT_FALSE(Host::MemoryBroker::matches("fujitsu/a", "fujitsu/ab"));
+}
\ No newline at end of file
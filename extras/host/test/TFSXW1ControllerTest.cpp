@@ -0,0 +1,222 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include <gtest/gtest.h>
+#include <string>
+#include <utility>
+#include "Frames.h"
+#include "MemoryStream.h"
+#include "SimulatedClock.h"
+#include "TFSXW1Controller.h"
+
+using namespace FujitsuAC;
+
+namespace {
+
+    using Address = TFSXW1Controller::Address;
+
+    class TFSXW1ControllerTest: public ::testing::Test {
+        protected:
+            Host::MemoryStream uart;
+            Host::SimulatedClock clock;
+            TFSXW1Controller controller{uart, clock};
+
+            std::vector<std::pair<std::string, std::string>> messages;
+            std::vector<uint16_t> changes;
+
+            void SetUp() override {
+                controller.setDebugCallback([this](const char *name, const char *message) {
+                    messages.push_back({name, message});
+                });
+
+                controller.setOnRegisterChangeCallback([this](const RegistryTable::Register *reg) {
+                    changes.push_back(reg->address);
+                });
+
+                controller.setup();
+            }
+
+            // frame written once the 400 ms poll interval has passed
+            std::vector<uint8_t> nextRequest() {
+                uart.written.clear();
+
+                clock.advanceMillis(400);
+                controller.loop();
+
+                return uart.written;
+            }
+
+            // the unit answers 20 ms later, Buffer starts a new frame only after such a gap
+            void respond(const std::vector<uint8_t> &response) {
+                clock.advanceMillis(20);
+                uart.feed(response);
+                controller.loop();
+            }
+
+            // answers a register read with zero for every requested address
+            void respondToRead(const std::vector<uint8_t> &request) {
+                ASSERT_EQ(0x03, request[0]);
+
+                std::vector<RegistryTable::Register> registers;
+
+                for (size_t i = 5; i + 2 < request.size(); i += 2) {
+                    registers.push_back({(uint16_t) ((request[i] << 8) | request[i + 1]), 0x0000});
+                }
+
+                this->respond(Host::makeReadResponse(registers));
+            }
+
+            void handshake() {
+                this->nextRequest();
+                this->respond(Host::makeInit1Response());
+
+                this->nextRequest();
+                this->respond(Host::makeInit2Response());
+            }
+
+            bool hasMessage(const char *name, const char *message) {
+                for (const auto &entry : messages) {
+                    if (entry.first == name && entry.second == message) {
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+    };
+
+}
+
+TEST_F(TFSXW1ControllerTest, SendsInitFramesOnStart) {
+    EXPECT_EQ(
+        std::vector<uint8_t>({0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFB}),
+        this->nextRequest()
+    );
+
+    this->respond(Host::makeInit1Response());
+
+    EXPECT_EQ(
+        std::vector<uint8_t>({0x01, 0x00, 0x00, 0x00, 0x04, 0x00, 0x04, 0x00, 0x01, 0xFF, 0xF5}),
+        this->nextRequest()
+    );
+
+    this->respond(Host::makeInit2Response());
+
+    EXPECT_TRUE(this->hasMessage("status", "Running"));
+}
+
+TEST_F(TFSXW1ControllerTest, RequestsInitialRegistersAfterHandshake) {
+    this->handshake();
+
+    EXPECT_EQ(Host::makeFrame(0x03, {0x00, 0x01, 0x01, 0x01}), this->nextRequest());
+}
+
+TEST_F(TFSXW1ControllerTest, ReadResponseUpdatesRegisters) {
+    this->handshake();
+    this->nextRequest();
+
+    this->respond(Host::makeReadResponse({
+        {Address::SetpointTemp, 0x00E7},
+        {Address::FanSpeed, 0x0008},
+    }));
+
+    EXPECT_EQ(0x00E7, controller.getRegister(Address::SetpointTemp)->value);
+    EXPECT_EQ(0x0008, controller.getRegister(Address::FanSpeed)->value);
+    EXPECT_EQ(std::vector<uint16_t>({Address::SetpointTemp, Address::FanSpeed}), changes);
+
+    changes.clear();
+
+    this->respond(Host::makeReadResponse({{Address::SetpointTemp, 0x00E7}}));
+
+    EXPECT_TRUE(changes.empty());
+}
+
+TEST_F(TFSXW1ControllerTest, InstancesKeepOwnRegisters) {
+    this->handshake();
+    this->nextRequest();
+    this->respond(Host::makeReadResponse({{Address::SetpointTemp, 0x00E7}}));
+
+    Host::MemoryStream otherUart;
+    TFSXW1Controller other{otherUart, clock};
+    other.setup();
+
+    EXPECT_EQ(0x00E7, controller.getRegister(Address::SetpointTemp)->value);
+    EXPECT_EQ(0x0000, other.getRegister(Address::SetpointTemp)->value);
+}
+
+TEST_F(TFSXW1ControllerTest, IgnoresUnknownRegisterInResponse) {
+    this->handshake();
+    this->nextRequest();
+
+    this->respond(Host::makeReadResponse({
+        {0x9999, 0x0001},
+        {Address::FanSpeed, 0x0005},
+    }));
+
+    EXPECT_EQ(nullptr, controller.getRegister(0x9999));
+    EXPECT_EQ(std::vector<uint16_t>({Address::FanSpeed}), changes);
+}
+
+TEST_F(TFSXW1ControllerTest, WritesCommandAfterFrameA) {
+    this->handshake();
+
+    // initial registries 1 - 3 and frame A
+    for (int i = 0; i < 4; i++) {
+        this->respondToRead(this->nextRequest());
+    }
+
+    controller.setPower(TFSXW1Enums::Power::On);
+
+    EXPECT_EQ(Host::makeFrame(0x02, {0x10, 0x00, 0x00, 0x01}), this->nextRequest());
+
+    this->respond(Host::makeWriteResponse());
+
+    // the written register is read back
+    EXPECT_EQ(Host::makeFrame(0x03, {0x10, 0x00}), this->nextRequest());
+}
+
+TEST_F(TFSXW1ControllerTest, ReportsInvalidChecksum) {
+    this->handshake();
+    this->nextRequest();
+
+    std::vector<uint8_t> response = Host::makeReadResponse({{Address::Power, 0x0001}});
+    response.back() ^= 0xFF;
+
+    this->respond(response);
+
+    EXPECT_TRUE(this->hasMessage("error", "invalid checksum"));
+    EXPECT_TRUE(changes.empty());
+}
+
+TEST_F(TFSXW1ControllerTest, ReportsMissingResponse) {
+    this->handshake();
+    this->nextRequest();
+
+    clock.advanceMillis(200);
+    controller.loop();
+
+    EXPECT_TRUE(this->hasMessage("error", "No response for 200 ms"));
+}
+
+TEST_F(TFSXW1ControllerTest, PollsForAnHourOfSimulatedTime) {
+    this->handshake();
+
+    size_t requests = 0;
+
+    while (clock.elapsedMicros() < 3600ull * 1000 * 1000) {
+        std::vector<uint8_t> request = this->nextRequest();
+
+        ASSERT_FALSE(request.empty());
+        requests++;
+
+        this->respondToRead(request);
+    }
+
+    // 420 ms cycles (400 ms poll interval and the 20 ms answer) after the 840 ms handshake
+    EXPECT_EQ(8570u, requests);
+    EXPECT_FALSE(this->hasMessage("error", "No response for 200 ms"));
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "Frames.h"
+#include "TraceReplay.h"
+
+using namespace FujitsuAC;
+
+namespace {
+
+    using Address = TFSXW1Controller::Address;
+
+    // one read response every 400 ms, the setpoint moves in the middle of the recording
+    std::vector<uint8_t> makeTrace(uint8_t flags = 0) {
+        const uint16_t setpoints[] = {0x00D2, 0x00D2, 0x00DC, 0x00DC, 0x00E1, 0x00E1};
+
+        std::vector<uint8_t> trace(1024);
+        BusTrace::Writer writer(trace.data(), trace.size());
+        uint64_t micros = 1700000000000000ULL;
+
+        writer.begin(micros, flags);
+
+        for (uint16_t setpoint: setpoints) {
+            std::vector<uint8_t> request = Host::makeFrame(0x03, {0x10, 0x02});
+            std::vector<uint8_t> response = Host::makeReadResponse({{Address::SetpointTemp, setpoint}});
+
+            writer.write(micros, BusTrace::Direction::REQUEST, true, request.data(), request.size());
+            writer.write(micros + 30000, BusTrace::Direction::RESPONSE, true, response.data(), response.size());
+
+            micros += 400000;
+        }
+
+        // damaged on the bus and a register the controller does not know
+        std::vector<uint8_t> damaged = Host::makeReadResponse({{Address::SetpointTemp, 0x0000}});
+        damaged.back() ^= 0x01;
+        std::vector<uint8_t> unknown = Host::makeReadResponse({{0x9999, 0x0001}});
+
+        writer.write(micros, BusTrace::Direction::RESPONSE, false, damaged.data(), damaged.size());
+        writer.write(micros + 400000, BusTrace::Direction::RESPONSE, true, unknown.data(), unknown.size());
+
+        trace.resize(writer.getSize());
+
+        return trace;
+    }
+
+    std::vector<std::string> getTempPublishes(Host::TraceReplay &replay) {
+        std::vector<std::string> publishes;
+        std::string prefix = std::string("publish fujitsu/") + replay.getDevice().getUniqueId() + "/state/temp ";
+
+        for (const std::string &line: replay.getOutput()) {
+            if (0 == line.compare(0, prefix.size(), prefix)) {
+                publishes.push_back(line.substr(prefix.size()));
+            }
+        }
+
+        return publishes;
+    }
+
+}
+
+TEST(TraceReplayTest, PlaysRecordedResponsesThroughBridge) {
+    std::vector<uint8_t> trace = makeTrace();
+    Host::TraceReplay replay(trace.data(), trace.size(), {});
+
+    ASSERT_TRUE(replay.start());
+    ASSERT_TRUE(replay.run());
+
+    const Host::TraceReplayUnit::Metrics &metrics = replay.getDevice().getUnit().getMetrics();
+
+    EXPECT_EQ(8u, metrics.responses);
+    EXPECT_EQ(1u, metrics.invalidResponses);
+    EXPECT_EQ(6u, metrics.recordedRequests);
+
+    std::vector<std::string> temps = getTempPublishes(replay);
+    std::vector<std::string> expected = {"21.0", "22.0", "22.5"};
+
+    ASSERT_GE(temps.size(), expected.size());
+    EXPECT_EQ(expected, std::vector<std::string>(temps.end() - expected.size(), temps.end()));
+
+    std::vector<std::string> output = replay.getOutput();
+
+    EXPECT_NE(output.end(), std::find(output.begin(), output.end(), "register 1002 00E1"));
+}
+
+TEST(TraceReplayTest, PacesTraceWithoutTimestamps) {
+    std::vector<uint8_t> trace = makeTrace(BusTrace::NO_TIMESTAMPS);
+    Host::TraceReplay replay(trace.data(), trace.size(), {});
+
+    ASSERT_TRUE(replay.start());
+
+    uint64_t startedAt = replay.getClock().elapsedMicros();
+
+    ASSERT_TRUE(replay.run());
+
+    // eight responses 400 ms apart and the settle time
+    EXPECT_GE(replay.getClock().elapsedMicros() - startedAt, 7 * 400000ULL);
+    EXPECT_EQ(8u, replay.getDevice().getUnit().getMetrics().responses);
+}
+
+TEST(TraceReplayTest, SameTraceGivesSameOutput) {
+    std::vector<uint8_t> trace = makeTrace();
+
+    Host::TraceReplay first(trace.data(), trace.size(), {});
+    ASSERT_TRUE(first.start());
+    ASSERT_TRUE(first.run());
+
+    Host::TraceReplay second(trace.data(), trace.size(), {});
+    ASSERT_TRUE(second.start());
+    ASSERT_TRUE(second.run());
+
+    EXPECT_EQ(first.getOutput(), second.getOutput());
+}
\ No newline at end of file
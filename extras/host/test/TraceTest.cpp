@@ -0,0 +1,44 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+// Built with FUJITSU_TRACE
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "SimulatedClock.h"
+#include "Trace.h"
+
+using namespace FujitsuAC;
+
+TEST(TraceTest, TimestampsComeFromTheInjectedClock) {
+    Host::SimulatedClock clock;
+    clock.advanceMicros(5000);
+
+    Trace::clear();
+    FUJITSU_TRACE_CLOCK(clock);
+
+    FUJITSU_TRACE_INSTANT("frame", BUS, 7);
+
+    {
+        FUJITSU_TRACE_SCOPE("publish", MQTT, 0);
+        clock.advanceMicros(250);
+    }
+
+    std::vector<Trace::Event> events;
+    Trace::forEach([&](const Trace::Event &event) {
+        events.push_back(event);
+    });
+
+    FUJITSU_TRACE_CLOCK(Clock::system());
+
+    ASSERT_EQ(2u, events.size());
+    EXPECT_EQ(5000u, events[0].timestamp);
+    EXPECT_EQ('i', events[0].phase);
+    EXPECT_EQ(5000u, events[1].timestamp);
+    EXPECT_EQ(250u, events[1].duration);
+    EXPECT_EQ('X', events[1].phase);
+}
\ No newline at end of file
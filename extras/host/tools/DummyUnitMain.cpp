@@ -0,0 +1,156 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+// Emulated indoor unit on a pseudo-terminal. The dongle (or the host build of the
+// controller) opens the printed device as its UART.
+//
+//   fujitsu_dummy_unit --delay 20 --drop 5 --corrupt 1 --invalid-status 1 --link /tmp/ttyFujitsu
+
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+
+#include "DummyUnit.h"
+#include "FdStream.h"
+
+using namespace FujitsuAC;
+
+namespace {
+
+    volatile sig_atomic_t isRunning = 1;
+
+    void onSignal(int signal) {
+        isRunning = 0;
+    }
+
+    void printUsage(const char *name) {
+        fprintf(
+            stderr,
+            "Usage: %s [--delay ms] [--drop %%] [--corrupt %%] [--invalid-status %%] [--seed n] [--link path]\n",
+            name
+        );
+    }
+
+    // Master side of a new raw PTY, path receives the slave device
+    int openPty(char *path, size_t size) {
+        int fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+        if (fd < 0 || 0 != grantpt(fd) || 0 != unlockpt(fd) || 0 != ptsname_r(fd, path, size)) {
+            return -1;
+        }
+
+        // kept open so the master does not see a hang-up while no dongle is attached
+        int slave = open(path, O_RDWR | O_NOCTTY);
+
+        if (slave < 0) {
+            return -1;
+        }
+
+        struct termios attributes;
+        tcgetattr(slave, &attributes);
+        cfmakeraw(&attributes);
+        tcsetattr(slave, TCSANOW, &attributes);
+
+        return fd;
+    }
+
+}
+
+int main(int argc, char **argv) {
+    DummyUnit::Faults faults;
+    uint32_t seed = 1;
+    const char *link = nullptr;
+
+    static const struct option options[] = {
+        {"delay", required_argument, nullptr, 'd'},
+        {"drop", required_argument, nullptr, 'x'},
+        {"corrupt", required_argument, nullptr, 'c'},
+        {"invalid-status", required_argument, nullptr, 'i'},
+        {"seed", required_argument, nullptr, 's'},
+        {"link", required_argument, nullptr, 'l'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    int option;
+
+    while (-1 != (option = getopt_long(argc, argv, "d:x:c:i:s:l:h", options, nullptr))) {
+        switch (option) {
+            case 'd': faults.responseDelayMillis = atoi(optarg); break;
+            case 'x': faults.dropPercent = atoi(optarg); break;
+            case 'c': faults.corruptPercent = atoi(optarg); break;
+            case 'i': faults.invalidStatusPercent = atoi(optarg); break;
+            case 's': seed = strtoul(optarg, nullptr, 10); break;
+            case 'l': link = optarg; break;
+            default:
+                printUsage(argv[0]);
+
+                return 'h' == option ? 0 : 1;
+        }
+    }
+
+    char path[64];
+    int fd = openPty(path, sizeof(path));
+
+    if (fd < 0) {
+        perror("Could not open a pseudo-terminal");
+
+        return 1;
+    }
+
+    if (nullptr != link) {
+        unlink(link);
+
+        if (0 != symlink(path, link)) {
+            perror("Could not create the link");
+
+            return 1;
+        }
+    }
+
+    printf("%s\n", nullptr != link ? link : path);
+    fflush(stdout);
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    Host::FdStream uart(fd);
+    DummyUnit unit(uart);
+
+    unit.setFaults(faults);
+    unit.setSeed(seed);
+    unit.setup();
+
+    struct pollfd descriptor = {fd, POLLIN, 0};
+
+    while (isRunning) {
+        // wakes up on input or after 1 ms to send delayed answers
+        poll(&descriptor, 1, 1);
+        unit.loop();
+    }
+
+    if (nullptr != link) {
+        unlink(link);
+    }
+
+    const DummyUnit::Metrics &metrics = unit.getMetrics();
+
+    fprintf(
+        stderr,
+        "received %u, answered %u, dropped %u, corrupted %u, invalid status %u\n",
+        metrics.received,
+        metrics.answered,
+        metrics.dropped,
+        metrics.corrupted,
+        metrics.invalidStatus
+    );
+
+    return 0;
+}
\ No newline at end of file
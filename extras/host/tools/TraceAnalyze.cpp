@@ -0,0 +1,715 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+// Offline analysis of a binary bus trace (BusTrace.h): bus utilization, response latency
+// and poll interval distributions, register reads, writes and changes named after
+// TFSXW1Controller::Address, and protocol anomalies.
+//
+//   fujitsu_trace_analyze bus.fjt
+//   fujitsu_trace_analyze --registers unknown --anomalies 50 bus.fjt
+//
+// Times are taken when the last byte of a frame was received, the latency of a response
+// therefore includes its own transmission (about 1 ms per byte at 9600 baud).
+
+#include <getopt.h>
+#include <stdio.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "BusTrace.h"
+#include "Files.h"
+#include "TFSXW1Controller.h"
+
+using namespace FujitsuAC;
+
+namespace {
+
+    using Address = TFSXW1Controller::Address;
+
+    struct RegisterName {
+        uint16_t address;
+        const char *name;
+    };
+
+    const RegisterName registerNames[] = {
+        {Address::Initial0, "Initial0"},
+        {Address::Initial1, "Initial1"},
+        {Address::Initial2, "Initial2"},
+        {Address::Initial3, "Initial3"},
+        {Address::Initial4, "Initial4"},
+        {Address::Initial5, "Initial5"},
+        {Address::Initial6, "Initial6"},
+        {Address::Initial7, "Initial7"},
+        {Address::Initial8, "Initial8"},
+        {Address::Initial9, "Initial9"},
+        {Address::Initial10, "Initial10"},
+        {Address::Initial11, "Initial11"},
+        {Address::VerticalAirflowDirectionCount, "VerticalAirflowDirectionCount"},
+        {Address::VerticalSwingSupported, "VerticalSwingSupported"},
+        {Address::HorizontalAirflowDirectionCount, "HorizontalAirflowDirectionCount"},
+        {Address::HorizontalSwingSupported, "HorizontalSwingSupported"},
+        {Address::EconomyModeSupported, "EconomyModeSupported"},
+        {Address::MinimumHeatSupported, "MinimumHeatSupported"},
+        {Address::HumanSensorSupported, "HumanSensorSupported"},
+        {Address::EnergySavingFanSupported, "EnergySavingFanSupported"},
+        {Address::Initial20, "Initial20"},
+        {Address::Initial21, "Initial21"},
+        {Address::Initial22, "Initial22"},
+        {Address::PowerfulSupported, "PowerfulSupported"},
+        {Address::OutdoorUnitLowNoiseSupported, "OutdoorUnitLowNoiseSupported"},
+        {Address::CoilDrySupported, "CoilDrySupported"},
+        {Address::Power, "Power"},
+        {Address::Mode, "Mode"},
+        {Address::SetpointTemp, "SetpointTemp"},
+        {Address::FanSpeed, "FanSpeed"},
+        {Address::VerticalAirflowSetterRegistry, "VerticalAirflowSetterRegistry"},
+        {Address::VerticalSwing, "VerticalSwing"},
+        {Address::VerticalAirflow, "VerticalAirflow"},
+        {Address::HorizontalAirflowSetterRegistry, "HorizontalAirflowSetterRegistry"},
+        {Address::HorizontalSwing, "HorizontalSwing"},
+        {Address::HorizontalAirflow, "HorizontalAirflow"},
+        {Address::Register11, "Register11"},
+        {Address::ActualTemp, "ActualTemp"},
+        {Address::Register13, "Register13"},
+        {Address::EconomyMode, "EconomyMode"},
+        {Address::MinimumHeat, "MinimumHeat"},
+        {Address::HumanSensor, "HumanSensor"},
+        {Address::Register17, "Register17"},
+        {Address::Register18, "Register18"},
+        {Address::Register19, "Register19"},
+        {Address::Register20, "Register20"},
+        {Address::Register21, "Register21"},
+        {Address::EnergySavingFan, "EnergySavingFan"},
+        {Address::Register23, "Register23"},
+        {Address::Powerful, "Powerful"},
+        {Address::OutdoorUnitLowNoise, "OutdoorUnitLowNoise"},
+        {Address::CoilDry, "CoilDry"},
+        {Address::Register27, "Register27"},
+        {Address::Register28, "Register28"},
+        {Address::Register29, "Register29"},
+        {Address::Register30, "Register30"},
+        {Address::Register31, "Register31"},
+        {Address::Register32, "Register32"},
+        {Address::Register33, "Register33"},
+        {Address::Register34, "Register34"},
+        {Address::Register35, "Register35"},
+        {Address::Register36, "Register36"},
+        {Address::Register37, "Register37"},
+        {Address::Register38, "Register38"},
+        {Address::Register39, "Register39"},
+        {Address::Register40, "Register40"},
+        {Address::Register41, "Register41"},
+        {Address::OutdoorTemp, "OutdoorTemp"},
+        {Address::Register43, "Register43"},
+        {Address::Register44, "Register44"},
+    };
+
+    const char* getRegisterName(uint16_t address) {
+        for (const RegisterName &name: registerNames) {
+            if (name.address == address) {
+                return name.name;
+            }
+        }
+
+        return nullptr;
+    }
+
+    // 8N1, ten bits on the wire per byte
+    constexpr double baudRate = 9600;
+    constexpr double bitsPerByte = 10;
+
+    // the controller gives up on a response after 200 ms
+    constexpr uint64_t slowResponseMicros = 200000;
+    constexpr uint64_t silenceMicros = 2000000;
+
+    enum RequestType: uint8_t {
+        INIT1 = 0x00,
+        INIT2 = 0x01,
+        WRITE = 0x02,
+        READ = 0x03,
+        OTHER = 0x04,
+    };
+
+    const char* requestTypeName(int type) {
+        switch (type) {
+            case INIT1: return "init1";
+            case INIT2: return "init2";
+            case WRITE: return "write";
+            case READ: return "read";
+            default: return "other";
+        }
+    }
+
+    class Distribution {
+        public:
+            void add(uint64_t value) {
+                _values.push_back(value);
+                _isSorted = false;
+            }
+
+            size_t getCount() const {
+                return _values.size();
+            }
+
+            // nearest rank, 100 is the maximum
+            uint64_t percentile(int percent) {
+                if (_values.empty()) {
+                    return 0;
+                }
+
+                if (!_isSorted) {
+                    std::sort(_values.begin(), _values.end());
+                    _isSorted = true;
+                }
+
+                size_t rank = (_values.size() * percent + 99) / 100;
+
+                return _values[rank > 0 ? rank - 1 : 0];
+            }
+
+            uint64_t min() {
+                return this->percentile(0);
+            }
+
+            // counts per bucket, upper bounds exclusive, the last bucket is open
+            std::vector<size_t> histogram(const std::vector<uint64_t> &bounds) const {
+                std::vector<size_t> counts(bounds.size() + 1, 0);
+
+                for (uint64_t value: _values) {
+                    size_t bucket = 0;
+
+                    while (bucket < bounds.size() && value >= bounds[bucket]) {
+                        bucket++;
+                    }
+
+                    counts[bucket]++;
+                }
+
+                return counts;
+            }
+
+        private:
+            std::vector<uint64_t> _values;
+            bool _isSorted = true;
+    };
+
+    struct RegisterStats {
+        uint32_t reads = 0;
+        uint32_t writes = 0;
+        uint32_t changes = 0;
+        bool hasValue = false;
+        uint16_t first = 0;
+        uint16_t last = 0;
+        uint16_t min = 0xFFFF;
+        uint16_t max = 0;
+        std::set<uint16_t> values;
+    };
+
+    enum class AnomalyKind: uint8_t {
+        INVALID_CHECKSUM,
+        MALFORMED_FRAME,
+        NO_RESPONSE,
+        UNEXPECTED_RESPONSE,
+        TYPE_MISMATCH,
+        INVALID_STATUS,
+        SLOW_RESPONSE,
+        UNREQUESTED_REGISTER,
+        UNKNOWN_REGISTER,
+        SILENCE,
+        COUNT,
+    };
+
+    const char* anomalyName(AnomalyKind kind) {
+        switch (kind) {
+            case AnomalyKind::INVALID_CHECKSUM: return "invalid checksum";
+            case AnomalyKind::MALFORMED_FRAME: return "malformed frame";
+            case AnomalyKind::NO_RESPONSE: return "request without response";
+            case AnomalyKind::UNEXPECTED_RESPONSE: return "response without request";
+            case AnomalyKind::TYPE_MISMATCH: return "response of another type";
+            case AnomalyKind::INVALID_STATUS: return "invalid status";
+            case AnomalyKind::SLOW_RESPONSE: return "response after 200 ms";
+            case AnomalyKind::UNREQUESTED_REGISTER: return "register not requested";
+            case AnomalyKind::UNKNOWN_REGISTER: return "register not in the address table";
+            case AnomalyKind::SILENCE: return "bus silent for 2 s";
+            default: return "unknown";
+        }
+    }
+
+    struct Anomaly {
+        uint64_t micros;
+        AnomalyKind kind;
+        std::string detail;
+    };
+
+    struct Options {
+        std::string registers = "all";
+        size_t anomalies = 10;
+    };
+
+    class Analyzer {
+        public:
+            void add(const BusTrace::Record &record) {
+                if (0 == _frames) {
+                    _startedAt = record.micros;
+                    _hasTimestamps = 0 == (record.blockFlags & BusTrace::NO_TIMESTAMPS);
+                } else if (_hasTimestamps && record.micros - _endedAt >= silenceMicros) {
+                    char detail[32];
+                    snprintf(detail, sizeof(detail), "%.1f s", (record.micros - _endedAt) / 1000000.0);
+
+                    this->report(_endedAt, AnomalyKind::SILENCE, detail);
+                }
+
+                _frames++;
+                _endedAt = record.micros;
+
+                bool isRequest = BusTrace::Direction::REQUEST == record.direction;
+                (isRequest ? _requestBytes : _responseBytes) += record.size;
+
+                if (!record.isValid) {
+                    this->report(record.micros, AnomalyKind::INVALID_CHECKSUM, this->describe(record));
+                } else if (record.size < 7 || record.data[4] + 7 != record.size) {
+                    this->report(record.micros, AnomalyKind::MALFORMED_FRAME, this->describe(record));
+                }
+
+                bool isDecodable = record.isValid && record.size >= 7 && record.data[4] + 7 == record.size;
+
+                if (isRequest) {
+                    this->onRequest(record, isDecodable);
+                } else {
+                    this->onResponse(record, isDecodable);
+                }
+            }
+
+            void finish() {
+                if (_hasPending) {
+                    this->report(_pendingMicros, AnomalyKind::NO_RESPONSE, this->describe(_pending));
+                    _hasPending = false;
+                }
+            }
+
+            void print(const Options &options) {
+                this->printSummary();
+
+                if (_hasTimestamps) {
+                    this->printTiming();
+                } else {
+                    printf("\nThe trace has no timestamps, timing is not analysed\n");
+                }
+
+                this->printRegisters(options.registers);
+                this->printAnomalies(options.anomalies);
+            }
+
+        private:
+            uint32_t _frames = 0;
+            uint32_t _requests = 0;
+            uint32_t _responses = 0;
+            uint64_t _requestBytes = 0;
+            uint64_t _responseBytes = 0;
+            bool _hasTimestamps = true;
+            uint64_t _startedAt = 0;
+            uint64_t _endedAt = 0;
+
+            bool _hasPending = false;
+            std::vector<uint8_t> _pending;
+            uint64_t _pendingMicros = 0;
+            uint64_t _lastRequestMicros = 0;
+
+            Distribution _latencies[OTHER + 1];
+            Distribution _allLatencies;
+            Distribution _pollIntervals;
+            std::map<uint16_t, RegisterStats> _registers;
+
+            std::vector<Anomaly> _anomalies;
+            uint32_t _anomalyCounts[static_cast<int>(AnomalyKind::COUNT)] = {};
+            std::set<uint16_t> _unknownReported;
+
+            static int requestType(const std::vector<uint8_t> &frame) {
+                return frame.empty() || frame[0] > READ ? OTHER : frame[0];
+            }
+
+            static std::string describe(const uint8_t *data, size_t size) {
+                std::string text;
+                char hex[4];
+
+                for (size_t i = 0; i < size && i < 24; i++) {
+                    snprintf(hex, sizeof(hex), i > 0 ? " %02X" : "%02X", data[i]);
+                    text += hex;
+                }
+
+                return size > 24 ? text + " ..." : text;
+            }
+
+            static std::string describe(const BusTrace::Record &record) {
+                return describe(record.data, record.size);
+            }
+
+            static std::string describe(const std::vector<uint8_t> &frame) {
+                return describe(frame.data(), frame.size());
+            }
+
+            void report(uint64_t micros, AnomalyKind kind, const std::string &detail) {
+                _anomalyCounts[static_cast<int>(kind)]++;
+                _anomalies.push_back({micros, kind, detail});
+            }
+
+            void checkKnown(uint64_t micros, uint16_t address) {
+                if (nullptr != getRegisterName(address) || _unknownReported.count(address) > 0) {
+                    return;
+                }
+
+                char detail[16];
+                snprintf(detail, sizeof(detail), "0x%04X", address);
+
+                _unknownReported.insert(address);
+                this->report(micros, AnomalyKind::UNKNOWN_REGISTER, detail);
+            }
+
+            void onRequest(const BusTrace::Record &record, bool isDecodable) {
+                _requests++;
+
+                if (_hasPending) {
+                    this->report(_pendingMicros, AnomalyKind::NO_RESPONSE, this->describe(_pending));
+                }
+
+                if (_requests > 1) {
+                    _pollIntervals.add(record.micros - _lastRequestMicros);
+                }
+
+                _lastRequestMicros = record.micros;
+                _hasPending = true;
+                _pending.assign(record.data, record.data + record.size);
+                _pendingMicros = record.micros;
+
+                if (!isDecodable) {
+                    return;
+                }
+
+                if (WRITE == record.data[0]) {
+                    for (int i = 0; i < record.data[4] / 4; i++) {
+                        uint16_t address = (record.data[5 + i * 4] << 8) | record.data[6 + i * 4];
+
+                        _registers[address].writes++;
+                        this->checkKnown(record.micros, address);
+                    }
+                }
+
+                if (READ == record.data[0]) {
+                    for (int i = 0; i < record.data[4] / 2; i++) {
+                        this->checkKnown(record.micros, (record.data[5 + i * 2] << 8) | record.data[6 + i * 2]);
+                    }
+                }
+            }
+
+            void onResponse(const BusTrace::Record &record, bool isDecodable) {
+                _responses++;
+
+                if (!_hasPending) {
+                    this->report(record.micros, AnomalyKind::UNEXPECTED_RESPONSE, this->describe(record));
+
+                    return;
+                }
+
+                _hasPending = false;
+
+                int type = requestType(_pending);
+                uint64_t latency = record.micros - _pendingMicros;
+
+                _latencies[type].add(latency);
+                _allLatencies.add(latency);
+
+                if (latency >= slowResponseMicros) {
+                    char detail[32];
+                    snprintf(detail, sizeof(detail), "%s, %.1f ms", requestTypeName(type), latency / 1000.0);
+
+                    this->report(record.micros, AnomalyKind::SLOW_RESPONSE, detail);
+                }
+
+                if (!isDecodable) {
+                    return;
+                }
+
+                if (record.data[0] != _pending[0]) {
+                    this->report(record.micros, AnomalyKind::TYPE_MISMATCH, this->describe(record));
+
+                    return;
+                }
+
+                if ((WRITE == type || READ == type) && 0x01 != record.data[5]) {
+                    this->report(record.micros, AnomalyKind::INVALID_STATUS, this->describe(record));
+
+                    return;
+                }
+
+                if (READ == type) {
+                    this->onReadResponse(record);
+                }
+            }
+
+            void onReadResponse(const BusTrace::Record &record) {
+                std::set<uint16_t> requested;
+                bool isRequestDecodable = _pending.size() >= 7 && _pending[4] + 7u == _pending.size();
+
+                for (int i = 0; isRequestDecodable && i < _pending[4] / 2; i++) {
+                    requested.insert((_pending[5 + i * 2] << 8) | _pending[6 + i * 2]);
+                }
+
+                for (int i = 0; i < record.data[4] / 4; i++) {
+                    const uint8_t *pair = record.data + 6 + i * 4;
+                    uint16_t address = (pair[0] << 8) | pair[1];
+                    uint16_t value = (pair[2] << 8) | pair[3];
+
+                    if (isRequestDecodable && 0 == requested.count(address)) {
+                        char detail[16];
+                        snprintf(detail, sizeof(detail), "0x%04X", address);
+
+                        this->report(record.micros, AnomalyKind::UNREQUESTED_REGISTER, detail);
+                    }
+
+                    this->checkKnown(record.micros, address);
+
+                    RegisterStats &stats = _registers[address];
+                    stats.reads++;
+
+                    if (!stats.hasValue) {
+                        stats.hasValue = true;
+                        stats.first = value;
+                    } else if (stats.last != value) {
+                        stats.changes++;
+                    }
+
+                    stats.last = value;
+                    stats.min = std::min(stats.min, value);
+                    stats.max = std::max(stats.max, value);
+                    stats.values.insert(value);
+                }
+            }
+
+            double getDurationSeconds() const {
+                return (_endedAt - _startedAt) / 1000000.0;
+            }
+
+            void printSummary() {
+                printf("Frames      %u (%u requests, %u responses)\n", _frames, _requests, _responses);
+                printf("Bytes       %llu (%llu requests, %llu responses)\n",
+                    (unsigned long long) (_requestBytes + _responseBytes),
+                    (unsigned long long) _requestBytes,
+                    (unsigned long long) _responseBytes
+                );
+
+                if (_hasTimestamps) {
+                    printf("Duration    %.1f s\n", this->getDurationSeconds());
+                }
+            }
+
+            void printTiming() {
+                double duration = this->getDurationSeconds();
+
+                if (duration > 0) {
+                    double requestShare = _requestBytes * bitsPerByte / baudRate / duration * 100;
+                    double responseShare = _responseBytes * bitsPerByte / baudRate / duration * 100;
+
+                    printf(
+                        "Utilization %.1f %% of %.0f baud (requests %.1f %%, responses %.1f %%)\n",
+                        requestShare + responseShare,
+                        baudRate,
+                        requestShare,
+                        responseShare
+                    );
+                }
+
+                printf("\nResponse latency [ms]  count      min      p50      p95      p99      max\n");
+
+                for (int type = INIT1; type <= OTHER; type++) {
+                    this->printDistribution(requestTypeName(type), _latencies[type]);
+                }
+
+                this->printDistribution("poll interval", _pollIntervals);
+
+                std::vector<size_t> histogram = _allLatencies.histogram({20000, 50000, 100000, 200000});
+
+                printf(
+                    "\nLatency histogram  <20 ms %zu, 20-50 ms %zu, 50-100 ms %zu, 100-200 ms %zu, >=200 ms %zu, none %u\n",
+                    histogram[0],
+                    histogram[1],
+                    histogram[2],
+                    histogram[3],
+                    histogram[4],
+                    _anomalyCounts[static_cast<int>(AnomalyKind::NO_RESPONSE)]
+                );
+            }
+
+            void printDistribution(const char *name, Distribution &distribution) {
+                if (0 == distribution.getCount()) {
+                    return;
+                }
+
+                printf(
+                    "%-20s %7zu %8.1f %8.1f %8.1f %8.1f %8.1f\n",
+                    name,
+                    distribution.getCount(),
+                    distribution.min() / 1000.0,
+                    distribution.percentile(50) / 1000.0,
+                    distribution.percentile(95) / 1000.0,
+                    distribution.percentile(99) / 1000.0,
+                    distribution.percentile(100) / 1000.0
+                );
+            }
+
+            void printRegisters(const std::string &filter) {
+                if ("none" == filter) {
+                    return;
+                }
+
+                double hours = this->getDurationSeconds() / 3600.0;
+
+                printf("\nRegister  name                              reads writes changes changes/h distinct  first   last    min    max\n");
+
+                for (auto &entry: _registers) {
+                    uint16_t address = entry.first;
+                    RegisterStats &stats = entry.second;
+                    const char *name = getRegisterName(address);
+
+                    if (
+                        ("changed" == filter && 0 == stats.changes)
+                        || ("unknown" == filter && nullptr != name)
+                    ) {
+                        continue;
+                    }
+
+                    char rate[16] = "-";
+
+                    if (_hasTimestamps && hours > 0) {
+                        snprintf(rate, sizeof(rate), "%.1f", stats.changes / hours);
+                    }
+
+                    printf(
+                        "0x%04X    %-32s %6u %6u %7u %9s %8zu ",
+                        address,
+                        nullptr != name ? name : "?",
+                        stats.reads,
+                        stats.writes,
+                        stats.changes,
+                        rate,
+                        stats.values.size()
+                    );
+
+                    if (stats.hasValue) {
+                        printf(" %04X   %04X   %04X   %04X\n", stats.first, stats.last, stats.min, stats.max);
+                    } else {
+                        printf("    -      -      -      -\n");
+                    }
+                }
+            }
+
+            void printAnomalies(size_t limit) {
+                printf("\nAnomalies\n");
+
+                bool hasAny = false;
+
+                for (int kind = 0; kind < static_cast<int>(AnomalyKind::COUNT); kind++) {
+                    if (0 == _anomalyCounts[kind]) {
+                        continue;
+                    }
+
+                    hasAny = true;
+                    printf("  %-34s %u\n", anomalyName(static_cast<AnomalyKind>(kind)), _anomalyCounts[kind]);
+                }
+
+                if (!hasAny) {
+                    printf("  none\n");
+
+                    return;
+                }
+
+                std::vector<size_t> shown(static_cast<int>(AnomalyKind::COUNT), 0);
+
+                printf("\nFirst %zu of each kind\n", limit);
+
+                for (const Anomaly &anomaly: _anomalies) {
+                    size_t &count = shown[static_cast<int>(anomaly.kind)];
+
+                    if (count++ >= limit) {
+                        continue;
+                    }
+
+                    if (_hasTimestamps) {
+                        printf("  %10.3f s  ", (anomaly.micros - _startedAt) / 1000000.0);
+                    } else {
+                        printf("  ");
+                    }
+
+                    printf("%-34s %s\n", anomalyName(anomaly.kind), anomaly.detail.c_str());
+                }
+            }
+    };
+
+    void printUsage(const char *name) {
+        fprintf(stderr, "Usage: %s [--registers all|changed|unknown|none] [--anomalies n] <trace.fjt>\n", name);
+    }
+
+}
+
+int main(int argc, char **argv) {
+    Options options;
+
+    static const struct option longOptions[] = {
+        {"registers", required_argument, nullptr, 'r'},
+        {"anomalies", required_argument, nullptr, 'a'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    int option;
+
+    while (-1 != (option = getopt_long(argc, argv, "r:a:h", longOptions, nullptr))) {
+        switch (option) {
+            case 'r': options.registers = optarg; break;
+            case 'a': options.anomalies = atoi(optarg); break;
+            default:
+                printUsage(argv[0]);
+
+                return 'h' == option ? 0 : 1;
+        }
+    }
+
+    if (optind + 1 != argc) {
+        printUsage(argv[0]);
+
+        return 1;
+    }
+
+    std::vector<uint8_t> data;
+
+    if (!Host::readFile(argv[optind], data)) {
+        perror("Could not read the trace");
+
+        return 1;
+    }
+
+    BusTrace::Reader reader(data.data(), data.size());
+    BusTrace::Record record;
+    Analyzer analyzer;
+
+    while (reader.next(record)) {
+        analyzer.add(record);
+    }
+
+    analyzer.finish();
+    analyzer.print(options);
+
+    if (reader.isMalformed()) {
+        fprintf(stderr, "\nThe trace is malformed, records after the first broken one are not analysed\n");
+
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,278 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+// Converts captures of examples/Sniffer into the binary bus trace (BusTrace.h) and back
+// into readable text.
+//
+//   fujitsu_trace_convert log.txt bus.fjt          mosquitto_sub log of the hex topics
+//   fujitsu_trace_convert --text bus.fjt -         one frame per line
+//
+// The log is what `mosquitto_sub -t fujitsu/sniffer/# -v` prints. Lines may start with a
+// timestamp, `-F '%U %t %p'` (Unix time with fraction) or `-F '%I %t %p'` (ISO 8601).
+// Without timestamps the trace is marked as such and only frame contents can be analysed.
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include "BusTrace.h"
+#include "Files.h"
+#include "FrameLog.h"
+
+using namespace FujitsuAC;
+
+namespace {
+
+    struct Line {
+        bool hasTime;
+        uint64_t micros;
+        BusTrace::Direction direction;
+        std::vector<uint8_t> frame;
+    };
+
+    std::vector<std::string> split(const char *text) {
+        std::vector<std::string> tokens;
+        std::string token;
+
+        for (const char *c = text; ; c++) {
+            if ('\0' == *c || ' ' == *c || '\t' == *c || '\r' == *c || '\n' == *c) {
+                if (!token.empty()) {
+                    tokens.push_back(token);
+                    token.clear();
+                }
+
+                if ('\0' == *c) {
+                    return tokens;
+                }
+
+                continue;
+            }
+
+            token += *c;
+        }
+    }
+
+    bool endsWith(const std::string &value, const char *suffix) {
+        size_t length = strlen(suffix);
+
+        return value.size() >= length && 0 == value.compare(value.size() - length, length, suffix);
+    }
+
+    // "1718000000.123456789" or "2024-06-10T08:13:20[.123][+0200]", the zone is ignored
+    bool parseTime(const std::string &value, uint64_t &micros) {
+        char *end;
+        double seconds = strtod(value.c_str(), &end);
+
+        if ('\0' == *end && end != value.c_str()) {
+            micros = (uint64_t) (seconds * 1000000.0 + 0.5);
+
+            return true;
+        }
+
+        struct tm parts = {};
+        const char *rest = strptime(value.c_str(), "%Y-%m-%dT%H:%M:%S", &parts);
+
+        if (nullptr == rest) {
+            return false;
+        }
+
+        micros = (uint64_t) timegm(&parts) * 1000000;
+
+        if ('.' == *rest) {
+            uint64_t scale = 100000;
+
+            for (rest++; *rest >= '0' && *rest <= '9'; rest++) {
+                micros += (*rest - '0') * scale;
+                scale /= 10;
+            }
+        }
+
+        return true;
+    }
+
+    bool parseLine(const char *text, Line &line) {
+        std::vector<std::string> tokens = split(text);
+        size_t topic = 0;
+
+        while (topic < tokens.size() && !endsWith(tokens[topic], "/tx") && !endsWith(tokens[topic], "/rx")) {
+            topic++;
+        }
+
+        if (topic >= tokens.size() || topic + 1 >= tokens.size()) {
+            return false;
+        }
+
+        line.direction = endsWith(tokens[topic], "/tx") ? BusTrace::Direction::REQUEST : BusTrace::Direction::RESPONSE;
+        line.hasTime = topic > 0 && parseTime(tokens[0], line.micros);
+        line.frame.clear();
+
+        for (size_t i = topic + 1; i < tokens.size(); i++) {
+            char *end;
+            unsigned long value = strtoul(tokens[i].c_str(), &end, 16);
+
+            if ('\0' != *end || value > 0xFF) {
+                return false;
+            }
+
+            line.frame.push_back(value);
+        }
+
+        return line.frame.size() <= 0xFF;
+    }
+
+    int logToTrace(const char *input, const char *output) {
+        FILE *in = 0 == strcmp(input, "-") ? stdin : fopen(input, "r");
+        FILE *out = 0 == strcmp(output, "-") ? stdout : fopen(output, "wb");
+
+        if (nullptr == in || nullptr == out) {
+            perror("Could not open the files");
+
+            return 1;
+        }
+
+        static uint8_t chunk[65536];
+        BusTrace::Writer writer(chunk, sizeof(chunk));
+
+        char text[2048];
+        Line line;
+        bool isStarted = false;
+        uint8_t flags = 0;
+        uint64_t micros = 0;
+        uint32_t frames = 0;
+        uint32_t skipped = 0;
+
+        while (nullptr != fgets(text, sizeof(text), in)) {
+            if (!parseLine(text, line)) {
+                // debug messages, empty lines and truncated frames
+                skipped++;
+
+                continue;
+            }
+
+            if (!isStarted) {
+                flags = line.hasTime ? 0 : BusTrace::NO_TIMESTAMPS;
+                micros = line.hasTime ? line.micros : 0;
+
+                writer.begin(micros, flags);
+                isStarted = true;
+            } else if (line.hasTime && 0 == (flags & BusTrace::NO_TIMESTAMPS)) {
+                // lines without time keep the one before them
+                micros = line.micros;
+            }
+
+            bool isValid = BusTrace::isValidFrame(line.frame.data(), line.frame.size());
+
+            if (!writer.write(micros, line.direction, isValid, line.frame.data(), line.frame.size())) {
+                fwrite(writer.getData(), 1, writer.getSize(), out);
+
+                writer.clear();
+                writer.begin(micros, flags);
+                writer.write(micros, line.direction, isValid, line.frame.data(), line.frame.size());
+            }
+
+            frames++;
+        }
+
+        if (isStarted) {
+            fwrite(writer.getData(), 1, writer.getSize(), out);
+        }
+
+        fprintf(
+            stderr,
+            "%u frames%s, %u other lines skipped\n",
+            frames,
+            (flags & BusTrace::NO_TIMESTAMPS) ? " without timestamps" : "",
+            skipped
+        );
+
+        if (stdin != in) {
+            fclose(in);
+        }
+
+        if (stdout != out) {
+            fclose(out);
+        }
+
+        return 0;
+    }
+
+    int traceToText(const char *input, const char *output) {
+        std::vector<uint8_t> data;
+        FILE *out = 0 == strcmp(output, "-") ? stdout : fopen(output, "w");
+
+        if (!Host::readFile(input, data) || nullptr == out) {
+            perror("Could not open the files");
+
+            return 1;
+        }
+
+        BusTrace::Reader reader(data.data(), data.size());
+        BusTrace::Record record;
+        bool isFirst = true;
+        uint64_t startedAt = 0;
+        char hex[3 * 256];
+
+        while (reader.next(record)) {
+            if (isFirst) {
+                startedAt = record.micros;
+                isFirst = false;
+            }
+
+            FrameLog::toHex(record.data, record.size, hex, sizeof(hex));
+
+            if (record.blockFlags & BusTrace::NO_TIMESTAMPS) {
+                fprintf(out, "- ");
+            } else {
+                fprintf(out, "%.6f ", (record.micros - startedAt) / 1000000.0);
+            }
+
+            fprintf(
+                out,
+                "%s %s%s\n",
+                BusTrace::Direction::REQUEST == record.direction ? "tx" : "rx",
+                hex,
+                record.isValid ? "" : " invalid"
+            );
+        }
+
+        if (stdout != out) {
+            fclose(out);
+        }
+
+        if (reader.isMalformed()) {
+            fprintf(stderr, "The trace is malformed, stopped at the first broken record\n");
+
+            return 1;
+        }
+
+        return 0;
+    }
+
+}
+
+int main(int argc, char **argv) {
+    if (4 == argc && 0 == strcmp(argv[1], "--text")) {
+        return traceToText(argv[2], argv[3]);
+    }
+
+    if (3 == argc && 0 != strncmp(argv[1], "--", 2)) {
+        return logToTrace(argv[1], argv[2]);
+    }
+
+    fprintf(
+        stderr,
+        "Usage: %s <mosquitto log> <trace.fjt>\n"
+        "       %s --text <trace.fjt> <output.txt>\n"
+        "Use - for stdin or stdout.\n",
+        argv[0],
+        argv[0]
+    );
+
+    return 1;
+}
\ No newline at end of file
@@ -6,15 +6,16 @@
 */
 
 #include "Buffer.h"
+#include "Trace.h"
 
 namespace FujitsuAC {
 
-    Buffer::Buffer(Stream &uart): uart(uart) {}
+    Buffer::Buffer(Stream &uart, Clock &clock): uart(uart), clock(clock) {}
 
     bool Buffer::loop(std::function<void(uint8_t buffer[128], int size, bool isValid)> callback) {
         while (this->uart.available()) {
             uint8_t b = uart.read();
-            uint32_t now = millis();
+            uint32_t now = this->clock.millis();
 
             if ((now - this->lastMillis) >= 20) {
                 this->currentIndex = 0;
@@ -25,12 +26,22 @@ namespace FujitsuAC {
             this->currentIndex++;
 
             if (this->currentIndex > 4 && this->currentIndex == (int) this->buffer[4] + 7) {
+                int size = (int) this->buffer[4] + 7;
+                bool isValid = this->isValidFrame(this->buffer, size);
+
+                // a frame may follow without a gap
+                this->currentIndex = 0;
+
+                if (!isValid) {
+                    FUJITSU_TRACE_INSTANT("checksum_error", BUS, size);
+                }
+
                 if (callback) {
-                    callback(
-                        this->buffer, (int) this->buffer[4] + 7,
-                        this->isValidFrame(this->buffer, (int) this->buffer[4] + 7)
-                    );
+                    callback(this->buffer, size, isValid);
                 }
+            } else if (this->currentIndex >= (int) sizeof(this->buffer)) {
+                // length byte beyond the buffer, noise until the next gap
+                this->currentIndex = 0;
             }
         }
         
@@ -39,14 +50,18 @@ namespace FujitsuAC {
 
     bool Buffer::isValidFrame(uint8_t buffer[128], int size) {
         uint16_t frameChecksum = (buffer[size - 2] << 8) | buffer[size - 1];
-        
-        uint16_t checksum = 0xFFFF; 
-        
-        for (int i = 0; i < size - 2; i++) {
+
+        return frameChecksum == Buffer::checksum(buffer, size - 2);
+    }
+
+    uint16_t Buffer::checksum(const uint8_t *buffer, int size) {
+        uint16_t checksum = 0xFFFF;
+
+        for (int i = 0; i < size; i++) {
             checksum -= buffer[i];
         }
-        
-        return frameChecksum == checksum;
+
+        return checksum;
     }
 
 }
\ No newline at end of file
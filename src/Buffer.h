@@ -7,17 +7,22 @@
 
 #pragma once
 #include <Arduino.h>
+#include "Clock.h"
 
 namespace FujitsuAC {
 
     class Buffer {
         public:
-            Buffer(Stream &uart);
+            Buffer(Stream &uart, Clock &clock = Clock::system());
 
             bool loop(std::function<void(uint8_t buffer[128], int size, bool isValid)> callback);
 
+            // 0xFFFF minus every byte, frames carry it big endian in the last two bytes
+            static uint16_t checksum(const uint8_t *buffer, int size);
+
         private:
             Stream &uart;
+            Clock &clock;
 
             uint32_t lastMillis = 0;
             uint8_t buffer[128];
@@ -0,0 +1,158 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include "BusTrace.h"
+#include "Buffer.h"
+
+namespace FujitsuAC {
+
+    bool BusTrace::Writer::begin(uint64_t baseMicros, uint8_t flags) {
+        if (_capacity - _size < blockHeaderSize) {
+            return false;
+        }
+
+        uint8_t *out = _buffer + _size;
+
+        memcpy(out, magic, sizeof(magic));
+        out[4] = version;
+        out[5] = flags;
+
+        for (int i = 0; i < 8; i++) {
+            out[6 + i] = (baseMicros >> (8 * i)) & 0xFF;
+        }
+
+        _size += blockHeaderSize;
+        _lastMicros = baseMicros;
+
+        return true;
+    }
+
+    bool BusTrace::Writer::write(uint64_t micros, Direction direction, bool isValid, const uint8_t *data, size_t size) {
+        if (size > 0xFF || _capacity - _size < maxRecordOverhead + size) {
+            return false;
+        }
+
+        // time never goes back within a block, a new block is needed for that
+        uint64_t elapsed = micros > _lastMicros ? micros - _lastMicros : 0;
+        uint32_t delta = elapsed > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t) elapsed;
+        uint32_t value = delta;
+
+        do {
+            uint8_t byte = value & 0x7F;
+            value >>= 7;
+
+            _buffer[_size++] = value > 0 ? (byte | 0x80) : byte;
+        } while (value > 0);
+
+        _buffer[_size++] = (Direction::RESPONSE == direction ? 0x01 : 0x00) | (isValid ? 0x00 : 0x02);
+        _buffer[_size++] = size;
+
+        memcpy(_buffer + _size, data, size);
+        _size += size;
+
+        _lastMicros += delta;
+
+        return true;
+    }
+
+    bool BusTrace::Reader::next(Record &record) {
+        if (_isMalformed) {
+            return false;
+        }
+
+        // blocks may follow each other without records in between
+        while (_position + sizeof(magic) <= _size && 0 == memcmp(_data + _position, magic, sizeof(magic))) {
+            if (!this->readBlock()) {
+                return false;
+            }
+        }
+
+        if (_position >= _size) {
+            return false;
+        }
+
+        if (!_hasBlock) {
+            return this->fail();
+        }
+
+        uint32_t delta = 0;
+
+        for (int shift = 0; ; shift += 7) {
+            if (_position >= _size || shift > 28) {
+                return this->fail();
+            }
+
+            uint8_t byte = _data[_position++];
+            delta |= (uint32_t) (byte & 0x7F) << shift;
+
+            if (0 == (byte & 0x80)) {
+                break;
+            }
+        }
+
+        if (_position + 2 > _size) {
+            return this->fail();
+        }
+
+        uint8_t flags = _data[_position++];
+        uint8_t size = _data[_position++];
+
+        if ((flags & ~0x03) || _position + size > _size) {
+            return this->fail();
+        }
+
+        _lastMicros += delta;
+
+        record.micros = _lastMicros;
+        record.direction = (flags & 0x01) ? Direction::RESPONSE : Direction::REQUEST;
+        record.isValid = 0 == (flags & 0x02);
+        record.size = size;
+        record.data = _data + _position;
+        record.blockFlags = _blockFlags;
+
+        _position += size;
+
+        return true;
+    }
+
+    bool BusTrace::Reader::readBlock() {
+        if (_position + blockHeaderSize > _size || version != _data[_position + 4]) {
+            return this->fail();
+        }
+
+        const uint8_t *header = _data + _position;
+
+        _blockFlags = header[5];
+        _lastMicros = 0;
+
+        for (int i = 0; i < 8; i++) {
+            _lastMicros |= (uint64_t) header[6 + i] << (8 * i);
+        }
+
+        _position += blockHeaderSize;
+        _hasBlock = true;
+
+        return true;
+    }
+
+    bool BusTrace::Reader::fail() {
+        _isMalformed = true;
+
+        return false;
+    }
+
+    bool BusTrace::isValidFrame(const uint8_t *data, size_t size) {
+        if (size < 7) {
+            return false;
+        }
+
+        uint16_t frameChecksum = (data[size - 2] << 8) | data[size - 1];
+
+        return frameChecksum == Buffer::checksum(data, size - 2);
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+namespace FujitsuAC {
+
+    // Timestamped capture of bus frames in a compact binary form.
+    //
+    //   block   "FJTR", version, flags, time base in microseconds (uint64, little endian)
+    //   record  microseconds since the previous record or the block (LEB128 varint),
+    //           flags (response, invalid checksum), frame size, frame bytes
+    //
+    // A trace is a sequence of blocks, each one starts a new time base. Chunks published by
+    // the sniffer are blocks, so they can be appended to one file as they arrive. A record
+    // never looks like a block, its flags byte would be 'J'.
+    class BusTrace {
+        public:
+            static constexpr uint8_t magic[4] = {'F', 'J', 'T', 'R'};
+            static constexpr uint8_t version = 1;
+            static constexpr size_t blockHeaderSize = 14;
+            // varint of a uint32, flags and size
+            static constexpr size_t maxRecordOverhead = 7;
+
+            enum class Direction: uint8_t {
+                // controller or dongle to the indoor unit
+                REQUEST = 0,
+                // indoor unit to the controller
+                RESPONSE = 1,
+            };
+
+            enum BlockFlags: uint8_t {
+                // converted from a log without time, every record has the time of its block
+                NO_TIMESTAMPS = 0x01,
+            };
+
+            struct Record {
+                uint64_t micros;
+                Direction direction;
+                bool isValid;
+                uint8_t size;
+                const uint8_t *data;
+                // flags of the block the record belongs to
+                uint8_t blockFlags;
+            };
+
+            // Appends blocks and records to a caller owned buffer
+            class Writer {
+                public:
+                    Writer(uint8_t *buffer, size_t capacity): _buffer(buffer), _capacity(capacity) {}
+
+                    // Both return false when the buffer has no room left, nothing is written then
+                    bool begin(uint64_t baseMicros, uint8_t flags = 0);
+                    bool write(uint64_t micros, Direction direction, bool isValid, const uint8_t *data, size_t size);
+
+                    void clear() { _size = 0; }
+
+                    const uint8_t* getData() const { return _buffer; }
+                    size_t getSize() const { return _size; }
+                    // records written since the last clear()
+                    bool isEmpty() const { return _size <= blockHeaderSize; }
+
+                private:
+                    uint8_t *_buffer;
+                    size_t _capacity;
+                    size_t _size = 0;
+                    uint64_t _lastMicros = 0;
+            };
+
+            // Walks the records of a trace held in memory
+            class Reader {
+                public:
+                    Reader(const uint8_t *data, size_t size): _data(data), _size(size) {}
+
+                    // false at the end of the trace or when it is malformed
+                    bool next(Record &record);
+                    bool isMalformed() const { return _isMalformed; }
+
+                private:
+                    const uint8_t *_data;
+                    size_t _size;
+                    size_t _position = 0;
+                    bool _hasBlock = false;
+                    bool _isMalformed = false;
+                    uint8_t _blockFlags = 0;
+                    uint64_t _lastMicros = 0;
+
+                    bool readBlock();
+                    bool fail();
+            };
+
+            // Checksum over everything but the last two bytes matches them
+            static bool isValidFrame(const uint8_t *data, size_t size);
+    };
+
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+namespace FujitsuAC {
+
+    // Time source of the bus and bridge timers. Classes take it by reference,
+    // host builds pass a simulated clock and run hours of traffic in milliseconds.
+    class Clock {
+        public:
+            virtual ~Clock() = default;
+
+            virtual uint32_t millis() = 0;
+            virtual uint32_t micros() = 0;
+
+            // millis() and micros() of the Arduino core
+            static Clock& system();
+    };
+
+    class SystemClock: public Clock {
+        public:
+            uint32_t millis() override {
+                return ::millis();
+            }
+
+            uint32_t micros() override {
+                return ::micros();
+            }
+    };
+
+    inline Clock& Clock::system() {
+        static SystemClock clock;
+
+        return clock;
+    }
+
+}
\ No newline at end of file
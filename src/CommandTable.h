@@ -0,0 +1,75 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+namespace FujitsuAC {
+
+    // FNV-1a
+    constexpr uint32_t commandHash(const char *name) {
+        uint32_t hash = 2166136261u;
+
+        while ('\0' != *name) {
+            hash = (hash ^ (uint8_t) *name++) * 16777619u;
+        }
+
+        return hash;
+    }
+
+    // Command name -> handler lookup built at compile time. Size is chosen so that
+    // every name gets its own slot (hash % Size), check it with isPerfect() in a static_assert.
+    // Command has to provide a "name" member.
+    template<typename Command, size_t Count, size_t Size>
+    class CommandTable {
+        public:
+            constexpr CommandTable(const Command (&commands)[Count]):
+                _commands{},
+                _slots{}
+            {
+                static_assert(Count < empty, "Too many commands");
+
+                for (size_t i = 0; i < Size; i++) {
+                    _slots[i] = empty;
+                }
+
+                for (size_t i = 0; i < Count; i++) {
+                    size_t slot = commandHash(commands[i].name) % Size;
+
+                    if (empty != _slots[slot]) {
+                        _isPerfect = false;
+                    }
+
+                    _commands[i] = commands[i];
+                    _slots[slot] = i;
+                }
+            }
+
+            constexpr bool isPerfect() const {
+                return _isPerfect;
+            }
+
+            const Command* find(const char *name) const {
+                uint8_t index = _slots[commandHash(name) % Size];
+
+                if (empty == index || 0 != strcmp(_commands[index].name, name)) {
+                    return nullptr;
+                }
+
+                return &_commands[index];
+            }
+
+        private:
+            static constexpr uint8_t empty = 0xFF;
+
+            Command _commands[Count];
+            uint8_t _slots[Size];
+            bool _isPerfect = true;
+    };
+
+}
\ No newline at end of file
@@ -5,12 +5,28 @@
   Project home: https://github.com/Benas09/FujitsuAC
 */
 
-#pragma once
-
 #include "Config.h"
 
 namespace FujitsuAC {
 
+    const Config::Field Config::fields[] = {
+        {"wifi-ssid", offsetof(Values, wifiSsid), sizeof(Values::wifiSsid)},
+        {"wifi-pw", offsetof(Values, wifiPw), sizeof(Values::wifiPw)},
+        {"mqtt-ip", offsetof(Values, mqttIp), sizeof(Values::mqttIp)},
+        {"mqtt-port", offsetof(Values, mqttPort), sizeof(Values::mqttPort)},
+        {"mqtt-user", offsetof(Values, mqttUser), sizeof(Values::mqttUser)},
+        {"mqtt-pw", offsetof(Values, mqttPw), sizeof(Values::mqttPw)},
+        {"device-name", offsetof(Values, deviceName), sizeof(Values::deviceName)},
+        {"ota-pw", offsetof(Values, otaPw), sizeof(Values::otaPw)},
+        {"protocol", offsetof(Values, protocol), sizeof(Values::protocol)},
+        {"static-ip", offsetof(Values, staticIp), sizeof(Values::staticIp)},
+        {"gateway", offsetof(Values, gateway), sizeof(Values::gateway)},
+        {"subnet", offsetof(Values, subnet), sizeof(Values::subnet)},
+        {"dns", offsetof(Values, dns), sizeof(Values::dns)},
+    };
+
+    const size_t Config::fieldCount = sizeof(Config::fields) / sizeof(Config::fields[0]);
+
     Config::Config(
         const char *version, 
         uart_port_t uartPort,
@@ -33,16 +49,45 @@ namespace FujitsuAC {
 
 	Config::~Config() {
 	    _preferences.end();
+
+	    this->clearLegacyValues();
 	}
 
     void Config::generateUniqueId() {
-        char buf[13];
-        snprintf(buf, sizeof(buf), "%012llX", ESP.getEfuseMac());
+        snprintf(_uniqueId, sizeof(_uniqueId), "%012llx", (unsigned long long) ESP.getEfuseMac());
+    }
 
-        String uniqueId = buf;
-        uniqueId.toLowerCase();
+    char* Config::getField(const Field &field) {
+        return reinterpret_cast<char*>(&_values) + field.offset;
+    }
 
-        _uniqueId = uniqueId;
+    const char* Config::getValue(const char *slot) const {
+        if (nullptr == _legacyValues) {
+            return slot;
+        }
+
+        size_t offset = slot - reinterpret_cast<const char*>(&_values);
+
+        for (size_t i = 0; i < fieldCount; i++) {
+            if (offset == fields[i].offset && !_legacyValues[i].isEmpty()) {
+                return _legacyValues[i].c_str();
+            }
+        }
+
+        return slot;
+    }
+
+    void Config::clearLegacyValues() {
+        delete[] _legacyValues;
+        _legacyValues = nullptr;
+    }
+
+    void Config::setDefaults() {
+        memset(&_values, 0, sizeof(_values));
+
+        _values.ledsOn = true;
+        _values.wifiSleepEnabled = true;
+        _values.lowCpuSpeedEnabled = true;
     }
 
     void Config::load() {
@@ -50,20 +95,188 @@ namespace FujitsuAC {
         
         _preferences.begin("fujitsu_ac", false);
 
-        _wifiSsid = _preferences.getString("wifi-ssid", "");
-        _wifiPw = _preferences.getString("wifi-pw", "");
-        _mqttIp = _preferences.getString("mqtt-ip", "");
-        _mqttPort = _preferences.getString("mqtt-port", "");
-        _mqttUser = _preferences.getString("mqtt-user", "");
-        _mqttPw = _preferences.getString("mqtt-pw", "");
-        _deviceName = _preferences.getString("device-name", "");
-        _otaPw = _preferences.getString("ota-pw", "");
-        _protocol = _preferences.getString("protocol", "");
-        _ledsOn = _preferences.getBool("leds-on", true);
-        _wifiSleepEnabled = _preferences.getBool("wifi-sleep", true);
-        _lowCpuSpeedEnabled = _preferences.getBool("low-cpu-speed", true);
+        if (!this->loadRecord()) {
+            this->migrateLegacyKeys();
+        }
+
+        this->setLowCpuSpeedEnabled(_values.lowCpuSpeedEnabled);
+    }
+
+    bool Config::loadRecord() {
+        this->setDefaults();
+
+        uint8_t record[maxRecordSize];
+        size_t size = _preferences.getBytesLength("config");
+
+        if (size < sizeof(RecordHeader) || size > sizeof(record)) {
+            return false;
+        }
+
+        if (size != _preferences.getBytes("config", record, size)) {
+            return false;
+        }
+
+        RecordHeader header;
+        memcpy(&header, record, sizeof(header));
+
+        const uint8_t *payload = record + sizeof(header);
+
+        if (
+            recordMagic != header.magic
+            || header.version < firstRecordVersion
+            || header.length != size - sizeof(header)
+            || header.crc != this->crc(payload, header.length)
+        ) {
+            return false;
+        }
+
+        memcpy(&_values, payload, std::min(static_cast<size_t>(header.length), sizeof(_values)));
+
+        for (size_t i = 0; i < fieldCount; i++) {
+            this->getField(fields[i])[fields[i].size - 1] = '\0';
+        }
+
+        if (header.version > recordVersion) {
+            // fields are only appended, the known ones are read. Rewriting the record
+            // would drop the settings this firmware does not know
+            _isNewerRecord = true;
+
+            return true;
+        }
+
+        if (recordVersion != header.version || sizeof(_values) != header.length) {
+            // record written by another firmware version, store it in the current layout
+            this->save();
+        }
+
+        return true;
+    }
+
+    void Config::migrateLegacyKeys() {
+        // Until 1.4.4 every setting was stored under its own key. The keys are kept,
+        // a rollback to such a version still finds its configuration
+        this->setDefaults();
+
+        bool isComplete = true;
+
+        for (size_t i = 0; i < fieldCount; i++) {
+            char *value = this->getField(fields[i]);
+
+            if (0 == _preferences.getString(fields[i].key, value, fields[i].size)) {
+                value[0] = '\0';
 
-        this->setLowCpuSpeedEnabled(_lowCpuSpeedEnabled);
+                // an existing key reads as 0 only when the value does not fit its slot,
+                // the full value is kept aside and served until the page saves new settings
+                if (_preferences.isKey(fields[i].key)) {
+                    if (nullptr == _legacyValues) {
+                        _legacyValues = new String[fieldCount];
+                    }
+
+                    _legacyValues[i] = _preferences.getString(fields[i].key, String());
+                    isComplete = false;
+                }
+            }
+        }
+
+        _values.ledsOn = _preferences.getBool("leds-on", true);
+        _values.wifiSleepEnabled = _preferences.getBool("wifi-sleep", true);
+        _values.lowCpuSpeedEnabled = _preferences.getBool("low-cpu-speed", true);
+
+        if (this->isEmpty()) {
+            return;
+        }
+
+        if (!isComplete) {
+            // no record, a truncated credential would be stored for good
+            _isLegacyLayout = true;
+
+            return;
+        }
+
+        this->save();
+    }
+
+    void Config::save() {
+        // every field is set by the configuration page, the record replaces the legacy keys
+        // and a record of a newer firmware
+        _isLegacyLayout = false;
+        _isNewerRecord = false;
+        this->clearLegacyValues();
+
+        this->saveBlob("config", recordVersion, &_values, sizeof(_values));
+    }
+
+    void Config::saveFlags() {
+        if (_isNewerRecord) {
+            // applied for this boot only
+            return;
+        }
+
+        if (!_isLegacyLayout) {
+            this->saveBlob("config", recordVersion, &_values, sizeof(_values));
+
+            return;
+        }
+
+        _preferences.putBool("leds-on", _values.ledsOn);
+        _preferences.putBool("wifi-sleep", _values.wifiSleepEnabled);
+        _preferences.putBool("low-cpu-speed", _values.lowCpuSpeedEnabled);
+    }
+
+    bool Config::loadBlob(const char* key, uint16_t version, void* data, size_t size) {
+        uint8_t record[maxRecordSize];
+        size_t recordSize = sizeof(RecordHeader) + size;
+
+        if (recordSize > sizeof(record) || recordSize != _preferences.getBytesLength(key)) {
+            return false;
+        }
+
+        if (recordSize != _preferences.getBytes(key, record, recordSize)) {
+            return false;
+        }
+
+        RecordHeader header;
+        memcpy(&header, record, sizeof(header));
+
+        const uint8_t *payload = record + sizeof(header);
+
+        if (
+            recordMagic != header.magic
+            || version != header.version
+            || size != header.length
+            || header.crc != this->crc(payload, size)
+        ) {
+            return false;
+        }
+
+        memcpy(data, payload, size);
+
+        return true;
+    }
+
+    bool Config::saveBlob(const char* key, uint16_t version, const void* data, size_t size) {
+        uint8_t record[maxRecordSize];
+
+        if (sizeof(RecordHeader) + size > sizeof(record)) {
+            return false;
+        }
+
+        RecordHeader header = {
+            recordMagic,
+            version,
+            static_cast<uint16_t>(size),
+            this->crc(static_cast<const uint8_t*>(data), size)
+        };
+
+        memcpy(record, &header, sizeof(header));
+        memcpy(record + sizeof(header), data, size);
+
+        // single blob write, NVS either keeps the previous record or the new one
+        return sizeof(header) + size == _preferences.putBytes(key, record, sizeof(header) + size);
+    }
+
+    uint32_t Config::crc(const uint8_t *data, size_t length) {
+        return esp_rom_crc32_le(0, data, length);
     }
 
     void Config::clear() {
@@ -71,11 +284,21 @@ namespace FujitsuAC {
 	}
 
 	bool Config::isEmpty() {
-		return _wifiSsid == "";
+		return '\0' == this->getWifiSsid()[0];
 	}
 
-	void Config::setValue(const char* key, String value) {
-		_preferences.putString(key, value);
+	void Config::setValue(const char* key, const char* value) {
+		for (size_t i = 0; i < fieldCount; i++) {
+			if (0 == strcmp(fields[i].key, key)) {
+				strlcpy(this->getField(fields[i]), value, fields[i].size);
+
+				if (nullptr != _legacyValues) {
+					_legacyValues[i] = String();
+				}
+
+				return;
+			}
+		}
 	}
 
     void Config::initIO() {
@@ -111,9 +334,9 @@ namespace FujitsuAC {
     }
 
     void Config::setLedsStatus(bool status) {
-        if (_ledsOn != status) {
-            _ledsOn = status;
-            _preferences.putBool("leds-on", status);
+        if (_values.ledsOn != status) {
+            _values.ledsOn = status;
+            this->saveFlags();
         }
 
         this->toggleWLed(status);
@@ -121,28 +344,28 @@ namespace FujitsuAC {
     }
 
     bool Config::isLedsOn() {
-        return _ledsOn;
+        return _values.ledsOn;
     }
 
     void Config::setWifiSleepEnabled(bool status) 
     {
-        if (_wifiSleepEnabled != status) {
-            _wifiSleepEnabled = status;
-            _preferences.putBool("wifi-sleep", status);
+        if (_values.wifiSleepEnabled != status) {
+            _values.wifiSleepEnabled = status;
+            this->saveFlags();
         }
 
         WiFi.setSleep(status);
     }
 
     bool Config::isWifiSleepEnabled() {
-        return _wifiSleepEnabled;
+        return _values.wifiSleepEnabled;
     }
 
     void Config::setLowCpuSpeedEnabled(bool status) 
     {
-        if (_lowCpuSpeedEnabled != status) {
-            _lowCpuSpeedEnabled = status;
-            _preferences.putBool("low-cpu-speed", status);
+        if (_values.lowCpuSpeedEnabled != status) {
+            _values.lowCpuSpeedEnabled = status;
+            this->saveFlags();
         }
 
         uint32_t minFreq = 80;
@@ -159,6 +382,6 @@ namespace FujitsuAC {
     }
 
     bool Config::isLowCpuSpeedEnabled() {
-        return _lowCpuSpeedEnabled;
+        return _values.lowCpuSpeedEnabled;
     }
 }
\ No newline at end of file
@@ -9,11 +9,19 @@
 
 #include <Preferences.h>
 #include <WiFi.h>
+#include "esp_rom_crc.h"
 
 namespace FujitsuAC {
 
     class Config {
     	public:
+            // buffer sizes of the MQTT settings including the terminating zero,
+            // for code that keeps its own copy (esp-mqtt backend)
+            static constexpr size_t mqttHostSize = 254;
+            static constexpr size_t mqttUserSize = 129;
+            static constexpr size_t mqttPwSize = 129;
+            static constexpr size_t deviceNameSize = 65;
+
     		Config(
                 const char *version, 
                 uart_port_t uartPort,
@@ -34,9 +42,15 @@ namespace FujitsuAC {
             void toggleWLed(bool status);
             void toggleRLed(bool status);
 
-    		String getUniqueId() { return _uniqueId; }
+    		const char* getUniqueId() const { return _uniqueId; }
+
+    		void setValue(const char* key, const char* value);
+    		void save();
 
-    		void setValue(const char* key, String value);
+    		// Other persistent data (scenes, ...) stored in the same record format as the settings.
+    		// Load fails when the blob is missing, corrupted or of another version or size
+    		bool loadBlob(const char* key, uint16_t version, void* data, size_t size);
+    		bool saveBlob(const char* key, uint16_t version, const void* data, size_t size);
 
     		const char* getVersion() { return _version; }
 
@@ -57,20 +71,77 @@ namespace FujitsuAC {
     		int getLedWPin() { return _ledWPin; }
     		int getLedRPin() { return _ledRPin; }
 
-    		String getWifiSsid() { return _wifiSsid; }
-    		String getWifiPw() { return _wifiPw; }
-    		const String& getMqttIp() { return _mqttIp; }
-    		String getMqttPort() { return _mqttPort; }
-    		String getMqttUser() { return _mqttUser; }
-    		String getMqttPw() { return _mqttPw; }
-    		String getDeviceName() { return _deviceName; }
-    		String getOtaPw() { return _otaPw; }
-    		String getProtocol() { return _protocol; }
+    		const char* getWifiSsid() const { return this->getValue(_values.wifiSsid); }
+    		const char* getWifiPw() const { return this->getValue(_values.wifiPw); }
+    		const char* getMqttIp() const { return this->getValue(_values.mqttIp); }
+    		const char* getMqttPort() const { return this->getValue(_values.mqttPort); }
+    		const char* getMqttUser() const { return this->getValue(_values.mqttUser); }
+    		const char* getMqttPw() const { return this->getValue(_values.mqttPw); }
+    		const char* getDeviceName() const { return this->getValue(_values.deviceName); }
+    		const char* getOtaPw() const { return this->getValue(_values.otaPw); }
+    		const char* getProtocol() const { return this->getValue(_values.protocol); }
+    		const char* getStaticIp() const { return this->getValue(_values.staticIp); }
+    		const char* getGateway() const { return this->getValue(_values.gateway); }
+    		const char* getSubnet() const { return this->getValue(_values.subnet); }
+    		const char* getDns() const { return this->getValue(_values.dns); }
 
         private:
+            // All settings live in this single arena, which is also the payload of
+            // the stored config record. Sizes include the terminating zero and
+            // match the limits of the configuration page, WiFi and DNS.
+            // Fields may only be appended: older records are migrated by reading
+            // their shorter payload and keeping defaults for the new tail.
+            struct Values {
+                char wifiSsid[33];
+                char wifiPw[65];
+                char mqttIp[mqttHostSize];
+                char mqttPort[6];
+                char mqttUser[mqttUserSize];
+                char mqttPw[mqttPwSize];
+                char deviceName[deviceNameSize];
+                char otaPw[65];
+                char protocol[17];
+                uint8_t ledsOn;
+                uint8_t wifiSleepEnabled;
+                uint8_t lowCpuSpeedEnabled;
+                char staticIp[16];
+                char gateway[16];
+                char subnet[16];
+                char dns[16];
+            } __attribute__((packed));
+
+            struct RecordHeader {
+                uint32_t magic;
+                uint16_t version;
+                uint16_t length;
+                uint32_t crc;
+            } __attribute__((packed));
+
+            static constexpr uint32_t recordMagic = 0x43414A46; // "FJAC"
+            static constexpr uint16_t recordVersion = 3;
+            // records before version 3 had narrower slots and were never released
+            static constexpr uint16_t firstRecordVersion = 3;
+            static constexpr size_t maxRecordSize = 1024;
+
+            struct Field {
+                const char *key;
+                size_t offset;
+                size_t size;
+            };
+
+            static const Field fields[];
+            static const size_t fieldCount;
+
             Preferences _preferences;
             
-            String _uniqueId;
+            Values _values = {};
+            char _uniqueId[13] = {};
+            // a legacy value did not fit its slot, the legacy keys stay authoritative
+            bool _isLegacyLayout = false;
+            // full legacy values of the fields that do not fit their slot, one per field
+            String *_legacyValues = nullptr;
+            // the record was written by a newer firmware, it is read but never rewritten
+            bool _isNewerRecord = false;
             const char *_version;
             
             uart_port_t _uartPort;
@@ -81,21 +152,15 @@ namespace FujitsuAC {
             int _ledRPin;
             int _resetButtonPin;
 
-            String _wifiSsid;
-            String _wifiPw;
-            String _mqttIp;
-            String _mqttPort;
-            String _mqttUser;
-            String _mqttPw;
-            String _deviceName;
-            String _otaPw;
-            String _protocol;
-            
-            bool _ledsOn = true;
-            bool _wifiSleepEnabled = true;
-            bool _lowCpuSpeedEnabled = true;
-
             void generateUniqueId();
+            char* getField(const Field &field);
+            const char* getValue(const char *slot) const;
+            void clearLegacyValues();
+            void setDefaults();
+            bool loadRecord();
+            void migrateLegacyKeys();
+            void saveFlags();
+            static uint32_t crc(const uint8_t *data, size_t length);
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,474 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include <atomic>
+#include <lwip/dns.h>
+#include <lwip/tcpip.h>
+#include "ConnectionManager.h"
+
+// Last successful association and broker address. Survives software restarts, so a
+// warm boot can skip the scan and the broker lookup. Validated by magic and CRC because
+// RTC memory holds garbage after power-on.
+struct WifiCache {
+    uint32_t magic;
+    uint32_t configCrc;
+    uint8_t bssid[6];
+    int32_t channel;
+    uint32_t brokerIp;
+    uint32_t crc;
+};
+
+RTC_NOINIT_ATTR WifiCache wifiCache;
+
+namespace FujitsuAC {
+    static constexpr uint32_t wifiCacheMagic = 0x57434348;
+
+    static uint32_t wifiCacheConfigCrc(Config &config) {
+        // cache belongs to the network and broker it was made for
+        uint32_t crc = esp_rom_crc32_le(0, (const uint8_t*) config.getWifiSsid(), strlen(config.getWifiSsid()));
+
+        return esp_rom_crc32_le(crc, (const uint8_t*) config.getMqttIp(), strlen(config.getMqttIp()));
+    }
+
+    static uint32_t wifiCacheCrc() {
+        return esp_rom_crc32_le(0, (const uint8_t*) &wifiCache, offsetof(WifiCache, crc));
+    }
+
+    static bool isWifiCacheValid(Config &config) {
+        return wifiCacheMagic == wifiCache.magic
+            && wifiCacheCrc() == wifiCache.crc
+            && wifiCacheConfigCrc(config) == wifiCache.configCrc
+        ;
+    }
+
+    static void invalidateWifiCache() {
+        wifiCache.magic = 0;
+    }
+
+    enum class BrokerLookupState : uint8_t {
+        IDLE,
+        PENDING,
+        FOUND,
+        FAILED
+    };
+
+    // Broker name lookup. Runs on the lwIP thread so the loop never waits for DNS,
+    // the state machine polls the state. lwIP gives up on its own after its retries.
+    static std::atomic<BrokerLookupState> brokerLookupState(BrokerLookupState::IDLE);
+    static char brokerLookupHost[254];
+    static uint32_t brokerLookupIp = 0;
+
+    static void onBrokerFound(const char *name, const ip_addr_t *address, void *arg) {
+        if (nullptr == address || !IP_IS_V4(address)) {
+            brokerLookupState = BrokerLookupState::FAILED;
+
+            return;
+        }
+
+        brokerLookupIp = ip_addr_get_ip4_u32(address);
+        brokerLookupState = BrokerLookupState::FOUND;
+    }
+
+    static void startBrokerLookup(void *arg) {
+        ip_addr_t address;
+        err_t result = dns_gethostbyname(brokerLookupHost, &address, onBrokerFound, nullptr);
+
+        if (ERR_OK == result) {
+            // cached by lwIP, the callback is not called
+            onBrokerFound(brokerLookupHost, &address, nullptr);
+        } else if (ERR_INPROGRESS != result) {
+            brokerLookupState = BrokerLookupState::FAILED;
+        }
+    }
+
+	ConnectionManager::ConnectionManager(Config &config, IMqttTransport &mqttClient):
+		_config(config),
+		_mqttClient(mqttClient)
+	{}
+
+	void ConnectionManager::begin() {
+		WiFi.disconnect(true, true);
+		WiFi.setHostname(_config.getDeviceName());
+		WiFi.mode(WIFI_STA);
+		WiFi.setAutoReconnect(true);
+
+		_config.setWifiSleepEnabled(_config.isWifiSleepEnabled());
+
+		_mqttClient.setServer(_config.getMqttIp(), (uint16_t) atoi(_config.getMqttPort()));
+
+		_outageStartedMillis = millis();
+		_isStaticIp = this->applyStaticIp();
+
+		if (!this->beginCachedWifi()) {
+			this->startScan();
+		}
+	}
+
+	void ConnectionManager::loop() {
+		uint32_t now = millis();
+
+		switch (_state) {
+			case ConnectionState::WIFI_SCANNING: {
+				int16_t networkCount = WiFi.scanComplete();
+
+				if (WIFI_SCAN_RUNNING != networkCount) {
+					this->beginWifi(networkCount);
+				}
+
+				break;
+			}
+
+			case ConnectionState::WIFI_CONNECTING:
+				if (WL_CONNECTED == WiFi.status()) {
+					this->onWifiConnected();
+
+					break;
+				}
+
+				if (_isFastConnect && (now - _attemptStartedMillis) >= fastConnectTimeoutMillis) {
+					// cached access point is not valid anymore, fall back to a full scan
+					_isFastConnect = false;
+					invalidateWifiCache();
+
+					WiFi.disconnect();
+					this->startScan();
+
+					break;
+				}
+
+				if ((now - _attemptStartedMillis) >= wifiAttemptTimeoutMillis) {
+					this->scheduleRetry(ConnectionState::WIFI_WAITING_RETRY);
+				}
+
+				break;
+
+			case ConnectionState::WIFI_WAITING_RETRY:
+				if ((now - _attemptStartedMillis) >= _retryDelayMillis) {
+					this->startScan();
+				}
+
+				break;
+
+			case ConnectionState::MQTT_CONNECTING:
+				if (WL_CONNECTED != WiFi.status()) {
+					this->onWifiLost();
+
+					break;
+				}
+
+				if (_mqttClient.connected()) {
+					// asynchronous backend connected on its own
+					this->onMqttConnected();
+
+					break;
+				}
+
+				if ((now - _attemptStartedMillis) < _retryDelayMillis) {
+					break;
+				}
+
+				switch (this->resolveBroker()) {
+					case BrokerResolution::PENDING:
+						// lookup is still running, checked again on the next loop
+						break;
+
+					case BrokerResolution::FAILED:
+						this->scheduleRetry(ConnectionState::MQTT_CONNECTING);
+
+						break;
+
+					case BrokerResolution::RESOLVED:
+						if (this->connectMqtt()) {
+							this->onMqttConnected();
+						} else {
+							this->scheduleRetry(ConnectionState::MQTT_CONNECTING);
+						}
+
+						break;
+				}
+
+				break;
+
+			case ConnectionState::CONNECTED:
+				if (WL_CONNECTED != WiFi.status()) {
+					this->onWifiLost();
+				} else if (!_mqttClient.connected()) {
+					_state = ConnectionState::MQTT_CONNECTING;
+					_outageStartedMillis = now;
+					_attemptStartedMillis = now;
+					_retryDelayMillis = 0;
+				}
+
+				break;
+		}
+
+		this->updateLeds();
+		this->checkTimeout();
+	}
+
+	bool ConnectionManager::isWifiConnected() {
+		return ConnectionState::MQTT_CONNECTING == _state || ConnectionState::CONNECTED == _state;
+	}
+
+	bool ConnectionManager::isMqttConnected() {
+		return ConnectionState::CONNECTED == _state;
+	}
+
+	bool ConnectionManager::applyStaticIp() {
+		IPAddress ip;
+		IPAddress gateway;
+		IPAddress subnet(255, 255, 255, 0);
+		IPAddress dns;
+
+		if (!ip.fromString(_config.getStaticIp()) || !gateway.fromString(_config.getGateway())) {
+			return false;
+		}
+
+		if ('\0' != _config.getSubnet()[0]) {
+			subnet.fromString(_config.getSubnet());
+		}
+
+		if (!dns.fromString(_config.getDns())) {
+			dns = gateway;
+		}
+
+		return WiFi.config(ip, gateway, subnet, dns);
+	}
+
+	bool ConnectionManager::beginCachedWifi() {
+		if (!isWifiCacheValid(_config)) {
+			return false;
+		}
+
+		if (0 != wifiCache.brokerIp) {
+			_mqttClient.setServer(IPAddress(wifiCache.brokerIp), (uint16_t) atoi(_config.getMqttPort()));
+			_isBrokerResolved = true;
+			_brokerResolvedMillis = millis();
+		}
+
+		WiFi.begin(_config.getWifiSsid(), _config.getWifiPw(), wifiCache.channel, wifiCache.bssid, true);
+
+		_isFastConnect = true;
+		_state = ConnectionState::WIFI_CONNECTING;
+		_attemptStartedMillis = millis();
+
+		return true;
+	}
+
+	void ConnectionManager::onWifiConnected() {
+		uint32_t now = millis();
+
+		_isFastConnect = false;
+		_state = ConnectionState::MQTT_CONNECTING;
+		_outageStartedMillis = now;
+		_attemptStartedMillis = now;
+		_retryDelayMillis = 0;
+
+		const uint8_t *bssid = WiFi.BSSID();
+
+		if (nullptr == bssid) {
+			return;
+		}
+
+		wifiCache.magic = wifiCacheMagic;
+		wifiCache.configCrc = wifiCacheConfigCrc(_config);
+		memcpy(wifiCache.bssid, bssid, sizeof(wifiCache.bssid));
+		wifiCache.channel = WiFi.channel();
+		wifiCache.crc = wifiCacheCrc();
+	}
+
+	BrokerResolution ConnectionManager::resolveBroker() {
+		uint32_t now = millis();
+
+		if (_isBrokerResolved && (now - _brokerResolvedMillis) < brokerResolveIntervalMillis) {
+			return BrokerResolution::RESOLVED;
+		}
+
+		IPAddress brokerIp;
+
+		if (!brokerIp.fromString(_config.getMqttIp())) {
+			switch (brokerLookupState.load()) {
+				case BrokerLookupState::IDLE:
+					strncpy(brokerLookupHost, _config.getMqttIp(), sizeof(brokerLookupHost) - 1);
+					brokerLookupState = BrokerLookupState::PENDING;
+
+					if (ERR_OK == tcpip_callback(startBrokerLookup, nullptr)) {
+						return BrokerResolution::PENDING;
+					}
+
+					brokerLookupState = BrokerLookupState::IDLE;
+
+					break;
+
+				case BrokerLookupState::PENDING:
+					return BrokerResolution::PENDING;
+
+				case BrokerLookupState::FOUND:
+					brokerLookupState = BrokerLookupState::IDLE;
+					brokerIp = IPAddress(brokerLookupIp);
+
+					break;
+
+				case BrokerLookupState::FAILED:
+					brokerLookupState = BrokerLookupState::IDLE;
+
+					break;
+			}
+		}
+
+		if (IPAddress() == brokerIp) {
+			if (_isBrokerResolved) {
+				// DNS is down, the last address is tried until the next interval
+				_brokerResolvedMillis = now;
+
+				return BrokerResolution::RESOLVED;
+			}
+
+			return BrokerResolution::FAILED;
+		}
+
+		_mqttClient.setServer(brokerIp, (uint16_t) atoi(_config.getMqttPort()));
+		_isBrokerResolved = true;
+		_brokerResolvedMillis = now;
+
+		if (wifiCacheMagic == wifiCache.magic) {
+			wifiCache.brokerIp = brokerIp;
+			wifiCache.crc = wifiCacheCrc();
+		}
+
+		return BrokerResolution::RESOLVED;
+	}
+
+	void ConnectionManager::startScan() {
+		_state = ConnectionState::WIFI_SCANNING;
+
+		WiFi.scanDelete();
+		WiFi.scanNetworks(true);
+	}
+
+	void ConnectionManager::beginWifi(int16_t networkCount) {
+		int bestNetwork = -1;
+		int bestRSSI = -1000;
+
+		for (int i = 0; i < networkCount; i++) {
+			int rssi = WiFi.RSSI(i);
+
+			if (
+				WiFi.SSID(i) == _config.getWifiSsid()
+				&& rssi > bestRSSI
+			) {
+				bestRSSI = rssi;
+				bestNetwork = i;
+			}
+		}
+
+		if (-1 != bestNetwork) {
+			uint8_t* bestBssid = WiFi.BSSID(bestNetwork);
+			int channel = WiFi.channel(bestNetwork);
+
+			WiFi.begin(_config.getWifiSsid(), _config.getWifiPw(), channel, bestBssid, true);
+		} else {
+			// hidden SSID or scan failed
+			WiFi.begin(_config.getWifiSsid(), _config.getWifiPw());
+		}
+
+		WiFi.scanDelete();
+
+		_state = ConnectionState::WIFI_CONNECTING;
+		_attemptStartedMillis = millis();
+	}
+
+	void ConnectionManager::scheduleRetry(ConnectionState state) {
+		_state = state;
+		_attemptStartedMillis = millis();
+
+		_retryDelayMillis = 0 == _retryDelayMillis
+			? minRetryDelayMillis
+			: std::min(_retryDelayMillis * 2, maxRetryDelayMillis)
+		;
+	}
+
+	bool ConnectionManager::connectMqtt() {
+		char topic[64];
+		snprintf(topic, sizeof(topic), "fujitsu/%s/status", _config.getUniqueId());
+
+		_config.toggleWLed(false);
+
+		bool connected = _mqttClient.connect(
+			_config.getDeviceName(),
+			'\0' == _config.getMqttUser()[0] ? nullptr : _config.getMqttUser(),
+			_config.getMqttPw(),
+			topic,
+			"offline"
+		);
+
+		_config.toggleWLed(true);
+
+		return connected;
+	}
+
+	void ConnectionManager::onMqttConnected() {
+		_state = ConnectionState::CONNECTED;
+		_retryDelayMillis = 0;
+
+		if (_hasConnected) {
+			_reconnectCount++;
+			_lastOutageMillis = millis() - _outageStartedMillis;
+		}
+
+		_hasConnected = true;
+
+		if (this->onMqttConnectedCallback) {
+			this->onMqttConnectedCallback();
+		}
+	}
+
+	void ConnectionManager::onWifiLost() {
+		// the WiFi driver reconnects on its own, a new scan is started only when that attempt times out
+		_state = ConnectionState::WIFI_CONNECTING;
+		_outageStartedMillis = millis();
+		_attemptStartedMillis = _outageStartedMillis;
+		_retryDelayMillis = 0;
+	}
+
+	void ConnectionManager::checkTimeout() {
+		if (ConnectionState::CONNECTED == _state || _hasConnected) {
+			return;
+		}
+
+		if ((millis() - _outageStartedMillis) < outageTimeoutMillis) {
+			return;
+		}
+
+		// restart the window so the callback is not repeated on every loop
+		_outageStartedMillis = millis();
+
+		if (this->onTimeoutCallback) {
+			this->onTimeoutCallback(
+				ConnectionState::MQTT_CONNECTING == _state
+					? ConnectionTimeout::MQTT
+					: ConnectionTimeout::WIFI
+			);
+		}
+	}
+
+	void ConnectionManager::updateLeds() {
+		if (ConnectionState::CONNECTED == _state) {
+			// leds are owned by the bridge and the "leds" setting now
+			return;
+		}
+
+		if (this->isWifiConnected()) {
+			// show that Wifi is still connected
+			_config.toggleRLed(true);
+
+			return;
+		}
+
+		_config.toggleRLed(0 == (millis() / 500) % 2);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <WiFi.h>
+#include "IMqttTransport.h"
+#include "Config.h"
+
+namespace FujitsuAC {
+	enum class ConnectionState {
+	    WIFI_SCANNING,
+	    WIFI_CONNECTING,
+	    WIFI_WAITING_RETRY,
+	    MQTT_CONNECTING,
+	    CONNECTED
+	};
+
+	enum class ConnectionTimeout {
+	    WIFI,
+	    MQTT
+	};
+
+	enum class BrokerResolution {
+	    RESOLVED,
+	    PENDING,
+	    FAILED
+	};
+
+	// Non-blocking WiFi and MQTT connection state machine. The broker name is resolved
+	// off the loop thread. Only the MQTT connect itself can block, and only with the
+	// PUBSUB backend: see PubSubTransport for the bound.
+
+    class ConnectionManager {
+    	public:
+    		ConnectionManager(Config &config, IMqttTransport &mqttClient);
+
+    		void begin();
+            void loop();
+
+            bool isWifiConnected();
+            bool isMqttConnected();
+
+            ConnectionState getState() { return _state; }
+            uint32_t getReconnectCount() { return _reconnectCount; }
+            uint32_t getLastOutageMillis() { return _lastOutageMillis; }
+
+	        void setOnMqttConnectedCallback(std::function<void()> onMqttConnectedCallback) {
+	        	this->onMqttConnectedCallback = onMqttConnectedCallback;
+	        }
+
+	        void setOnTimeoutCallback(std::function<void(ConnectionTimeout timeout)> onTimeoutCallback) {
+	        	this->onTimeoutCallback = onTimeoutCallback;
+	        }
+
+        private:
+        	static constexpr uint32_t outageTimeoutMillis = 60000;
+        	static constexpr uint32_t wifiAttemptTimeoutMillis = 15000;
+        	static constexpr uint32_t fastConnectTimeoutMillis = 5000;
+        	static constexpr uint32_t minRetryDelayMillis = 1000;
+        	static constexpr uint32_t maxRetryDelayMillis = 30000;
+        	// the broker name is resolved again after this long, connect failures keep the address
+        	static constexpr uint32_t brokerResolveIntervalMillis = 600000;
+
+        	Config &_config;
+        	IMqttTransport &_mqttClient;
+
+        	ConnectionState _state = ConnectionState::WIFI_SCANNING;
+
+        	bool _isFastConnect = false;
+        	bool _isStaticIp = false;
+        	bool _isBrokerResolved = false;
+        	// once online, outages are recovered in place and never fall back to the AP
+        	bool _hasConnected = false;
+
+        	uint32_t _reconnectCount = 0;
+        	uint32_t _lastOutageMillis = 0;
+
+        	// start of the current outage, used for the AP fallback timeout
+        	uint32_t _outageStartedMillis = 0;
+        	uint32_t _attemptStartedMillis = 0;
+        	uint32_t _retryDelayMillis = 0;
+        	uint32_t _brokerResolvedMillis = 0;
+
+        	std::function<void()> onMqttConnectedCallback;
+        	std::function<void(ConnectionTimeout timeout)> onTimeoutCallback;
+
+        	bool applyStaticIp();
+        	bool beginCachedWifi();
+        	void onWifiConnected();
+        	BrokerResolution resolveBroker();
+        	void startScan();
+        	void beginWifi(int16_t networkCount);
+        	void scheduleRetry(ConnectionState state);
+        	bool connectMqtt();
+        	void onMqttConnected();
+        	void onWifiLost();
+        	void checkTimeout();
+        	void updateLeds();
+    };
+}
\ No newline at end of file
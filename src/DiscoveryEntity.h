@@ -0,0 +1,32 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+namespace FujitsuAC {
+
+    enum class DiscoveryMode {
+        // one retained config per entity, works with every HomeAssistant version
+        ENTITY,
+        // one retained config with all entities of the device, HomeAssistant 2024.11+
+        DEVICE
+    };
+
+    // Static part of a HomeAssistant entity config. Name, unique id and topics are
+    // added by the bridge, availability and device depend on the DiscoveryMode
+    struct DiscoveryEntity {
+        const char *platform;
+        const char *name;
+        // extra JSON members, without a trailing comma
+        const char *fields;
+        bool hasState;
+        bool hasCommand;
+        // unique id suffix when it differs from the name
+        const char *uniqueId = nullptr;
+    };
+
+}
\ No newline at end of file
@@ -1,403 +1,268 @@
-// /*
-//   FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
-//   Copyright (c) 2025 Benas Ragauskas. All rights reserved.
-  
-//   Project home: https://github.com/Benas09/FujitsuAC
-// */
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include "DummyUnit.h"
+
+namespace FujitsuAC {
+
+    DummyUnit::DummyUnit(Stream &uart, Clock &clock):
+        _uart(uart),
+        _clock(clock),
+        _buffer(uart, clock),
+        _registryTable(sizeof(_registers) / sizeof(_registers[0]), _registers)
+    {}
+
+    void DummyUnit::setup() {
+        // values read from a unit with every feature, each DummyUnit gets its own copy
+        static const RegistryTable::Register defaults[] = {
+            {Address::Initial0, 0x0000},
+            {Address::Initial1, 0x0000},
+
+            {Address::Initial2, 0x0001},
+            {Address::Initial3, 0x0001},
+            {Address::Initial4, 0x0001},
+            {Address::Initial5, 0x0001},
+            {Address::Initial6, 0x0001},
+            {Address::Initial7, 0x0001},
+            {Address::Initial8, 0x0001},
+            {Address::Initial9, 0x0001},
+            {Address::Initial10, 0x0001},
+            {Address::Initial11, 0x0001},
+            {Address::VerticalAirflowDirectionCount, 0x0006},
+            {Address::VerticalSwingSupported, 0x0001},
+            {Address::HorizontalAirflowDirectionCount, 0x0015},
+            {Address::HorizontalSwingSupported, 0x0001},
+
+            {Address::EconomyModeSupported, 0x0001},
+            {Address::MinimumHeatSupported, 0x0001},
+            {Address::HumanSensorSupported, 0x0001},
+            {Address::EnergySavingFanSupported, 0x0001},
+            {Address::Initial20, 0x0000}, // unknown
+            {Address::Initial21, 0x0000}, // unknown
+            {Address::Initial22, 0x0000}, // unknown
+            {Address::PowerfulSupported, 0x0001},
+            {Address::OutdoorUnitLowNoiseSupported, 0x0001},
+            {Address::CoilDrySupported, 0x0001},
+
+            {Address::Power, 0x0001},
+            {Address::Mode, 0x0001},
+            {Address::SetpointTemp, 0x00FA},
+            {Address::FanSpeed, 0x0002},
+            {Address::VerticalAirflowSetterRegistry, 0x0001},
+            {Address::VerticalSwing, 0x0000},
+            {Address::VerticalAirflow, 0x0001},
+            {Address::HorizontalAirflowSetterRegistry, 0xFFFF},
+            {Address::HorizontalSwing, 0xFFFF},
+            {Address::HorizontalAirflow, 0xFFFF},
+            {Address::Register11, 0x0181}, // changes to 0
+            {Address::ActualTemp, 0x1B71},
+            {Address::Register13, 0x0000},
+
+            {Address::EconomyMode, 0x0000},
+            {Address::MinimumHeat, 0x0000},
+            {Address::HumanSensor, 0xFFFF},
+            {Address::Register17, 0xFFFF},
+            {Address::Register18, 0xFFFF},
+            {Address::Register19, 0xFFFF},
+            {Address::Register20, 0xFFFF},
+            {Address::Register21, 0xFFFF},
+            {Address::EnergySavingFan, 0x0001},
+            {Address::Register23, 0x0000},
+            {Address::Powerful, 0x0000},
+            {Address::OutdoorUnitLowNoise, 0x0000},
+            {Address::CoilDry, 0xFFFF},
+            {Address::Register27, 0x0000},
+            {Address::Register28, 0x0000},
+            {Address::Register29, 0x0000},
+            {Address::Register30, 0x0000},
+            {Address::Register31, 0x0000},
+            {Address::Register32, 0xFFFF},
+
+            {Address::Register33, 0x0000},
+            {Address::Register34, 0x0000},
+            {Address::Register35, 0x0000},
+            {Address::Register36, 0x0000},
+            {Address::Register37, 0x0000},
+            {Address::Register38, 0x0000},
+            {Address::Register39, 0x0000},
+            {Address::Register40, 0x0000},
+            {Address::Register41, 0xFFFF},
+            {Address::OutdoorTemp, 0x1964},
+            {Address::Register43, 0x0000},
+            {Address::Register44, 0x0000 }
+        };
+
+        static_assert(sizeof(defaults) == sizeof(_registers), "Register count mismatch");
+
+        // setup() may be called again, it resets the unit to its defaults
+        memcpy(_registers, defaults, sizeof(_registers));
+        _registryTable = RegistryTable(sizeof(_registers) / sizeof(_registers[0]), _registers);
+    }
+
+    void DummyUnit::loop() {
+        _buffer.loop([this](uint8_t buffer[128], int size, bool isValid) {
+            this->onFrame(buffer, size, isValid);
+        });
+
+        if (_responseSize > 0 && (_clock.millis() - _requestMillis) >= _faults.responseDelayMillis) {
+            this->sendResponse();
+        }
+    }
+
+    RegistryTable::Register* DummyUnit::getRegister(uint16_t address) {
+        return _registryTable.getRegister(address);
+    }
+
+    void DummyUnit::onFrame(uint8_t buffer[128], int size, bool isValid) {
+        _metrics.received++;
+
+        if (!isValid) {
+            // the unit does not answer garbage, the dongle runs into its timeout
+            return;
+        }
+
+        _requestMillis = _clock.millis();
+
+        if (this->chance(_faults.dropPercent)) {
+            _metrics.dropped++;
+            _responseSize = 0;
+
+            return;
+        }
+
+        bool isInvalidStatus = this->chance(_faults.invalidStatusPercent);
+        uint8_t status = isInvalidStatus ? 0x00 : 0x01;
+
+        switch (buffer[0]) {
+            case 0x00:
+            case 0x01:
+                this->prepareResponse(buffer[0], &status, 1);
+
+                break;
+
+            case 0x02:
+                if (!isInvalidStatus) {
+                    this->setRegistryValues(buffer, size);
+                    _metrics.written++;
+                }
+
+                this->prepareResponse(0x02, &status, 1);
+
+                break;
+
+            case 0x03:
+                if (isInvalidStatus) {
+                    this->prepareResponse(0x03, &status, 1);
+                } else {
+                    this->sendRegistryValues(buffer, size);
+                }
+
+                break;
+
+            default:
+                _responseSize = 0;
+
+                return;
+        }
+
+        if (isInvalidStatus) {
+            _metrics.invalidStatus++;
+        }
+    }
+
+    void DummyUnit::setRegistryValues(uint8_t buffer[128], int size) {
+        // length byte is not trusted beyond the received frame and the buffer
+        int registriesCount = std::min(buffer[4] / 4, (size - 7) / 4);
 
-// #include "DummyUnit.h"
-// #include <Arduino.h>
+        for (int i = 0; i < registriesCount; i++) {
+            int index = 5 + i * 4;
 
-// namespace FujitsuAC {
+            uint16_t address = (static_cast<uint16_t>(buffer[index]) << 8) | buffer[index + 1];
+            uint16_t value = (static_cast<uint16_t>(buffer[index + 2]) << 8) | buffer[index + 3];
 
-//     DummyUnit::DummyUnit(Stream &uart)
-//         : uart(uart),
-//           registryTable(),
-//           buffer(uart)
-//     {}
+            RegistryTable::Register *reg = _registryTable.getRegister(address);
 
-//     bool DummyUnit::setup() {
-//         this->createDefaultRegistryValues();
-        
-//         Serial.println("DummyUnit setup done");
+            if (nullptr == reg) {
+                continue;
+            }
 
-//         return true;
-//     }
+            reg->value = value;
 
-//     bool DummyUnit::loop() {
-//         this->buffer.loop([this](uint8_t buffer[128], int size, bool isValid) {
-//             this->onFrame(buffer, size, isValid);
-//         });
+            // airflow is written to a setter register and read back from another one
+            if (Address::VerticalAirflowSetterRegistry == address) {
+                _registryTable.getRegister(Address::VerticalAirflow)->value = value;
+            } else if (Address::HorizontalAirflowSetterRegistry == address) {
+                _registryTable.getRegister(Address::HorizontalAirflow)->value = value;
+            }
+        }
+    }
 
-//         return true;
-//     }
+    void DummyUnit::sendRegistryValues(uint8_t buffer[128], int size) {
+        int registriesCount = std::min({buffer[4] / 2, (size - 7) / 2, 30});
 
-//     void DummyUnit::onFrame(uint8_t buffer[128], int size, bool isValid) {
-//         switch (buffer[0]) {
-//             case 0x00: {
-//                 Serial.println("Controller initialized connection");
+        uint8_t payload[1 + 4 * 30] = {0x01};
 
-//                 uint8_t response[8] = {0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0xFF, 0xFD};
-//                 uart.write(response, 8);
-//                 break;
-//             }
-                
-//             case 0x01: {
-//                 uint8_t response[8] = {0x01, 0x00, 0x00, 0x00, 0x01, 0x01, 0xFF, 0xFC};
+        for (int i = 0; i < registriesCount; i++) {
+            uint8_t addrHigh = buffer[5 + i * 2];
+            uint8_t addrLow = buffer[5 + i * 2 + 1];
 
-//                 Serial.println("Controller connected");
+            RegistryTable::Register *reg = _registryTable.getRegister((static_cast<uint16_t>(addrHigh) << 8) | addrLow);
+            uint16_t value = nullptr == reg ? 0xFFFF : reg->value;
 
-//                 uart.write(response, 8);
-//                 break;
-//             }
+            int index = 1 + i * 4;
 
-//             case 0x02: 
-//                 this->setRegistryValues(buffer, size);
-//                 break;
+            payload[index] = addrHigh;
+            payload[index + 1] = addrLow;
+            payload[index + 2] = (value >> 8) & 0xFF;
+            payload[index + 3] = value & 0xFF;
+        }
 
-//             case 0x03:
-//                 this->sendRegistryValues(buffer, size);
+        this->prepareResponse(0x03, payload, 1 + 4 * registriesCount);
+    }
 
-//                 break;
-//         }
-//     }
+    void DummyUnit::prepareResponse(uint8_t type, const uint8_t *payload, size_t size) {
+        _response[0] = type;
+        _response[1] = 0x00;
+        _response[2] = 0x00;
+        _response[3] = 0x00;
+        _response[4] = size;
 
-//     bool DummyUnit::setRegistryValues(uint8_t buffer[128], int size) {
-//         String hexStr = String("");
+        memcpy(_response + 5, payload, size);
 
-//         for (int i = 0; i < size; i++) {
-//             hexStr += String(buffer[i], HEX);
-
-//             if (i < size - 1) {hexStr += " ";}
-//         }
-
-//         hexStr.toUpperCase();
-
-//         Serial.println(hexStr);
-
-//         int registriesCount = buffer[4] / 4;
-
-//         for (int i = 0; i < registriesCount; i++) {
-//             int index = 5 + i * 4;
-
-//             uint8_t addrHigh = buffer[index];
-//             uint8_t addrLow = buffer[index + 1];
-
-//             uint8_t valueHigh = buffer[index + 2];
-//             uint8_t valueLow = buffer[index + 3];
-
-//             uint16_t newValue = (static_cast<uint16_t>(valueHigh) << 8) | valueLow;
-
-//             Address address = static_cast<Address>((static_cast<uint16_t>(addrHigh) << 8) | addrLow);
-//             Register* reg = this->registryTable.getRegister(address);
-//             reg->value = newValue;
-//         }
-
-//         uint8_t response[8] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x01, 0xFF, 0xFB};
-//         uart.write(response, 8);
-
-//         return true;
-//     }
-
-//     bool DummyUnit::sendRegistryValues(uint8_t buffer[128], int size) {
-//         int registriesCount = buffer[4] / 2;
-//         int responseSize = 4 * registriesCount + 8;
-
-//         uint8_t response[128] = {
-//             0x03, 
-//             0x00, 
-//             0x00, 
-//             0x00, 
-//             4 * registriesCount + 1, 
-//             0x01
-//         };
-
-//         uint16_t checksum = 
-//             0xFFFF 
-//             - 0x03
-//             - (4 * registriesCount + 1)
-//             - 0x01
-//         ;
-
-//         for (int i = 0; i < registriesCount; i++) {
-//             uint8_t addrHigh = buffer[5 + i * 2];
-//             uint8_t addrLow = buffer[5 + i * 2 + 1];
-
-//             Address address = static_cast<Address>((static_cast<uint16_t>(addrHigh) << 8) | addrLow);
-//             Register* reg = this->registryTable.getRegister(address);
-
-//             int index = 6 + i * 4;
-
-//             response[index] = addrHigh;
-//             response[index + 1] = addrLow;
-//             response[index + 2] = (reg->value >> 8) & 0xFF;
-//             response[index + 3] = reg->value & 0xFF;
-
-//             checksum -= response[index];
-//             checksum -= response[index + 1];
-//             checksum -= response[index + 2];
-//             checksum -= response[index + 3];
-//         }
-
-//         response[responseSize - 2] = (checksum >> 8) & 0xFF;
-//         response[responseSize - 1] = checksum & 0xFF;
-
-//         uart.write(response, responseSize);
-
-//         return true;
-//     }
-
-//     void DummyUnit::createDefaultRegistryValues() {
-//         struct RegVal {
-//             Address address;
-//             uint16_t value;
-//         };
-
-//         // static constexpr RegVal defaults[] = {
-//         //     { Address::Initial0, 0x0000 },
-//         //     { Address::Initial1, 0x0000 },
-
-//         //     { Address::Initial2, 0x0001 },
-//         //     { Address::Initial3, 0x0001 },
-//         //     { Address::Initial4, 0x0001 },
-//         //     { Address::Initial5, 0x0001 },
-//         //     { Address::Initial6, 0x0001 },
-//         //     { Address::Initial7, 0x0001 },
-//         //     { Address::Initial8, 0x0001 },
-//         //     { Address::Initial9, 0x0001 },
-//         //     { Address::Initial10, 0x0001 },
-//         //     { Address::Initial11, 0x0001 },
-//         //     { Address::VerticalAirflowDirectionCount, 0x0006 },
-//         //     { Address::VerticalSwingSupported, 0x0001 },
-//         //     { Address::HorizontalAirflowDirectionCount, 0x0000 },
-//         //     { Address::HorizontalSwingSupported, 0x0000 },
-
-//         //     { Address::EconomyModeSupported, 0x0001 },
-//         //     { Address::MinimumHeatSupported, 0x0001 },
-//         //     { Address::HumanSensorSupported, 0x0000 },
-//         //     { Address::EnergySavingFanSupported, 0x0001 },
-//         //     { Address::Initial20, 0x0000 },
-//         //     { Address::Initial21, 0x0000 },
-//         //     { Address::Initial22, 0x0000 },
-//         //     { Address::PowerfulSupported, 0x0001 },
-//         //     { Address::OutdoorUnitLowNoiseSupported, 0x0001 },
-//         //     { Address::CoilDrySupported, 0x0000 },
-
-//         //     { Address::Power, 0x0001 },
-//         //     { Address::Mode, 0x0001 },
-//         //     { Address::SetpointTemp, 0x00FA },
-//         //     { Address::FanSpeed, 0x0002 },
-//         //     { Address::VerticalAirflow, 0x0001 },
-//         //     { Address::VerticalSwing, 0x0000 },
-//         //     { Address::Register7, 0x0001 },
-//         //     { Address::HorizontalAirflow, 0xFFFF },
-//         //     { Address::HorizontalSwing, 0xFFFF },
-//         //     { Address::Register10, 0xFFFF },
-//         //     { Address::Register11, 0x0181 },
-//         //     { Address::ActualTemp, 0x1B71 }, //0x1D97 25.5, is praeito batcho 0x1C6B -> 22.5, 0x1B71 -> 20.0
-//         //     { Address::Register13, 0x0000 },
-
-//         //     { Address::EconomyMode, 0x0000 },
-//         //     { Address::MinimumHeat, 0x0000 },
-//         //     { Address::HumanSensor, 0xFFFF },
-//         //     { Address::Register17, 0xFFFF },
-//         //     { Address::Register18, 0xFFFF },
-//         //     { Address::Register19, 0xFFFF },
-//         //     { Address::Register20, 0xFFFF },
-//         //     { Address::Register21, 0xFFFF },
-//         //     { Address::EnergySavingFan, 0x0001 },
-//         //     { Address::Register23, 0x0000 },
-//         //     { Address::Powerful, 0x0000 },
-//         //     { Address::OutdoorUnitLowNoise, 0x0000 },
-//         //     { Address::CoilDry, 0xFFFF },
-//         //     { Address::Register27, 0x0000 },
-//         //     { Address::Register28, 0x0000 },
-//         //     { Address::Register29, 0x0000 },
-//         //     { Address::Register30, 0x0000 },
-//         //     { Address::Register31, 0x0000 },
-//         //     { Address::Register32, 0xFFFF },
-
-//         //     { Address::Register33, 0x0000 },
-//         //     { Address::Register34, 0x0000 },
-//         //     { Address::Register35, 0x0000 },
-//         //     { Address::Register36, 0x0000 },
-//         //     { Address::Register37, 0x0000 },
-//         //     { Address::Register38, 0x0000 },
-//         //     { Address::Register39, 0x0000 },
-//         //     { Address::Register40, 0x0000 },
-//         //     { Address::Register41, 0xFFFF },
-//         //     { Address::OutdoorTemp, 0x1964 },
-//         //     { Address::Register43, 0x0000 },
-//         //     { Address::Register44, 0x0000 }
-//         // };
-
-//         // static constexpr RegVal defaults[] = {
-//         //     { Address::Initial0, 0x0000 },
-//         //     { Address::Initial1, 0x0000 },
-
-//         //     { Address::Initial2, 0x0001 },
-//         //     { Address::Initial3, 0x0001 },
-//         //     { Address::Initial4, 0x0001 },
-//         //     { Address::Initial5, 0x0001 },
-//         //     { Address::Initial6, 0x0001 },
-//         //     { Address::Initial7, 0x0001 },
-//         //     { Address::Initial8, 0x0001 },
-//         //     { Address::Initial9, 0x0001 },
-//         //     { Address::Initial10, 0x0001 },
-//         //     { Address::Initial11, 0x0001 },
-//         //     { Address::VerticalAirflowDirectionCount, 0x0006 },
-//         //     { Address::VerticalSwingSupported, 0x0001 },
-//         //     { Address::HorizontalAirflowDirectionCount, 0x0000 }, //0 nera horizontal, 15 yra 5 horizontal
-//         //     { Address::HorizontalSwingSupported, 0x0000 },
-
-//         //     { Address::EconomyModeSupported, 0x0001 },
-//         //     { Address::MinimumHeatSupported, 0x0001 },
-//         //     { Address::HumanSensorSupported, 0x0000 },
-//         //     { Address::EnergySavingFanSupported, 0x0001 },
-//         //     { Address::Initial20, 0x0000 },
-//         //     { Address::Initial21, 0x0000 },
-//         //     { Address::Initial22, 0x0000 },
-//         //     { Address::PowerfulSupported, 0x0001 },
-//         //     { Address::OutdoorUnitLowNoiseSupported, 0x0001 },
-//         //     { Address::CoilDrySupported, 0x0000 },
-
-//         //     { Address::Power, 0x0001 },
-//         //     { Address::Mode, 0x0001 },
-//         //     { Address::SetpointTemp, 0x00FA },
-//         //     { Address::FanSpeed, 0x0002 },
-//         //     { Address::VerticalAirflowSetterRegistry, 0x0001 },
-//         //     { Address::VerticalSwing, 0x0000 },
-//         //     { Address::VerticalAirflow, 0x0000 },
-//         //     { Address::HorizontalAirflowSetterRegistry, 0x0003 },
-//         //     { Address::HorizontalSwing, 0x0000 },
-//         //     { Address::HorizontalAirflow, 0xFFFF },
-//         //     { Address::Register11, 0x0181 },
-//         //     { Address::ActualTemp, 0x1B71 },
-//         //     { Address::Register13, 0x0000 },
-
-//         //     { Address::EconomyMode, 0x0000 },
-//         //     { Address::MinimumHeat, 0x0000 },
-//         //     { Address::HumanSensor, 0x0000 },
-//         //     { Address::Register17, 0x0014 },
-//         //     { Address::Register18, 0x0000 },
-//         //     { Address::Register19, 0x0000 },
-//         //     { Address::Register20, 0xFFFF },
-//         //     { Address::Register21, 0xFFFF },
-//         //     { Address::EnergySavingFan, 0x0001 },
-//         //     { Address::Register23, 0x0000 },
-//         //     { Address::Powerful, 0x0000 },
-//         //     { Address::OutdoorUnitLowNoise, 0x0000 },
-//         //     { Address::CoilDry, 0xFFFF },
-//         //     { Address::Register27, 0x0000 },
-//         //     { Address::Register28, 0x0000 },
-//         //     { Address::Register29, 0x0000 },
-//         //     { Address::Register30, 0x0000 },
-//         //     { Address::Register31, 0x0000 },
-//         //     { Address::Register32, 0xFFFF },
-
-//         //     { Address::Register33, 0x0000 },
-//         //     { Address::Register34, 0x0000 },
-//         //     { Address::Register35, 0x0000 },
-//         //     { Address::Register36, 0x0000 },
-//         //     { Address::Register37, 0x0000 },
-//         //     { Address::Register38, 0x0000 },
-//         //     { Address::Register39, 0x0000 },
-//         //     { Address::Register40, 0x0000 },
-//         //     { Address::Register41, 0xFFFF },
-//         //     { Address::OutdoorTemp, 0x15E0 },
-//         //     { Address::Register43, 0x0000 },
-//         //     { Address::Register44, 0x0000 }
-//         // };
-
-//         // 15:53:09.392 -> 2 0 0 0 4 11 44 0 1 FF A3 coil dry enable. 
-//         // kol ijungtas - negalima keisti economy, airflow direction, powerful, mode, temperaturos
-//         // 15:53:19.836 -> 2 0 0 0 4 11 44 0 0 FF A4 coil dry disable
-
-//         static constexpr RegVal defaults[] = {
-//             { Address::Initial0, 0x0000 },
-//             { Address::Initial1, 0x0000 },
-
-//             { Address::Initial2, 0x0001 },
-//             { Address::Initial3, 0x0001 },
-//             { Address::Initial4, 0x0001 },
-//             { Address::Initial5, 0x0001 },
-//             { Address::Initial6, 0x0001 },
-//             { Address::Initial7, 0x0001 },
-//             { Address::Initial8, 0x0001 },
-//             { Address::Initial9, 0x0001 },
-//             { Address::Initial10, 0x0001 },
-//             { Address::Initial11, 0x0001 },
-//             { Address::VerticalAirflowDirectionCount, 0x0006 },
-//             { Address::VerticalSwingSupported, 0x0001 },
-//             { Address::HorizontalAirflowDirectionCount, 0x0015 },
-//             { Address::HorizontalSwingSupported, 0x0001 },
-
-//             { Address::EconomyModeSupported, 0x0001 },
-//             { Address::MinimumHeatSupported, 0x0001 },
-//             { Address::HumanSensorSupported, 0x0001 },
-//             { Address::EnergySavingFanSupported, 0x0001 },
-//             { Address::Initial20, 0x0000 }, //neaiskus
-//             { Address::Initial21, 0x0000 }, //neaiskus
-//             { Address::Initial22, 0x0000 }, //neaiskus
-//             { Address::PowerfulSupported, 0x0001 },
-//             { Address::OutdoorUnitLowNoiseSupported, 0x0001 },
-//             { Address::CoilDrySupported, 0x0001 },
-
-//             { Address::Power, 0x0001 },
-//             { Address::Mode, 0x0001 },
-//             { Address::SetpointTemp, 0x00FA },
-//             { Address::FanSpeed, 0x0002 },
-//             { Address::VerticalAirflowSetterRegistry, 0x0001 },
-//             { Address::VerticalSwing, 0x0000 },
-//             { Address::VerticalAirflow, 0x0001 },
-//             { Address::HorizontalAirflowSetterRegistry, 0xFFFF },
-//             { Address::HorizontalSwing, 0xFFFF },
-//             { Address::HorizontalAirflow, 0xFFFF },
-//             { Address::Register11, 0x0181 }, //keiciasi i 0
-//             { Address::ActualTemp, 0x1B71 },
-//             { Address::Register13, 0x0000 },
-
-//             { Address::EconomyMode, 0x0000 },
-//             { Address::MinimumHeat, 0x0000 },
-//             { Address::HumanSensor, 0xFFFF },
-//             { Address::Register17, 0xFFFF },
-//             { Address::Register18, 0xFFFF },
-//             { Address::Register19, 0xFFFF },
-//             { Address::Register20, 0xFFFF },
-//             { Address::Register21, 0xFFFF },
-//             { Address::EnergySavingFan, 0x0001 },
-//             { Address::Register23, 0x0000 },
-//             { Address::Powerful, 0x0000 },
-//             { Address::OutdoorUnitLowNoise, 0x0000 },
-//             { Address::CoilDry, 0xFFFF },
-//             { Address::Register27, 0x0000 },
-//             { Address::Register28, 0x0000 },
-//             { Address::Register29, 0x0000 },
-//             { Address::Register30, 0x0000 },
-//             { Address::Register31, 0x0000 },
-//             { Address::Register32, 0xFFFF },
-
-//             { Address::Register33, 0x0000 },
-//             { Address::Register34, 0x0000 },
-//             { Address::Register35, 0x0000 },
-//             { Address::Register36, 0x0000 },
-//             { Address::Register37, 0x0000 },
-//             { Address::Register38, 0x0000 },
-//             { Address::Register39, 0x0000 },
-//             { Address::Register40, 0x0000 },
-//             { Address::Register41, 0xFFFF },
-//             { Address::OutdoorTemp, 0x1964 },
-//             { Address::Register43, 0x0000 },
-//             { Address::Register44, 0x0000 }
-//         };
-
-//         for (const auto& rv : defaults) {
-//             Register* reg = this->registryTable.getRegister(rv.address);
-
-//             if (reg) {
-//                 reg->value = rv.value;
-//             }
-//         }
-//     }
-
-// }
\ No newline at end of file
+        uint16_t checksum = Buffer::checksum(_response, 5 + size);
+
+        if (this->chance(_faults.corruptPercent)) {
+            checksum ^= 0x0001;
+            _metrics.corrupted++;
+        }
+
+        _response[5 + size] = (checksum >> 8) & 0xFF;
+        _response[6 + size] = checksum & 0xFF;
+        _responseSize = 7 + size;
+    }
+
+    void DummyUnit::sendResponse() {
+        _uart.write(_response, _responseSize);
+        _responseSize = 0;
+
+        _metrics.answered++;
+    }
+
+    bool DummyUnit::chance(uint8_t percent) {
+        if (0 == percent) {
+            return false;
+        }
+
+        // xorshift32
+        _random ^= _random << 13;
+        _random ^= _random >> 17;
+        _random ^= _random << 5;
+
+        return (_random % 100) < percent;
+    }
+
+}
\ No newline at end of file
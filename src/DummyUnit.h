@@ -1,35 +1,82 @@
-// /*
-//   FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
-//   Copyright (c) 2025 Benas Ragauskas. All rights reserved.
-  
-//   Project home: https://github.com/Benas09/FujitsuAC
-// */
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
 
-// #include "RegistryTable.h"
-// #include "Buffer.h"
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
 
-// #pragma once
+#pragma once
 
-// namespace FujitsuAC {
+#include <Arduino.h>
+#include "Buffer.h"
+#include "Clock.h"
+#include "RegistryTable.h"
+#include "TFSXW1Controller.h"
 
-//     class DummyUnit {
-//         public:
-//             DummyUnit(Stream &uart);
+namespace FujitsuAC {
 
-//             bool setup();
-//             bool loop();
+    // Indoor unit side of the TFSXW1 protocol: answers Init1/Init2 and register
+    // reads and writes from its own RegistryTable. Faults can be injected to test
+    // the dongle against a slow or unreliable unit.
+    class DummyUnit {
+        public:
+            struct Faults {
+                // time between the request and the answer
+                uint16_t responseDelayMillis = 20;
+                // chance of each fault in percent
+                uint8_t dropPercent = 0;
+                uint8_t corruptPercent = 0;
+                uint8_t invalidStatusPercent = 0;
+            };
 
-//         private:
-//             Stream &uart;
-//             RegistryTable registryTable;
-//             Buffer buffer;
+            struct Metrics {
+                uint32_t received;
+                uint32_t answered;
+                uint32_t dropped;
+                uint32_t corrupted;
+                uint32_t invalidStatus;
+                // register write frames applied to the registers
+                uint32_t written;
+            };
 
-//             void onFrame(uint8_t buffer[128], int size, bool isValid);
+            DummyUnit(Stream &uart, Clock &clock = Clock::system());
 
-//             bool setRegistryValues(uint8_t buffer[128], int size);
-//             bool sendRegistryValues(uint8_t buffer[128], int size);
+            void setup();
+            void loop();
 
-//             void createDefaultRegistryValues();
-//     };
+            void setFaults(const Faults &faults) { _faults = faults; }
+            // fault decisions are repeatable for the same seed
+            void setSeed(uint32_t seed) { _random = 0 == seed ? 1 : seed; }
 
-// }
\ No newline at end of file
+            RegistryTable::Register* getRegister(uint16_t address);
+            const Metrics& getMetrics() { return _metrics; }
+
+        private:
+            using Address = TFSXW1Controller::Address;
+
+            Stream &_uart;
+            Clock &_clock;
+            Buffer _buffer;
+
+            RegistryTable::Register _registers[70] = {};
+            // sorted view of _registers, rebuilt by setup()
+            RegistryTable _registryTable;
+
+            Faults _faults;
+            Metrics _metrics = {};
+            uint32_t _random = 1;
+
+            uint8_t _response[128];
+            size_t _responseSize = 0;
+            uint32_t _requestMillis = 0;
+
+            void onFrame(uint8_t buffer[128], int size, bool isValid);
+            void setRegistryValues(uint8_t buffer[128], int size);
+            void sendRegistryValues(uint8_t buffer[128], int size);
+
+            void prepareResponse(uint8_t type, const uint8_t *payload, size_t size);
+            void sendResponse();
+            bool chance(uint8_t percent);
+    };
+
+}
\ No newline at end of file
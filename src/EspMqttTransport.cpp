@@ -0,0 +1,228 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include "EspMqttTransport.h"
+
+namespace FujitsuAC {
+
+    EspMqttTransport::EspMqttTransport() {
+        _inbox = xQueueCreate(inboxLength, sizeof(InboundMessage));
+    }
+
+    EspMqttTransport::~EspMqttTransport() {
+        if (nullptr != _client) {
+            esp_mqtt_client_destroy(_client);
+        }
+
+        InboundMessage message;
+
+        while (pdTRUE == xQueueReceive(_inbox, &message, 0)) {
+            free(message.longPayload);
+        }
+
+        vQueueDelete(_inbox);
+    }
+
+    void EspMqttTransport::setServer(const char *host, uint16_t port) {
+        if (0 == strcmp(_host, host) && _port == port) {
+            return;
+        }
+
+        strlcpy(_host, host, sizeof(_host));
+        _port = port;
+        _isServerChanged = true;
+    }
+
+    void EspMqttTransport::setServer(IPAddress ip, uint16_t port) {
+        this->setServer(ip.toString().c_str(), port);
+    }
+
+    bool EspMqttTransport::connect(
+        const char *clientId,
+        const char *user,
+        const char *password,
+        const char *willTopic,
+        const char *willMessage
+    ) {
+        if (nullptr != _client) {
+            // the client reconnects on its own, only a moved broker needs a restart
+            if (_isServerChanged && !_isConnected) {
+                esp_mqtt_client_config_t config = {};
+                this->createConfig(config);
+
+                esp_mqtt_client_stop(_client);
+                esp_mqtt_set_config(_client, &config);
+                esp_mqtt_client_start(_client);
+
+                _isServerChanged = false;
+            }
+
+            return _isConnected;
+        }
+
+        strlcpy(_clientId, clientId, sizeof(_clientId));
+        strlcpy(_user, nullptr == user ? "" : user, sizeof(_user));
+        strlcpy(_password, nullptr == password ? "" : password, sizeof(_password));
+        strlcpy(_willTopic, willTopic, sizeof(_willTopic));
+        strlcpy(_willMessage, willMessage, sizeof(_willMessage));
+
+        esp_mqtt_client_config_t config = {};
+        this->createConfig(config);
+
+        _client = esp_mqtt_client_init(&config);
+
+        if (nullptr == _client) {
+            return false;
+        }
+
+        esp_mqtt_client_register_event(_client, MQTT_EVENT_ANY, EspMqttTransport::onEvent, this);
+        esp_mqtt_client_start(_client);
+
+        _isServerChanged = false;
+
+        return _isConnected;
+    }
+
+    bool EspMqttTransport::connected() {
+        return _isConnected;
+    }
+
+    void EspMqttTransport::loop() {
+        if (!this->callback) {
+            // keep commands queued until the bridge is attached
+            return;
+        }
+
+        InboundMessage message;
+
+        while (pdTRUE == xQueueReceive(_inbox, &message, 0)) {
+            char *payload = nullptr != message.longPayload ? message.longPayload : message.payload;
+
+            this->callback(message.topic, (uint8_t*) payload, message.length);
+            free(message.longPayload);
+        }
+    }
+
+    bool EspMqttTransport::publish(const char *topic, const char *payload, bool retained) {
+        if (!_isConnected) {
+            // state is retained and resent after reconnect, do not let the outbox grow meanwhile
+            return false;
+        }
+
+        if (strlen(topic) + strlen(payload) + 5 > bufferSize) {
+            // the outbox keeps one buffer per message, bigger ones (device discovery)
+            // are written in fragments from this task instead
+            return esp_mqtt_client_publish(_client, topic, payload, 0, 0, retained) >= 0;
+        }
+
+        return esp_mqtt_client_enqueue(_client, topic, payload, 0, 0, retained, true) >= 0;
+    }
+
+    bool EspMqttTransport::subscribe(const char *topic, uint8_t qos) {
+        if (!_isConnected) {
+            return false;
+        }
+
+        return esp_mqtt_client_subscribe_single(_client, topic, qos) >= 0;
+    }
+
+    void EspMqttTransport::createConfig(esp_mqtt_client_config_t &config) {
+        config.broker.address.hostname = _host;
+        config.broker.address.port = _port;
+        config.broker.address.transport = MQTT_TRANSPORT_OVER_TCP;
+
+        config.credentials.client_id = _clientId;
+
+        if ('\0' != _user[0]) {
+            config.credentials.username = _user;
+            config.credentials.authentication.password = _password;
+        }
+
+        config.session.last_will.topic = _willTopic;
+        config.session.last_will.msg = _willMessage;
+        config.session.last_will.qos = 1;
+        config.session.last_will.retain = 1;
+        // broker keeps the subscriptions and queues QoS1 commands while we are away
+        config.session.disable_clean_session = true;
+        config.session.keepalive = 30;
+
+        config.network.reconnect_timeout_ms = 1000;
+        config.network.timeout_ms = 5000;
+
+        config.buffer.size = bufferSize;
+    }
+
+    void EspMqttTransport::onEvent(void *handlerArgs, esp_event_base_t base, int32_t eventId, void *eventData) {
+        EspMqttTransport *transport = static_cast<EspMqttTransport*>(handlerArgs);
+        esp_mqtt_event_handle_t event = static_cast<esp_mqtt_event_handle_t>(eventData);
+
+        switch ((esp_mqtt_event_id_t) eventId) {
+            case MQTT_EVENT_CONNECTED:
+                transport->_isConnected = true;
+                break;
+
+            case MQTT_EVENT_DISCONNECTED:
+                transport->_isConnected = false;
+                break;
+
+            case MQTT_EVENT_DATA:
+                transport->onData(event);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    void EspMqttTransport::onData(esp_mqtt_event_handle_t event) {
+        if (0 != event->current_data_offset || event->data_len != event->total_data_len) {
+            // fragmented, larger than the receive buffer. Counted on the first fragment only
+            if (0 == event->current_data_offset) {
+                _oversizedCount = _oversizedCount + 1;
+            }
+
+            return;
+        }
+
+        InboundMessage message;
+
+        if (event->topic_len >= (int) sizeof(message.topic) || event->data_len >= (int) maxPayloadLength) {
+            _oversizedCount = _oversizedCount + 1;
+
+            return;
+        }
+
+        memcpy(message.topic, event->topic, event->topic_len);
+        message.topic[event->topic_len] = '\0';
+
+        char *payload = message.payload;
+        message.longPayload = nullptr;
+
+        if (event->data_len >= (int) sizeof(message.payload)) {
+            message.longPayload = (char*) malloc(event->data_len + 1);
+
+            if (nullptr == message.longPayload) {
+                _oversizedCount = _oversizedCount + 1;
+
+                return;
+            }
+
+            payload = message.longPayload;
+        }
+
+        memcpy(payload, event->data, event->data_len);
+        payload[event->data_len] = '\0';
+        message.length = event->data_len;
+
+        // runs in the esp-mqtt task, hand the message over to the loop task
+        if (pdTRUE != xQueueSend(_inbox, &message, 0)) {
+            _inboxFullCount = _inboxFullCount + 1;
+            free(message.longPayload);
+        }
+    }
+
+}
\ No newline at end of file
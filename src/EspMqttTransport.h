@@ -0,0 +1,85 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "mqtt_client.h"
+#include "IMqttTransport.h"
+#include "Config.h"
+
+namespace FujitsuAC {
+
+    // esp-mqtt backend. The client runs in its own task with an outbound queue
+    // and a persistent session, so a slow broker never stalls the loop task
+    class EspMqttTransport : public IMqttTransport {
+        public:
+            EspMqttTransport();
+            ~EspMqttTransport();
+
+            void setServer(const char *host, uint16_t port) override;
+            void setServer(IPAddress ip, uint16_t port) override;
+
+            bool connect(
+                const char *clientId,
+                const char *user,
+                const char *password,
+                const char *willTopic,
+                const char *willMessage
+            ) override;
+
+            bool connected() override;
+            void loop() override;
+
+            bool publish(const char *topic, const char *payload, bool retained = false) override;
+            bool subscribe(const char *topic, uint8_t qos = 0) override;
+
+            uint32_t getInboxFullCount() override { return _inboxFullCount; }
+            uint32_t getOversizedCount() override { return _oversizedCount; }
+
+        private:
+            static constexpr size_t inboxLength = 8;
+            static constexpr int bufferSize = 2048;
+
+            // longer payloads (firmware update) are copied to the heap
+            static constexpr size_t maxPayloadLength = 1024;
+
+            struct InboundMessage {
+                char topic[96];
+                char payload[256];
+                // nullptr unless the payload did not fit, freed by the loop task
+                char *longPayload;
+                uint16_t length;
+            };
+
+            esp_mqtt_client_handle_t _client = nullptr;
+            QueueHandle_t _inbox = nullptr;
+
+            // written from the esp-mqtt task
+            volatile bool _isConnected = false;
+            volatile uint32_t _inboxFullCount = 0;
+            volatile uint32_t _oversizedCount = 0;
+            bool _isServerChanged = false;
+
+            // sized like the settings they are copied from, a valid value is never cut short
+            char _host[Config::mqttHostSize] = "";
+            uint16_t _port = 1883;
+            char _clientId[Config::deviceNameSize] = "";
+            char _user[Config::mqttUserSize] = "";
+            char _password[Config::mqttPwSize] = "";
+            char _willTopic[64] = "";
+            char _willMessage[16] = "";
+
+            void createConfig(esp_mqtt_client_config_t &config);
+
+            static void onEvent(void *handlerArgs, esp_event_base_t base, int32_t eventId, void *eventData);
+            void onData(esp_mqtt_event_handle_t event);
+    };
+
+}
\ No newline at end of file
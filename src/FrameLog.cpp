@@ -0,0 +1,119 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include "FrameLog.h"
+
+namespace FujitsuAC {
+
+    void FrameLog::capture(Direction direction, const uint8_t *data, size_t size) {
+        size = std::min<size_t>(size, sizeof(Frame::data));
+
+        // also covers a disabled log
+        if (headerSize + size > capacity) {
+            return;
+        }
+
+        while (capacity - _used < headerSize + size) {
+            this->dropOldest();
+        }
+
+        uint32_t now = _clock.millis();
+        uint8_t header[headerSize] = {
+            (uint8_t) (now & 0xFF),
+            (uint8_t) ((now >> 8) & 0xFF),
+            (uint8_t) ((now >> 16) & 0xFF),
+            (uint8_t) ((now >> 24) & 0xFF),
+            static_cast<uint8_t>(direction),
+            (uint8_t) size
+        };
+
+        this->write(header, headerSize);
+        this->write(data, size);
+
+        _count++;
+    }
+
+    void FrameLog::clear() {
+        _head = 0;
+        _used = 0;
+        _count = 0;
+    }
+
+    void FrameLog::forEach(std::function<void(const Frame &frame)> onFrame) const {
+        if (0 == capacity) {
+            return;
+        }
+
+        size_t position = this->tail();
+        Frame frame;
+
+        for (size_t i = 0; i < _count; i++) {
+            uint8_t header[headerSize];
+            this->read(position, header, headerSize);
+
+            frame.millis = header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t) header[3] << 24);
+            frame.direction = static_cast<Direction>(header[4]);
+            frame.size = header[5];
+
+            this->read((position + headerSize) % ringSize, frame.data, frame.size);
+            onFrame(frame);
+
+            position = (position + headerSize + frame.size) % ringSize;
+        }
+    }
+
+    size_t FrameLog::toHex(const uint8_t *data, size_t size, char *out, size_t outSize) {
+        static constexpr char digits[] = "0123456789ABCDEF";
+        size_t length = 0;
+
+        if (0 == outSize) {
+            return 0;
+        }
+
+        // separator and two digits, one byte stays for the terminator
+        for (size_t i = 0; i < size && length + 3 < outSize; i++) {
+            if (i > 0) {
+                out[length++] = ' ';
+            }
+
+            out[length++] = digits[data[i] >> 4];
+            out[length++] = digits[data[i] & 0x0F];
+        }
+
+        out[length] = '\0';
+
+        return length;
+    }
+
+    size_t FrameLog::tail() const {
+        return (_head + ringSize - _used) % ringSize;
+    }
+
+    void FrameLog::write(const uint8_t *data, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            _ring[_head] = data[i];
+            _head = (_head + 1) % ringSize;
+        }
+
+        _used += size;
+    }
+
+    void FrameLog::read(size_t position, uint8_t *data, size_t size) const {
+        for (size_t i = 0; i < size; i++) {
+            data[i] = _ring[(position + i) % ringSize];
+        }
+    }
+
+    void FrameLog::dropOldest() {
+        uint8_t size = _ring[(this->tail() + headerSize - 1) % ringSize];
+
+        _used -= headerSize + size;
+        _count--;
+        _overwritten++;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "Clock.h"
+
+// RAM reserved for captured bus frames, 0 disables the capture
+#ifndef FUJITSU_FRAME_LOG_SIZE
+#define FUJITSU_FRAME_LOG_SIZE 4096
+#endif
+
+namespace FujitsuAC {
+
+    // Raw bus frames with timestamps in a binary ring buffer, the oldest are overwritten.
+    // Capturing is a copy only, frames are formatted when they are dumped.
+    class FrameLog {
+        public:
+            enum class Direction: uint8_t {
+                SENT = 0,
+                RECEIVED = 1,
+                // received with an invalid checksum
+                INVALID = 2,
+            };
+
+            struct Frame {
+                uint32_t millis;
+                Direction direction;
+                uint8_t size;
+                uint8_t data[128];
+            };
+
+            FrameLog(Clock &clock = Clock::system()): _clock(clock) {}
+
+            void capture(Direction direction, const uint8_t *data, size_t size);
+            void clear();
+
+            // Calls onFrame for every stored frame, oldest first
+            void forEach(std::function<void(const Frame &frame)> onFrame) const;
+
+            size_t getCount() const { return _count; }
+            uint32_t getOverwrittenCount() const { return _overwritten; }
+
+            // "00 1F A0", returns the length without the terminator
+            static size_t toHex(const uint8_t *data, size_t size, char *out, size_t outSize);
+
+        private:
+            static constexpr size_t capacity = FUJITSU_FRAME_LOG_SIZE;
+            // positions wrap by this, never 0 so a disabled log does not divide by zero
+            static constexpr size_t ringSize = capacity > 0 ? capacity : 1;
+            // millis, direction and size
+            static constexpr size_t headerSize = 6;
+
+            Clock &_clock;
+
+            uint8_t _ring[ringSize];
+            size_t _head = 0;
+            size_t _used = 0;
+            size_t _count = 0;
+            uint32_t _overwritten = 0;
+
+            size_t tail() const;
+            void write(const uint8_t *data, size_t size);
+            void read(size_t position, uint8_t *data, size_t size) const;
+            void dropOldest();
+    };
+
+}
\ No newline at end of file
@@ -4,9 +4,11 @@
   
   Project home: https://github.com/Benas09/FujitsuAC
 */
-#pragma once
 #include "FujitsuAC.h"
 #include "TFSXW1Bridge.h"
+#include "EspMqttTransport.h"
+#include "PubSubTransport.h"
+#include "Trace.h"
 // #include "TFSXJ4Bridge.h"
 
 #define VERSION "1.4.4"
@@ -28,12 +30,24 @@ namespace FujitsuAC {
         int txPin, 
         int ledWPin, 
         int ledRPin, 
-        int resetButtonPin
+        int resetButtonPin,
+        MqttBackend mqttBackend,
+        DiscoveryMode discoveryMode,
+        StateMode stateMode,
+        uint16_t publishRate,
+        uint16_t publishBurst
     ):
         _config(VERSION, uartPort, rxPin, txPin, ledWPin, ledRPin, resetButtonPin),
         server(80),
-        espClient(),
-        _mqttClient(espClient)
+        _mqttClient(MqttBackend::ASYNC == mqttBackend
+            ? static_cast<IMqttTransport*>(new EspMqttTransport())
+            : new PubSubTransport()
+        ),
+        _connection(_config, *_mqttClient),
+        _discoveryMode(discoveryMode),
+        _stateMode(stateMode),
+        _publishRate(publishRate),
+        _publishBurst(publishBurst)
     {}
 
     void FujitsuAC::setup() {
@@ -48,26 +62,36 @@ namespace FujitsuAC {
             return;
         }
 
-        this->connectToWifi();
-        this->setupOTA();
+        // The AC bus does not depend on the network, start the UART wake sequence right away
+        this->createBridge();
 
-        _mqttClient.setServer(_config.getMqttIp().c_str(), (uint16_t) _config.getMqttPort().toInt());
-        _mqttClient.setBufferSize(2048);
+        _connection.setOnMqttConnectedCallback([this]() {
+            this->onMqttConnected();
+        });
+
+        _connection.setOnTimeoutCallback([this](ConnectionTimeout timeout) {
+            this->onConnectionTimeout(timeout);
+        });
+
+        _connection.begin();
     }
 
     void FujitsuAC::setupOTA() {
-        String password = _config.getOtaPw();
+        const char *password = _config.getOtaPw();
 
-        if (password.isEmpty()) {
+        if ('\0' == password[0]) {
             password = "faircon";
         }
 
-        ArduinoOTA.setHostname(_config.getDeviceName().c_str());
-        ArduinoOTA.setPassword(password.c_str());
+        ArduinoOTA.setHostname(_config.getDeviceName());
+        ArduinoOTA.setPassword(password);
         ArduinoOTA.begin();
     }
 
     void FujitsuAC::loop() {
+        // short iterations would only flood the ring
+        FUJITSU_TRACE_SCOPE("loop", LOOP, 1000);
+
         this->handleResetButton();
 
         if (this->isAPState()) {
@@ -85,16 +109,25 @@ namespace FujitsuAC {
             return;
         }
 
-        if (WiFi.status() != WL_CONNECTED) {
-            ESP.restart();
-        }
+        _connection.loop();
+
+        if (_connection.isWifiConnected()) {
+            if (!this->otaStarted) {
+                this->otaStarted = true;
+                this->setupOTA();
+            }
 
-        ArduinoOTA.handle();
+            ArduinoOTA.handle();
+        }
 
-        this->connectToMqtt();
+        if (_connection.isMqttConnected()) {
+            _mqttClient->loop();
+        }
 
-        _mqttClient.loop();
-        this->bridge->loop();
+        // keeps servicing the AC while WiFi or MQTT is reconnecting
+        if (nullptr != this->bridge) {
+            this->bridge->loop();
+        }
     }
 
     void FujitsuAC::clearConfig() {
@@ -122,7 +155,7 @@ namespace FujitsuAC {
         String out;
         out.reserve(s.length());
 
-        for (int i = 0; i < s.length(); i++) {
+        for (unsigned int i = 0; i < s.length(); i++) {
             char c = s[i];
 
             if (c == '+') {
@@ -145,15 +178,20 @@ namespace FujitsuAC {
     }
 
     void FujitsuAC::parseConfig(String content) {
-        _config.setValue("wifi-ssid", getConfigValue(content, "wifi-ssid"));
-        _config.setValue("wifi-pw", getConfigValue(content, "wifi-pw")); 
-        _config.setValue("mqtt-ip", getConfigValue(content, "mqtt-ip")); 
-        _config.setValue("mqtt-port", getConfigValue(content, "mqtt-port")); 
-        _config.setValue("mqtt-user", getConfigValue(content, "mqtt-user")); 
-        _config.setValue("mqtt-pw", getConfigValue(content, "mqtt-pw")); 
-        _config.setValue("device-name", getConfigValue(content, "device-name")); 
-        _config.setValue("ota-pw", getConfigValue(content, "ota-pw"));
-        _config.setValue("protocol", getConfigValue(content, "protocol"));
+        _config.setValue("wifi-ssid", getConfigValue(content, "wifi-ssid").c_str());
+        _config.setValue("wifi-pw", getConfigValue(content, "wifi-pw").c_str()); 
+        _config.setValue("mqtt-ip", getConfigValue(content, "mqtt-ip").c_str()); 
+        _config.setValue("mqtt-port", getConfigValue(content, "mqtt-port").c_str()); 
+        _config.setValue("mqtt-user", getConfigValue(content, "mqtt-user").c_str()); 
+        _config.setValue("mqtt-pw", getConfigValue(content, "mqtt-pw").c_str()); 
+        _config.setValue("device-name", getConfigValue(content, "device-name").c_str()); 
+        _config.setValue("ota-pw", getConfigValue(content, "ota-pw").c_str());
+        _config.setValue("protocol", getConfigValue(content, "protocol").c_str());
+        _config.setValue("static-ip", getConfigValue(content, "static-ip").c_str());
+        _config.setValue("gateway", getConfigValue(content, "gateway").c_str());
+        _config.setValue("subnet", getConfigValue(content, "subnet").c_str());
+        _config.setValue("dns", getConfigValue(content, "dns").c_str());
+        _config.save();
 
         isFallbackAp = false;
         fallbackApReason = FallbackApReason::None;
@@ -189,7 +227,7 @@ namespace FujitsuAC {
         WiFi.softAPConfig(apIP, apGateway, apSubnet);
 
         char accessPointName[64];
-        snprintf(accessPointName, sizeof(accessPointName), "faircon-%s", _config.getUniqueId().c_str());
+        snprintf(accessPointName, sizeof(accessPointName), "faircon-%s", _config.getUniqueId());
 
         if (!WiFi.softAP(accessPointName)) {
             ESP.restart();
@@ -204,122 +242,47 @@ namespace FujitsuAC {
         return true;
     }
 
-    void FujitsuAC::connectToWifi()
-    {
-        if (WiFi.status() == WL_CONNECTED) {
-            return;
-        }
-
-        uint32_t start = millis();
-
-        WiFi.disconnect(true, true);
-        WiFi.setHostname(_config.getDeviceName().c_str());
-        WiFi.mode(WIFI_STA);
-
-        _config.setWifiSleepEnabled(_config.isWifiSleepEnabled());
-
-        int bestNetwork = -1;
-        int bestRSSI = -1000;
-
-        int networkCount = WiFi.scanNetworks();
-
-        for (int i = 0; i < networkCount; i++) {
-            uint8_t* bssid = WiFi.BSSID(i);
-            int rssi = WiFi.RSSI(i);
-
-            if (
-                WiFi.SSID(i) == _config.getWifiSsid()
-                && rssi > bestRSSI
-            ) {
-                bestRSSI = rssi;
-                bestNetwork = i;
-            }
-        }
-
-        if (-1 != bestNetwork) {
-            uint8_t* bestBssid = WiFi.BSSID(bestNetwork);
-            int channel = WiFi.channel(bestNetwork);
-
-            WiFi.begin(_config.getWifiSsid(), _config.getWifiPw(), channel, bestBssid, true);
+    void FujitsuAC::createBridge() {
+        if (0 == strcmp(_config.getProtocol(), "UTY-TFSXJ4")) {
+            // bridge = new TFSXJ4Bridge(_config, mqttClient);
+            // bridge->setup();
         } else {
-            WiFi.begin(_config.getWifiSsid(), _config.getWifiPw());
-        }
-
-        while (WiFi.status() != WL_CONNECTED) {
-            this->handleResetButton();
-            
-            _config.toggleRLed(false);
-            delay(500);
-
-            _config.toggleRLed(true);
-            delay(500);
-
-            if (millis() - start > 60000) {
-                isFallbackAp = true;
-                fallbackApReason = FallbackApReason::UnableToConnectWiFi;
-
-                ESP.restart();
-            }
+            bridge = new TFSXW1Bridge(_config, *_mqttClient);
+            bridge->setDiscoveryMode(_discoveryMode);
+            bridge->setStateMode(_stateMode);
+            bridge->setPublishRate(_publishRate, _publishBurst);
+            bridge->setup();
         }
     }
 
-    void FujitsuAC::connectToMqtt() {
-        if (_mqttClient.connected()) {
+    void FujitsuAC::onMqttConnected() {
+        if (nullptr == bridge) {
             return;
         }
 
-        //show that Wifi is still connected
-        _config.toggleRLed(true);
-
-        uint32_t start = millis();
-
-        while (!_mqttClient.connected()) {
-            this->handleResetButton();
-
-            if (WiFi.status() != WL_CONNECTED) {
-                ESP.restart();
-            }
-
-            _config.toggleWLed(false);
+        // bridge, controller and registry survive the outage, only MQTT state is resent
+        bridge->configureMqtt();
 
-            char topic[64];
-            snprintf(topic, sizeof(topic), "fujitsu/%s/status", _config.getUniqueId().c_str());
+        char buffer[48];
 
-            bool connected = false;
+        snprintf(buffer, sizeof(buffer), "%u", (unsigned int) _connection.getReconnectCount());
+        bridge->publishState("reconnects", buffer);
 
-            if (_config.getMqttUser() == "") {
-                connected = _mqttClient.connect(_config.getDeviceName().c_str(), topic, 0, true, "offline");
-            } else {
-                connected = _mqttClient.connect(_config.getDeviceName().c_str(), _config.getMqttUser().c_str(), _config.getMqttPw().c_str(), topic, 0, true, "offline");
-            }
-
-            if (connected) {
-                _config.toggleWLed(true);
-
-                if (nullptr == bridge) {
-                    if (_config.getProtocol() == "UTY-TFSXJ4") {
-                        // bridge = new TFSXJ4Bridge(_config, mqttClient);
-                        // bridge->setup();
-                    } else {
-                        bridge = new TFSXW1Bridge(_config, _mqttClient);
-                        bridge->setup();
-                    }
-                } else {
-                    bridge->configureMqtt();
-                }
-            } else {
-                _config.toggleWLed(true);
-
-                if (millis() - start > 60000) {
-                    isFallbackAp = true;
-                    fallbackApReason = FallbackApReason::UnableToConnectMqtt;
+        if (_connection.getReconnectCount() > 0) {
+            snprintf(buffer, sizeof(buffer), "Reconnected after %u ms", (unsigned int) _connection.getLastOutageMillis());
+            bridge->debug("info", buffer);
+        }
+    }
 
-                    ESP.restart();
-                }
+    void FujitsuAC::onConnectionTimeout(ConnectionTimeout timeout) {
+        // only reported until the first successful connection, most likely wrong credentials
+        isFallbackAp = true;
+        fallbackApReason = ConnectionTimeout::MQTT == timeout
+            ? FallbackApReason::UnableToConnectMqtt
+            : FallbackApReason::UnableToConnectWiFi
+        ;
 
-                delay(1000);
-            }
-        }
+        ESP.restart();
     }
 
     void FujitsuAC::handleHttp() {
@@ -459,34 +422,46 @@ namespace FujitsuAC {
             const char *formBody = R"rawliteral(
                 <form name="config" method="post" accept-charset="UTF-8">
                     <label>Wifi SSID</label>
-                    <input type="text" name="wifi-ssid" required>
+                    <input type="text" name="wifi-ssid" maxlength="32" required>
 
                     <label>Wifi password</label>
-                    <input type="text" name="wifi-pw" required>
+                    <input type="text" name="wifi-pw" maxlength="64" required>
 
                     <label>MQTT Server IP (or domain name)</label>
-                    <input type="text" name="mqtt-ip" value="192.168.1.100" required>
+                    <input type="text" name="mqtt-ip" maxlength="253" value="192.168.1.100" required>
 
                     <label>MQTT Server port</label>
-                    <input type="text" name="mqtt-port" value="1883" required>
+                    <input type="text" name="mqtt-port" maxlength="5" value="1883" required>
 
                     <label>MQTT User</label>
-                    <input type="text" name="mqtt-user">
+                    <input type="text" name="mqtt-user" maxlength="128">
 
                     <label>MQTT Password</label>
-                    <input type="text" name="mqtt-pw">
+                    <input type="text" name="mqtt-pw" maxlength="128">
 
                     <label>Device name</label>
-                    <input type="text" name="device-name" value="LivingRoomAC" required>
+                    <input type="text" name="device-name" maxlength="64" value="LivingRoomAC" required>
 
                     <label>Device password</label>
-                    <input type="text" name="ota-pw" value="living_room_ac" required>
+                    <input type="text" name="ota-pw" maxlength="64" value="living_room_ac" required>
                     
                     <label>Protocol</label>
                     <select name="protocol">
                         <option value="UTY-TFSXW1">UTY-TFSXW1</option>
                     </select>
 
+                    <label>Static IP (leave empty for DHCP)</label>
+                    <input type="text" name="static-ip" maxlength="15" placeholder="192.168.1.50">
+
+                    <label>Gateway</label>
+                    <input type="text" name="gateway" maxlength="15" placeholder="192.168.1.1">
+
+                    <label>Subnet mask</label>
+                    <input type="text" name="subnet" maxlength="15" placeholder="255.255.255.0">
+
+                    <label>DNS server</label>
+                    <input type="text" name="dns" maxlength="15" placeholder="192.168.1.1">
+
                     <input type="submit" value="Submit">
                 </form>
             )rawliteral";
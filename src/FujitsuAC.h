@@ -20,9 +20,10 @@
 #include <ArduinoOTA.h>
 
 //MQTT
-#include <PubSubClient.h>
+#include <IMqttTransport.h>
 
 #include <Config.h>
+#include <ConnectionManager.h>
 #include <Uart.h>
 #include <IMqttBridge.h>
 
@@ -36,7 +37,12 @@ namespace FujitsuAC {
                 int txPin, 
                 int ledWPin, 
                 int ledRPin,
-                int resetButtonPin
+                int resetButtonPin,
+                MqttBackend mqttBackend = MqttBackend::PUBSUB,
+                DiscoveryMode discoveryMode = DiscoveryMode::ENTITY,
+                StateMode stateMode = StateMode::TOPIC,
+                uint16_t publishRate = 40,
+                uint16_t publishBurst = 20
             );
 
 			void setup();
@@ -47,12 +53,18 @@ namespace FujitsuAC {
 
             NetworkServer server;
 
-            WiFiClient espClient;
-            PubSubClient _mqttClient;
+            IMqttTransport *_mqttClient;
+            ConnectionManager _connection;
 
             IMqttBridge* bridge = nullptr;
+            DiscoveryMode _discoveryMode;
+            StateMode _stateMode;
+            // state messages per second and how many may go out at once
+            uint16_t _publishRate;
+            uint16_t _publishBurst;
 
             uint32_t fallbackApCreatedAt = 0;
+            bool otaStarted = false;
 
             void clearConfig();
             String getConfigValue(String qs, String key);
@@ -66,7 +78,8 @@ namespace FujitsuAC {
             void setupOTA();
             void handleHttp();
 
-            void connectToWifi();
-            void connectToMqtt();
+            void createBridge();
+            void onMqttConnected();
+            void onConnectionTimeout(ConnectionTimeout timeout);
     };
 }
\ No newline at end of file
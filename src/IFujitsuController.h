@@ -10,14 +10,19 @@
 #include <Arduino.h>
 #include "RegistryTable.h"
 #include "Buffer.h"
+#include "FrameLog.h"
+#include "Clock.h"
+#include "Log.h"
 
 namespace FujitsuAC {
 
     class IFujitsuController {
     	public:
-    		IFujitsuController(Stream &uart):
+    		IFujitsuController(Stream &uart, Clock &clock = Clock::system()):
     			uart(uart),
-    			buffer(uart)
+    			clock(clock),
+    			buffer(uart, clock),
+    			frameLog(clock)
     		{}
 
     		virtual ~IFujitsuController() = default;
@@ -41,37 +46,26 @@ namespace FujitsuAC {
 		        return this->registryTable->getRegister(address);
 		    }
 
+		    const FrameLog& getFrameLog() const {
+		        return this->frameLog;
+		    }
+
 	    protected:
 	    	Stream &uart;
+	    	Clock &clock;
 	    	Buffer buffer;
 	    	RegistryTable *registryTable;
+	    	FrameLog frameLog;
 
 	    	std::function<void(const char* name, const char* message)> debugCallback;
 	    	std::function<void(const RegistryTable::Register *reg)> onRegisterChangeCallback;
 
 	    	void debug(const char* name, const char* message) {
-	    		if (this->debugCallback) {
+	    		if (isLogEnabled(name) && this->debugCallback) {
 	    			this->debugCallback(name, message);
 	    		}
 	    	}
 
-	    	const char* toHexStr(uint8_t buffer[128], int size) {
-		        static char hexStr[384];
-		        int offset = 0;
-
-		        for (int i = 0; i < size && offset < sizeof(hexStr) - 3; ++i) {
-		            offset += snprintf(
-		                hexStr + offset, 
-		                sizeof(hexStr) - offset,
-		                (i < size - 1) 
-		                    ? "%02X " 
-		                    : "%02X", buffer[i]
-		            );
-		        }
-
-		        return hexStr;
-		    }
-
 	    private:
 	    	virtual void initRegistryTable() = 0;
     };
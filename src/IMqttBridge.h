@@ -7,30 +7,49 @@
 
 #pragma once
 
-#include "PubSubClient.h"
+#include "IMqttTransport.h"
 #include <WiFi.h>
+#include <memory>
 #include "esp_system.h"
 #include "Config.h"
 #include "NetworkUpdater.h"
+#include "PublishQueue.h"
+#include "DiscoveryEntity.h"
+#include "JsonWriter.h"
+#include "FrameLog.h"
+#include "Log.h"
+#include "Trace.h"
 #include "Uart.h"
+#include "Clock.h"
 
 namespace FujitsuAC {
 
+    enum class StateMode {
+        // fujitsu/<uniqueId>/state/<name>, one retained message per value
+        TOPIC,
+        // fujitsu/<uniqueId>/state, one JSON document with the values changed since the last one
+        JSON
+    };
+
     class IMqttBridge {
         public:
             IMqttBridge(
                 Config &config,
-                PubSubClient &mqttClient
+                IMqttTransport &mqttClient,
+                Clock &clock = Clock::system()
             ): 
                 _config(config),
-                mqttClient(mqttClient)
-            {}
+                mqttClient(mqttClient),
+                _clock(clock),
+                publishQueue(clock)
+            {
+                FUJITSU_TRACE_CLOCK(clock);
+            }
 
             virtual ~IMqttBridge() = default;
 
+            // Starts the AC side only, MQTT is attached later by configureMqtt()
             virtual void setup() {
-                this->configureMqtt();
-
                 this->networkUpdater = new NetworkUpdater();
                 this->networkUpdater->setDebugCallback([this](const char* name, const char* message) {
                     this->debug(name, message);
@@ -43,43 +62,107 @@ namespace FujitsuAC {
 
             void configureMqtt() {
                 char topic[128];
-                snprintf(topic, sizeof(topic), "fujitsu/%s/status", _config.getUniqueId().c_str());
+                snprintf(topic, sizeof(topic), "fujitsu/%s/status", _config.getUniqueId());
                 this->mqttClient.publish(topic, "online", true);
 
                 this->debug("info", "MQTT Connected");
 
                 this->createDeviceConfig();
-                this->registerDiagnosticEntities();
+                this->clearStaleDiscovery();
+                this->publishDiscovery();
                 this->sendInitialDiagnosticData();
                 this->sendDiagnosticData();
 
                 _config.setLedsStatus(_config.isLedsOn());
 
-                this->mqttClient.setCallback([this](char* topic, byte* payload, unsigned int length) {
-                    char message[length + 1];
-                    memcpy(message, payload, length);
-                    message[length] = '\0';
+                this->commandTopicLength = snprintf(
+                    this->commandTopic,
+                    sizeof(this->commandTopic),
+                    "fujitsu/%s/set/",
+                    _config.getUniqueId()
+                );
 
-                    this->onMqtt(topic, message);
+                this->mqttClient.setCallback([this](char* topic, byte* payload, unsigned int length) {
+                    this->onMqtt(topic, payload, length);
                 });
 
-                snprintf(topic, sizeof(topic), "fujitsu/%s/#", _config.getUniqueId().c_str());
-                this->mqttClient.subscribe(topic);
+                // only commands, own state and debug messages are not echoed back.
+                // QoS1 with the persistent session keeps commands sent while reconnecting
+                snprintf(topic, sizeof(topic), "%s#", this->commandTopic);
+                this->mqttClient.subscribe(topic, 1);
+
+                if (StateMode::JSON == this->stateMode) {
+                    // state documents are not retained, HomeAssistant gets a snapshot after its restart
+                    this->mqttClient.subscribe("homeassistant/status", 1);
+                }
+
+                this->onMqttConfigured();
             }
 
             virtual void loop() {
+                if (!this->mqttClient.connected()) {
+                    return;
+                }
+
                 this->networkUpdater->loop();
                 this->sendDiagnosticData();
+
+                if (this->isDiscoveryDirty && (_clock.millis() - this->discoveryDirtyMillis) >= 1000) {
+                    this->publishDiscovery();
+                }
+
+                if (!this->isBusIdle()) {
+                    return;
+                }
+
+                if (StateMode::JSON == this->stateMode) {
+                    this->publishStateDocument();
+                } else {
+                    this->publishQueue.drain([this](const char* name, const char* value) {
+                        return this->publishStateNow(name, value);
+                    });
+                }
             }
 
-            void publishState(const char* name, const char* value) {
-                char topic[64];
+            uint32_t getInboundHandledCount() {
+                return this->inboundHandled;
+            }
+
+            uint32_t getInboundDroppedCount() {
+                return this->inboundDropped;
+            }
+
+            void setDiscoveryMode(DiscoveryMode mode) {
+                this->discoveryMode = mode;
+            }
+
+            void setStateMode(StateMode mode) {
+                this->stateMode = mode;
+            }
+
+            void setPublishRate(uint16_t messagesPerSecond, uint16_t burst) {
+                this->publishQueue.setRate(messagesPerSecond, burst);
+            }
+
+            // false when the value was neither queued nor sent, e.g. the queue is full
+            bool publishState(const char* name, const char* value) {
+                switch (this->publishQueue.push(name, value)) {
+                    case PublishQueue::PushResult::QUEUED:
+                        return true;
 
-                snprintf(topic, sizeof(topic), "fujitsu/%s/state/%s", _config.getUniqueId().c_str(), name);
-                this->mqttClient.publish(topic, value, true);
+                    case PublishQueue::PushResult::TOO_LONG:
+                        return this->publishStateNow(name, value);
+
+                    default:
+                        return false;
+                }
             }
 
             void debug(const char* name, const char* message) {
+                if (!isLogEnabled(name)) {
+                    return;
+                }
+
                 if (strcmp(name, "status") == 0) {
                     this->publishState(name, message);
                     
@@ -87,14 +170,17 @@ namespace FujitsuAC {
                 }
 
                 char topic[64];
-                snprintf(topic, sizeof(topic), "fujitsu/%s/debug/%s", _config.getUniqueId().c_str(), name);
+                snprintf(topic, sizeof(topic), "fujitsu/%s/debug/%s", _config.getUniqueId(), name);
+
+                FUJITSU_TRACE_SCOPE("publish_debug", MQTT, 0);
                 this->mqttClient.publish(topic, message);
             }
 
         protected:
             Stream *_uart = nullptr;
             Config &_config;
-            PubSubClient &mqttClient;
+            IMqttTransport &mqttClient;
+            Clock &_clock;
             String deviceConfig;
 
             enum UartStatus: int {
@@ -107,13 +193,191 @@ namespace FujitsuAC {
             UartStatus _uartStatus = UartStatus::Start;
 
             virtual const char* getProtocolName() = 0;
-            virtual void handleMqttCommand(const char *property, const char *payload) = 0;
+            // Looks the property up in the bridge command table, false when it is unknown
+            virtual bool handleMqttCommand(const char *property, const char *payload) = 0;
             virtual void initializeController() = 0;
+            // Called after every MQTT (re)connect, publishes whatever the controller already knows
+            virtual void onMqttConfigured() = 0;
+
+            // Commands common to all protocols, referenced from the bridge command tables
+            void onRestartCommand(const char* payload) {
+                ESP.restart();
+            }
+
+            void onClearCredentialsCommand(const char* payload) {
+                _config.clear();
+
+                delay(1000);
+                ESP.restart();
+            }
+
+            void onUpdateFirmwareCommand(const char* payload) {
+                this->networkUpdater->updateFirmware(payload);
+            }
+
+            void onLedsCommand(const char* payload) {
+                _config.setLedsStatus(0 == strcmp(payload, "on"));
+                this->publishState("leds", _config.isLedsOn() ? "on" : "off");
+            }
+
+            void onWifiSleepCommand(const char* payload) {
+                _config.setWifiSleepEnabled(0 == strcmp(payload, "on"));
+                this->publishState("wifi_sleep", _config.isWifiSleepEnabled() ? "on" : "off");
+            }
+
+            void onLowCpuSpeedCommand(const char* payload) {
+                _config.setLowCpuSpeedEnabled(0 == strcmp(payload, "on"));
+                this->publishState("low_cpu_speed", _config.isLowCpuSpeedEnabled() ? "on" : "off");
+            }
+
+            // Publishes the captured frames to debug/frames, many lines per message
+            void dumpFrames(const FrameLog &frameLog) {
+                char topic[64];
+                snprintf(topic, sizeof(topic), "fujitsu/%s/debug/frames", _config.getUniqueId());
+
+                char message[1536];
+                size_t length = snprintf(
+                    message,
+                    sizeof(message),
+                    "%u frames, %u overwritten\n",
+                    (unsigned int) frameLog.getCount(),
+                    (unsigned int) frameLog.getOverwrittenCount()
+                );
+
+                frameLog.forEach([&](const FrameLog::Frame &frame) {
+                    static constexpr char directions[] = {'>', '<', '!'};
+                    char line[16 + 3 * sizeof(frame.data)];
+
+                    size_t lineLength = snprintf(
+                        line,
+                        sizeof(line),
+                        "%lu %c ",
+                        (unsigned long) frame.millis,
+                        directions[static_cast<uint8_t>(frame.direction) % sizeof(directions)]
+                    );
+
+                    lineLength += FrameLog::toHex(frame.data, frame.size, line + lineLength, sizeof(line) - lineLength - 1);
+                    line[lineLength++] = '\n';
+                    line[lineLength] = '\0';
+
+                    if (length + lineLength >= sizeof(message)) {
+                        this->mqttClient.publish(topic, message);
+                        length = 0;
+                    }
+
+                    memcpy(message + length, line, lineLength + 1);
+                    length += lineLength;
+                });
+
+                if (length > 0) {
+                    this->mqttClient.publish(topic, message);
+                }
+            }
+
+            // Publishes the trace ring to debug/trace as Chrome trace event JSON. Messages
+            // are parts of one JSON array, concatenated they form the trace file
+            void dumpTrace() {
+#ifdef FUJITSU_TRACE
+                char topic[64];
+                snprintf(topic, sizeof(topic), "fujitsu/%s/debug/trace", _config.getUniqueId());
+
+                char message[1536];
+                size_t length = strlcpy(
+                    message,
+                    "[{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"loop\"}},\n"
+                    "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"bus\"}},\n"
+                    "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":3,\"args\":{\"name\":\"mqtt\"}},\n",
+                    sizeof(message)
+                );
+
+                Trace::forEach([&](const Trace::Event &event) {
+                    char line[160];
+                    size_t lineLength = Trace::toJson(event, line, sizeof(line) - 2);
+
+                    line[lineLength++] = ',';
+                    line[lineLength++] = '\n';
+                    line[lineLength] = '\0';
+
+                    if (length + lineLength >= sizeof(message)) {
+                        this->mqttClient.publish(topic, message);
+                        length = 0;
+                    }
+
+                    memcpy(message + length, line, lineLength + 1);
+                    length += lineLength;
+                });
+
+                static constexpr char end[] = "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"FujitsuAC\"}}]";
+
+                if (length + sizeof(end) > sizeof(message)) {
+                    this->mqttClient.publish(topic, message);
+                    length = 0;
+                }
+
+                memcpy(message + length, end, sizeof(end));
+                this->mqttClient.publish(topic, message);
+#else
+                this->debug("warning", "Tracing is not compiled in, build with -DFUJITSU_TRACE");
+#endif
+            }
+
+            void onSnapshotCommand(const char* payload) {
+                this->sendStaticDiagnosticData();
+                this->lastDiagnosticReportMillis = _clock.millis() - 60000;
+                this->sendDiagnosticData();
+                this->onSnapshotRequested();
+            }
+
+            // Resends every protocol state, they are published together in JSON state mode
+            virtual void onSnapshotRequested() {}
+
+            // States written as JSON numbers in JSON state mode, all others are strings
+            virtual bool isNumericState(const char *name) {
+                return 0 == strcmp(name, "wifi_rssi")
+                    || 0 == strcmp(name, "cpu_temp")
+                    || 0 == strcmp(name, "reconnects")
+                ;
+            }
+
+            // "state_topic" of an entity or "<key>" of a climate topic with its value template
+            void appendStateTopic(String &p, const char *key, const char *templateKey, const char *name) {
+                p += "\"";
+                p += key;
+                p += "\": \"fujitsu/";
+                p += _config.getUniqueId();
+
+                if (StateMode::TOPIC == this->stateMode) {
+                    p += "/state/";
+                    p += name;
+                    p += "\"";
+
+                    return;
+                }
+
+                // a document holds changed values only, HomeAssistant ignores the empty ones
+                p += "/state\",\"";
+                p += templateKey;
+                p += "\": \"{{ value_json.";
+                p += name;
+                p += " if value_json.";
+                p += name;
+                p += " is defined else '' }}\"";
+            }
+
+            // UART to the AC, opened once the wake sequence has finished
+            virtual Stream* createUart() {
+                return new Uart(_config.getUartPort(), _config.getRxPin(), _config.getTxPin());
+            }
+
+            // Queued states are published only while the AC bus is not waiting for a response
+            virtual bool isBusIdle() {
+                return true;
+            }
             
             void initializeUart() {
                 if (IMqttBridge::UartStatus::Start == _uartStatus) {
                     _uartStatus = IMqttBridge::UartStatus::High;
-                    _uartTimer = millis();
+                    _uartTimer = _clock.millis();
 
                     digitalWrite(_config.getTxPin(), HIGH);
 
@@ -121,9 +385,9 @@ namespace FujitsuAC {
 
                     return;
                 } else if (IMqttBridge::UartStatus::High == _uartStatus) {
-                    if (millis() - _uartTimer >= 8700) {
+                    if (_clock.millis() - _uartTimer >= 8700) {
                         _uartStatus = IMqttBridge::UartStatus::Low;
-                        _uartTimer = millis();
+                        _uartTimer = _clock.millis();
 
                         digitalWrite(_config.getTxPin(), LOW);
 
@@ -132,9 +396,9 @@ namespace FujitsuAC {
 
                     return;
                 } else if (IMqttBridge::UartStatus::Low == _uartStatus) {
-                    if (millis() - _uartTimer >= 11000) {
+                    if (_clock.millis() - _uartTimer >= 11000) {
                         _uartStatus = IMqttBridge::UartStatus::Initialized;
-                        _uart = new Uart(_config.getUartPort(), _config.getRxPin(), _config.getTxPin());
+                        _uart = this->createUart();
 
                         this->debug("info", "IMqttBridge: UartStatus::Initialized");
                         this->initializeController();
@@ -142,300 +406,294 @@ namespace FujitsuAC {
                 }
             }
 
-        private:
-            uint32_t _uartTimer = 0;
+            // Describes every entity that exists right now through publishEntity()
+            virtual void describeEntities() {
+                size_t count;
+                const DiscoveryEntity *entities = getDiagnosticEntities(count);
 
-            NetworkUpdater* networkUpdater = nullptr;
+                for (size_t i = 0; i < count; i++) {
+                    if (0 == strcmp(entities[i].name, "leds") && _config.getLedRPin() <= 0) {
+                        continue;
+                    }
 
-            uint32_t lastDiagnosticReportMillis = -60000;
+                    this->publishEntity(entities[i]);
+                }
+            }
 
-            void createDeviceConfig() {
-                if (0 == this->deviceConfig.length()) {
-                    this->deviceConfig = "\"device\": {";
-                    this->deviceConfig += "\"identifiers\": [\"" + _config.getUniqueId() + "\"],";
-                    this->deviceConfig += "\"manufacturer\": \"bepro.lt\",";
-                    this->deviceConfig += "\"model\": \"faircon\",";
-                    this->deviceConfig += "\"name\": \"" + _config.getDeviceName() + "\"";
-                    this->deviceConfig += "}";
+            // Removes the per-entity configs of every entity the bridge may have published
+            virtual void clearEntityConfigs() {
+                size_t count;
+                const DiscoveryEntity *entities = getDiagnosticEntities(count);
+
+                for (size_t i = 0; i < count; i++) {
+                    this->clearEntityConfig(entities[i]);
                 }
             }
 
-            void registerDiagnosticEntities() {
-                char topic[128];
+            void publishDiscovery() {
+                this->isDiscoveryDirty = false;
+
+                if (DiscoveryMode::ENTITY == this->discoveryMode) {
+                    this->describeEntities();
+                    this->debug("info", "Entities registered");
+
+                    return;
+                }
+
+                String components;
+                this->deviceComponents = &components;
+                this->deviceComponentCount = 0;
+
+                this->describeEntities();
+
+                this->deviceComponents = nullptr;
 
                 String p = "{";
-                p += "\"name\": \"status\",";
-                p += "\"icon\": \"mdi:information\",";
-                p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-                p += "\"payload_available\": \"online\",";
-                p += "\"payload_not_available\": \"offline\",";
-                p += "\"state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/status\",";
-                p += "\"device_class\": \"enum\",";
-                p += "\"entity_category\": \"diagnostic\",";
-                p += "\"unique_id\": \"" + _config.getUniqueId() + "_status\",";
                 p += this->deviceConfig;
-                p += "}";
+                p += ",";
+                p += "\"origin\": {\"name\": \"FujitsuAC\", \"sw_version\": \"";
+                p += _config.getVersion();
+                p += "\"},";
+                this->appendAvailability(p);
+                p += "\"components\": {";
+                p += components;
+                p += "}}";
 
-                snprintf(topic, sizeof(topic), "homeassistant/sensor/%s_status/config", _config.getUniqueId().c_str());
+                char topic[128];
+                snprintf(topic, sizeof(topic), "homeassistant/device/%s/config", _config.getUniqueId());
                 this->mqttClient.publish(topic, p.c_str(), true);
 
-                p = "{";
-                p += "\"name\": \"name\",";
-                p += "\"icon\": \"mdi:text-recognition\",";
-                p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-                p += "\"payload_available\": \"online\",";
-                p += "\"payload_not_available\": \"offline\",";
-                p += "\"state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/name\",";
-                p += "\"entity_category\": \"diagnostic\",";
-                p += "\"unique_id\": \"" + _config.getUniqueId() + "_name\",";
-                p += this->deviceConfig;
-                p += "}";
+                char message[64];
+                snprintf(
+                    message,
+                    sizeof(message),
+                    "Device registered, %u entities, %u bytes",
+                    (unsigned int) this->deviceComponentCount,
+                    (unsigned int) p.length()
+                );
 
-                snprintf(topic, sizeof(topic), "homeassistant/sensor/%s_name/config", _config.getUniqueId().c_str());
-                this->mqttClient.publish(topic, p.c_str(), true);
+                this->debug("info", message);
+            }
 
-                p = "{";
-                p += "\"name\": \"wifi_rssi\",";
-                p += "\"icon\": \"mdi:wifi\",";
-                p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-                p += "\"payload_available\": \"online\",";
-                p += "\"payload_not_available\": \"offline\",";
-                p += "\"state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/wifi_rssi\",";
-                p += "\"device_class\": \"signal_strength\",";
-                p += "\"entity_category\": \"diagnostic\",";
-                p += "\"unit_of_measurement\": \"dB\",";
-                p += "\"unique_id\": \"" + _config.getUniqueId() + "_wifi_rssi\",";
-                p += this->deviceConfig;
-                p += "}";
+            // Publishes the entity config, or adds it to the device config in DEVICE mode
+            void publishEntity(const DiscoveryEntity &entity, const char *extraFields = "") {
+                if (DiscoveryMode::DEVICE == this->discoveryMode) {
+                    if (nullptr == this->deviceComponents) {
+                        // the device config is rebuilt as a whole once changes settle
+                        this->markDiscoveryDirty();
 
-                snprintf(topic, sizeof(topic), "homeassistant/sensor/%s_wifi_rssi/config", _config.getUniqueId().c_str());
-                this->mqttClient.publish(topic, p.c_str(), true);
+                        return;
+                    }
 
-                p = "{";
-                p += "\"name\": \"ip\",";
-                p += "\"icon\": \"mdi:ip\",";
-                p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-                p += "\"payload_available\": \"online\",";
-                p += "\"payload_not_available\": \"offline\",";
-                p += "\"state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/ip\",";
-                p += "\"entity_category\": \"diagnostic\",";
-                p += "\"unique_id\": \"" + _config.getUniqueId() + "_ip\",";
-                p += this->deviceConfig;
-                p += "}";
+                    String &p = *this->deviceComponents;
 
-                snprintf(topic, sizeof(topic), "homeassistant/sensor/%s_ip/config", _config.getUniqueId().c_str());
-                this->mqttClient.publish(topic, p.c_str(), true);
+                    if (this->deviceComponentCount++ > 0) {
+                        p += ",";
+                    }
 
-                p = "{";
-                p += "\"name\": \"mac\",";
-                p += "\"icon\": \"mdi:identifier\",";
-                p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-                p += "\"payload_available\": \"online\",";
-                p += "\"payload_not_available\": \"offline\",";
-                p += "\"state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/mac\",";
-                p += "\"entity_category\": \"diagnostic\",";
-                p += "\"unique_id\": \"" + _config.getUniqueId() + "_mac\",";
-                p += this->deviceConfig;
-                p += "}";
+                    p += "\"";
+                    p += _config.getUniqueId();
+                    p += "_";
+                    p += nullptr != entity.uniqueId ? entity.uniqueId : entity.name;
+                    p += "\": {";
+                    p += "\"platform\": \"";
+                    p += entity.platform;
+                    p += "\",";
+                    this->appendEntityFields(p, entity, extraFields);
+                    p += "}";
 
-                snprintf(topic, sizeof(topic), "homeassistant/sensor/%s_mac/config", _config.getUniqueId().c_str());
-                this->mqttClient.publish(topic, p.c_str(), true);
+                    return;
+                }
 
-                p = "{";
-                p += "\"name\": \"version\",";
-                p += "\"icon\": \"mdi:git\",";
-                p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-                p += "\"payload_available\": \"online\",";
-                p += "\"payload_not_available\": \"offline\",";
-                p += "\"state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/version\",";
-                p += "\"entity_category\": \"diagnostic\",";
-                p += "\"unique_id\": \"" + _config.getUniqueId() + "_version\",";
+                String p = "{";
+                this->appendEntityFields(p, entity, extraFields);
+                p += ",";
+                this->appendAvailability(p);
                 p += this->deviceConfig;
                 p += "}";
 
-                snprintf(topic, sizeof(topic), "homeassistant/sensor/%s_version/config", _config.getUniqueId().c_str());
+                char topic[128];
+                this->getEntityConfigTopic(topic, sizeof(topic), entity);
                 this->mqttClient.publish(topic, p.c_str(), true);
+            }
 
-                p = "{";
-                p += "\"name\": \"latest_version\",";
-                p += "\"icon\": \"mdi:git\",";
-                p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-                p += "\"payload_available\": \"online\",";
-                p += "\"payload_not_available\": \"offline\",";
-                p += "\"state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/latest_version\",";
-                p += "\"entity_category\": \"diagnostic\",";
-                p += "\"unique_id\": \"" + _config.getUniqueId() + "_latest_version\",";
-                p += this->deviceConfig;
-                p += "}";
+            void removeEntity(const DiscoveryEntity &entity) {
+                if (DiscoveryMode::DEVICE == this->discoveryMode) {
+                    // left out of the rebuilt device config
+                    if (nullptr == this->deviceComponents) {
+                        this->markDiscoveryDirty();
+                    }
 
-                snprintf(topic, sizeof(topic), "homeassistant/sensor/%s_latest_version/config", _config.getUniqueId().c_str());
-                this->mqttClient.publish(topic, p.c_str(), true);
+                    return;
+                }
 
-                p = "{";
-                p += "\"name\": \"protocol\",";
-                p += "\"icon\": \"mdi:git\",";
-                p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-                p += "\"payload_available\": \"online\",";
-                p += "\"payload_not_available\": \"offline\",";
-                p += "\"state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/protocol\",";
-                p += "\"entity_category\": \"diagnostic\",";
-                p += "\"unique_id\": \"" + _config.getUniqueId() + "_protocol\",";
-                p += this->deviceConfig;
-                p += "}";
+                this->clearEntityConfig(entity);
+            }
 
-                snprintf(topic, sizeof(topic), "homeassistant/sensor/%s_protocol/config", _config.getUniqueId().c_str());
-                this->mqttClient.publish(topic, p.c_str(), true);
+            void clearEntityConfig(const DiscoveryEntity &entity) {
+                char topic[128];
+                this->getEntityConfigTopic(topic, sizeof(topic), entity);
+                this->mqttClient.publish(topic, "", true);
+            }
 
-                p = "{";
-                p += "\"name\": \"reset_reason\",";
-                p += "\"icon\": \"mdi:restart\",";
-                p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-                p += "\"payload_available\": \"online\",";
-                p += "\"payload_not_available\": \"offline\",";
-                p += "\"state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/reset_reason\",";
-                p += "\"device_class\": \"enum\",";
-                p += "\"entity_category\": \"diagnostic\",";
-                p += "\"unique_id\": \"" + _config.getUniqueId() + "_reset_reason\",";
-                p += this->deviceConfig;
-                p += "}";
+        private:
+            // branch names can be much longer than any other command value
+            static constexpr size_t maxFirmwareValueLength = 1024;
 
-                snprintf(topic, sizeof(topic), "homeassistant/sensor/%s_reset_reason/config", _config.getUniqueId().c_str());
-                this->mqttClient.publish(topic, p.c_str(), true);
+            uint32_t _uartTimer = 0;
 
-                p = "{";
-                p += "\"name\": \"cpu_temp\",";
-                p += "\"icon\": \"mdi:thermometer\",";
-                p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-                p += "\"payload_available\": \"online\",";
-                p += "\"payload_not_available\": \"offline\",";
-                p += "\"state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/cpu_temp\",";
-                p += "\"device_class\": \"temperature\",";
-                p += "\"entity_category\": \"diagnostic\",";
-                p += "\"unit_of_measurement\": \"°C\",";
-                p += "\"unique_id\": \"" + _config.getUniqueId() + "_cpu_temp\",";
-                p += this->deviceConfig;
-                p += "}";
+            NetworkUpdater* networkUpdater = nullptr;
+            PublishQueue publishQueue;
 
-                snprintf(topic, sizeof(topic), "homeassistant/sensor/%s_cpu_temp/config", _config.getUniqueId().c_str());
-                this->mqttClient.publish(topic, p.c_str(), true);
+            // "fujitsu/<uniqueId>/set/", commands are matched against it in place
+            char commandTopic[40] = "";
+            size_t commandTopicLength = 0;
 
-                this->debug("info", "Diagnostic entities registered");
+            uint32_t inboundHandled = 0;
+            uint32_t inboundDropped = 0;
 
-                p = "{";
-                p += "\"name\": \"restart\",";
-                p += "\"icon\": \"mdi:restart\",";
-                p += "\"unique_id\": \"" + _config.getUniqueId() + "_restart\",";
-                p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-                p += "\"payload_available\": \"online\",";
-                p += "\"payload_not_available\": \"offline\",";
-                p += "\"command_topic\": \"fujitsu/" + _config.getUniqueId() + "/set/restart\",";
-                p += "\"entity_category\": \"config\",";
-                p += "\"payload_press\": \"restart\",";
-                p += this->deviceConfig;
-                p += "}";
+            uint32_t lastDiagnosticReportMillis = -60000;
 
-                snprintf(topic, sizeof(topic), "homeassistant/button/%s_%s/config", _config.getUniqueId().c_str(), "restart");
-                this->mqttClient.publish(topic, p.c_str(), true);
+            DiscoveryMode discoveryMode = DiscoveryMode::ENTITY;
+            StateMode stateMode = StateMode::TOPIC;
+            bool isDiscoveryModeChecked = false;
+            bool isDiscoveryDirty = false;
+            uint32_t discoveryDirtyMillis = 0;
+
+            // collects the components while the device config is built
+            String *deviceComponents = nullptr;
+            size_t deviceComponentCount = 0;
+
+            void createDeviceConfig() {
+                if (0 == this->deviceConfig.length()) {
+                    this->deviceConfig = "\"device\": {";
+                    this->deviceConfig += "\"identifiers\": [\"";
+                    this->deviceConfig += _config.getUniqueId();
+                    this->deviceConfig += "\"],";
+                    this->deviceConfig += "\"manufacturer\": \"bepro.lt\",";
+                    this->deviceConfig += "\"model\": \"faircon\",";
+                    this->deviceConfig += "\"name\": \"";
+                    this->deviceConfig += _config.getDeviceName();
+                    this->deviceConfig += "\"";
+                    this->deviceConfig += "}";
+                }
+            }
+
+            static const DiscoveryEntity* getDiagnosticEntities(size_t &count) {
+                static constexpr DiscoveryEntity entities[] = {
+                    {"sensor", "status", "\"icon\": \"mdi:information\", \"device_class\": \"enum\", \"entity_category\": \"diagnostic\"", true, false},
+                    {"sensor", "name", "\"icon\": \"mdi:text-recognition\", \"entity_category\": \"diagnostic\"", true, false},
+                    {"sensor", "wifi_rssi", "\"icon\": \"mdi:wifi\", \"device_class\": \"signal_strength\", \"entity_category\": \"diagnostic\", \"unit_of_measurement\": \"dB\"", true, false},
+                    {"sensor", "reconnects", "\"icon\": \"mdi:wifi-refresh\", \"state_class\": \"total_increasing\", \"entity_category\": \"diagnostic\"", true, false},
+                    {"sensor", "ip", "\"icon\": \"mdi:ip\", \"entity_category\": \"diagnostic\"", true, false},
+                    {"sensor", "mac", "\"icon\": \"mdi:identifier\", \"entity_category\": \"diagnostic\"", true, false},
+                    {"sensor", "version", "\"icon\": \"mdi:git\", \"entity_category\": \"diagnostic\"", true, false},
+                    {"sensor", "latest_version", "\"icon\": \"mdi:git\", \"entity_category\": \"diagnostic\"", true, false},
+                    {"sensor", "protocol", "\"icon\": \"mdi:git\", \"entity_category\": \"diagnostic\"", true, false},
+                    {"sensor", "reset_reason", "\"icon\": \"mdi:restart\", \"device_class\": \"enum\", \"entity_category\": \"diagnostic\"", true, false},
+                    {"sensor", "cpu_temp", "\"icon\": \"mdi:thermometer\", \"device_class\": \"temperature\", \"entity_category\": \"diagnostic\", \"unit_of_measurement\": \"°C\"", true, false},
+                    {"button", "restart", "\"icon\": \"mdi:restart\", \"entity_category\": \"config\", \"payload_press\": \"restart\"", false, true},
+                    {"button", "update_firmware", "\"icon\": \"mdi:update\", \"entity_category\": \"config\", \"payload_press\": \"master\"", false, true},
+                    {"switch", "leds", "\"icon\": \"mdi:led-outline\", \"entity_category\": \"config\", \"payload_on\": \"on\", \"payload_off\": \"off\"", true, true},
+                    {"switch", "wifi_sleep", "\"icon\": \"mdi:wifi-arrow-down\", \"entity_category\": \"config\", \"payload_on\": \"on\", \"payload_off\": \"off\"", true, true},
+                    {"switch", "low_cpu_speed", "\"icon\": \"mdi:speedometer-slow\", \"entity_category\": \"config\", \"payload_on\": \"on\", \"payload_off\": \"off\"", true, true, "slow_cpu"},
+                    {"button", "clear_credentials", "\"icon\": \"mdi:delete-alert\", \"entity_category\": \"config\", \"payload_press\": \"clear_credentials\"", false, true},
+                };
+
+                count = sizeof(entities) / sizeof(entities[0]);
+
+                return entities;
+            }
 
-                p = "{";
-                p += "\"name\": \"update_firmware\",";
-                p += "\"icon\": \"mdi:update\",";
-                p += "\"unique_id\": \"" + _config.getUniqueId() + "_update_firmware\",";
-                p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
+            void appendAvailability(String &p) {
+                p += "\"availability_topic\": \"fujitsu/";
+                p += _config.getUniqueId();
+                p += "/status\",";
                 p += "\"payload_available\": \"online\",";
                 p += "\"payload_not_available\": \"offline\",";
-                p += "\"command_topic\": \"fujitsu/" + _config.getUniqueId() + "/set/update_firmware\",";
-                p += "\"entity_category\": \"config\",";
-                p += "\"payload_press\": \"master\",";
-                
-                p += this->deviceConfig;
-                p += "}";
+            }
 
-                snprintf(topic, sizeof(topic), "homeassistant/button/%s_%s/config", _config.getUniqueId().c_str(), "update_firmware");
-                this->mqttClient.publish(topic, p.c_str(), true);
+            void appendEntityFields(String &p, const DiscoveryEntity &entity, const char *extraFields) {
+                p += "\"name\": \"";
+                p += entity.name;
+                p += "\",";
+                p += "\"unique_id\": \"";
+                p += _config.getUniqueId();
+                p += "_";
+                p += nullptr != entity.uniqueId ? entity.uniqueId : entity.name;
+                p += "\"";
+
+                if (entity.hasState) {
+                    p += ",";
+                    this->appendStateTopic(p, "state_topic", "value_template", entity.name);
+                }
 
-                if (_config.getLedRPin() > 0) {
-                    p = "{";
-                    p += "\"name\": \"leds\",";
-                    p += "\"icon\": \"mdi:led-outline\",";
-                    p += "\"unique_id\": \"" + _config.getUniqueId() + "_leds\",";
-                    p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-                    p += "\"payload_available\": \"online\",";
-                    p += "\"payload_not_available\": \"offline\",";
-                    p += "\"state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/leds\",";
-                    p += "\"command_topic\": \"fujitsu/" + _config.getUniqueId() + "/set/leds\",";
-                    p += "\"entity_category\": \"config\",";
-                    p += "\"payload_on\": \"on\",";
-                    p += "\"payload_off\": \"off\",";
-                    
-                    p += this->deviceConfig;
-                    p += "}";
+                if (entity.hasCommand) {
+                    p += ",\"command_topic\": \"fujitsu/";
+                    p += _config.getUniqueId();
+                    p += "/set/";
+                    p += entity.name;
+                    p += "\"";
+                }
 
-                    snprintf(topic, sizeof(topic), "homeassistant/switch/%s_%s/config", _config.getUniqueId().c_str(), "leds");
-                    this->mqttClient.publish(topic, p.c_str(), true);
+                if ('\0' != entity.fields[0]) {
+                    p += ",";
+                    p += entity.fields;
                 }
 
-                p = "{";
-                p += "\"name\": \"wifi_sleep\",";
-                p += "\"icon\": \"mdi:wifi-arrow-down\",";
-                p += "\"unique_id\": \"" + _config.getUniqueId() + "_wifi_sleep\",";
-                p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-                p += "\"payload_available\": \"online\",";
-                p += "\"payload_not_available\": \"offline\",";
-                p += "\"state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/wifi_sleep\",";
-                p += "\"command_topic\": \"fujitsu/" + _config.getUniqueId() + "/set/wifi_sleep\",";
-                p += "\"entity_category\": \"config\",";
-                p += "\"payload_on\": \"on\",";
-                p += "\"payload_off\": \"off\",";
-                
-                p += this->deviceConfig;
-                p += "}";
+                if ('\0' != extraFields[0]) {
+                    p += ",";
+                    p += extraFields;
+                }
+            }
 
-                snprintf(topic, sizeof(topic), "homeassistant/switch/%s_%s/config", _config.getUniqueId().c_str(), "wifi_sleep");
-                this->mqttClient.publish(topic, p.c_str(), true);
+            void getEntityConfigTopic(char *topic, size_t size, const DiscoveryEntity &entity) {
+                snprintf(topic, size, "homeassistant/%s/%s_%s/config", entity.platform, _config.getUniqueId(), entity.name);
+            }
 
-                p = "{";
-                p += "\"name\": \"low_cpu_speed\",";
-                p += "\"icon\": \"mdi:speedometer-slow\",";
-                p += "\"unique_id\": \"" + _config.getUniqueId() + "_slow_cpu\",";
-                p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-                p += "\"payload_available\": \"online\",";
-                p += "\"payload_not_available\": \"offline\",";
-                p += "\"state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/low_cpu_speed\",";
-                p += "\"command_topic\": \"fujitsu/" + _config.getUniqueId() + "/set/low_cpu_speed\",";
-                p += "\"entity_category\": \"config\",";
-                p += "\"payload_on\": \"on\",";
-                p += "\"payload_off\": \"off\",";
-                
-                p += this->deviceConfig;
-                p += "}";
+            void markDiscoveryDirty() {
+                this->isDiscoveryDirty = true;
+                this->discoveryDirtyMillis = _clock.millis();
+            }
 
-                snprintf(topic, sizeof(topic), "homeassistant/switch/%s_%s/config", _config.getUniqueId().c_str(), "low_cpu_speed");
-                this->mqttClient.publish(topic, p.c_str(), true);
+            // Removes the configs of the other discovery mode once after it was changed,
+            // otherwise HomeAssistant would see every entity twice
+            void clearStaleDiscovery() {
+                if (this->isDiscoveryModeChecked) {
+                    return;
+                }
 
-                p = "{";
-                p += "\"name\": \"clear_credentials\",";
-                p += "\"icon\": \"mdi:delete-alert\",";
-                p += "\"unique_id\": \"" + _config.getUniqueId() + "_clear_credentials\",";
-                p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-                p += "\"payload_available\": \"online\",";
-                p += "\"payload_not_available\": \"offline\",";
-                p += "\"command_topic\": \"fujitsu/" + _config.getUniqueId() + "/set/clear_credentials\",";
-                p += "\"entity_category\": \"config\",";
-                p += "\"payload_press\": \"clear_credentials\",";
-                
-                p += this->deviceConfig;
-                p += "}";
+                this->isDiscoveryModeChecked = true;
 
-                snprintf(topic, sizeof(topic), "homeassistant/button/%s_%s/config", _config.getUniqueId().c_str(), "clear_credentials");
-                this->mqttClient.publish(topic, p.c_str(), true);
+                // firmware without this setting always published per-entity configs
+                uint8_t publishedMode = static_cast<uint8_t>(DiscoveryMode::ENTITY);
+                _config.loadBlob("discovery", 1, &publishedMode, sizeof(publishedMode));
+
+                if (static_cast<uint8_t>(this->discoveryMode) == publishedMode) {
+                    return;
+                }
+
+                if (DiscoveryMode::DEVICE == this->discoveryMode) {
+                    this->clearEntityConfigs();
+                } else {
+                    char topic[128];
+                    snprintf(topic, sizeof(topic), "homeassistant/device/%s/config", _config.getUniqueId());
+                    this->mqttClient.publish(topic, "", true);
+                }
+
+                publishedMode = static_cast<uint8_t>(this->discoveryMode);
+                _config.saveBlob("discovery", 1, &publishedMode, sizeof(publishedMode));
 
-                this->debug("info", "Configuration entities registered");
+                this->debug("info", "Discovery mode changed, old configs removed");
             }
 
             void sendInitialDiagnosticData() {
                 this->publishState("status", "MqttBridge started");
-                this->publishState("name", _config.getDeviceName().c_str());
+                this->sendStaticDiagnosticData();
+            }
+
+            void sendStaticDiagnosticData() {
+                this->publishState("name", _config.getDeviceName());
                 this->publishState("ip", WiFi.localIP().toString().c_str());
                 this->publishState("mac", WiFi.macAddress().c_str());
                 this->publishState("version", _config.getVersion());
@@ -450,7 +708,7 @@ namespace FujitsuAC {
             }
             
             void sendDiagnosticData() {
-                if ((millis() - this->lastDiagnosticReportMillis) < 60000) {
+                if ((_clock.millis() - this->lastDiagnosticReportMillis) < 60000) {
                     return;
                 }
 
@@ -466,68 +724,143 @@ namespace FujitsuAC {
                     this->publishState("cpu_temp", buffer);
                 }
 
-                this->lastDiagnosticReportMillis = millis();
+                const PublishQueue::Metrics &metrics = this->publishQueue.getMetrics();
+                char message[128];
+
+                snprintf(
+                    message,
+                    sizeof(message),
+                    "depth: %u, max depth: %u, coalesced: %u, dropped: %u, published: %u",
+                    (unsigned int) metrics.depth,
+                    (unsigned int) metrics.maxDepth,
+                    (unsigned int) metrics.coalesced,
+                    (unsigned int) metrics.dropped,
+                    (unsigned int) metrics.published
+                );
+
+                this->debug("publish_queue", message);
+
+                snprintf(
+                    message,
+                    sizeof(message),
+                    "handled: %u, dropped: %u, inbox full: %u, oversized: %u",
+                    (unsigned int) this->inboundHandled,
+                    (unsigned int) this->inboundDropped,
+                    (unsigned int) this->mqttClient.getInboxFullCount(),
+                    (unsigned int) this->mqttClient.getOversizedCount()
+                );
+
+                this->debug("inbound", message);
+
+                this->lastDiagnosticReportMillis = _clock.millis();
             }
             
-            void onMqtt(char* topic, char* payload) {
-                String t = String(topic);
+            bool publishStateNow(const char* name, const char* value) {
+                FUJITSU_TRACE_SCOPE("publish_state", MQTT, 0);
+                char topic[64];
+
+                if (StateMode::JSON == this->stateMode) {
+                    // value too long for the queue, sent in a document of its own
+                    char document[256];
+                    JsonWriter writer(document, sizeof(document));
 
-                int lastSlash = t.lastIndexOf('/');
-                int secondLastSlash = t.lastIndexOf('/', lastSlash - 1);
+                    snprintf(topic, sizeof(topic), "fujitsu/%s/state", _config.getUniqueId());
 
-                String com = t.substring(secondLastSlash + 1, lastSlash);
-                String prop = t.substring(lastSlash + 1).c_str();
+                    return writer.add(name, value, this->isNumericState(name))
+                        && writer.end()
+                        && this->mqttClient.publish(topic, writer.c_str())
+                    ;
+                }
+
+                snprintf(topic, sizeof(topic), "fujitsu/%s/state/%s", _config.getUniqueId(), name);
+
+                return this->mqttClient.publish(topic, value, true);
+            }
 
-                const char *command = com.c_str();
-                const char *property = prop.c_str();
+            void publishStateDocument() {
+                // one document per loop, sized like the MQTT buffer
+                char document[2048];
+                JsonWriter writer(document, sizeof(document));
+
+                char topic[64];
+                snprintf(topic, sizeof(topic), "fujitsu/%s/state", _config.getUniqueId());
+
+                this->publishQueue.drainBatch(
+                    [this, &writer](const char* name, const char* value) {
+                        return writer.add(name, value, this->isNumericState(name));
+                    },
+                    [this, &writer, &topic]() {
+                        FUJITSU_TRACE_SCOPE("publish_document", MQTT, 0);
+
+                        return writer.end() && this->mqttClient.publish(topic, writer.c_str());
+                    }
+                );
+            }
+
+            void onMqtt(const char* topic, const uint8_t* payload, unsigned int length) {
+                char message[256];
+
+                if (
+                    StateMode::JSON == this->stateMode
+                    && 0 == strcmp(topic, "homeassistant/status")
+                ) {
+                    if (6 == length && 0 == memcmp(payload, "online", 6)) {
+                        this->onSnapshotCommand("");
+                    }
 
-                if (0 != strcmp(command, "set")) {
                     return;
                 }
 
-                if (0 == strcmp(property, "restart")) {
-                    ESP.restart();
+                if (0 != strncmp(topic, this->commandTopic, this->commandTopicLength)) {
+                    this->inboundDropped++;
 
                     return;
                 }
 
-                if (0 == strcmp(property, "clear_credentials")) {
-                    _config.clear();
+                const char *property = topic + this->commandTopicLength;
 
-                    delay(1000);
-                    ESP.restart();
+                if ('\0' == property[0] || nullptr != strchr(property, '/')) {
+                    this->inboundDropped++;
 
                     return;
                 }
 
-                if (0 == strcmp(property, "update_firmware")) {
-                    this->networkUpdater->updateFirmware(payload);
+                if (length >= sizeof(message)) {
+                    this->onLongMqttCommand(property, payload, length);
 
                     return;
                 }
 
-                if (0 == strcmp(property, "leds")) {
-                    _config.setLedsStatus(0 == strcmp(payload, "on"));
-                    this->publishState("leds", _config.isLedsOn() ? "on" : "off");
+                memcpy(message, payload, length);
+                message[length] = '\0';
 
-                    return;
+                // parsing and handing the command over to the controller, the bus write is traced there
+                FUJITSU_TRACE_SCOPE("command_enqueue", MQTT, 0);
+
+                if (this->handleMqttCommand(property, message)) {
+                    this->inboundHandled++;
+                } else {
+                    this->inboundDropped++;
                 }
+            }
 
-                if (0 == strcmp(property, "wifi_sleep")) {
-                    _config.setWifiSleepEnabled(0 == strcmp(payload, "on"));
-                    this->publishState("wifi_sleep", _config.isWifiSleepEnabled() ? "on" : "off");
+            // Only the firmware update accepts values longer than the stack buffer, copied to the heap
+            void onLongMqttCommand(const char* property, const uint8_t* payload, unsigned int length) {
+                if (0 != strcmp(property, "update_firmware") || length >= maxFirmwareValueLength) {
+                    this->inboundDropped++;
 
                     return;
                 }
 
-                if (0 == strcmp(property, "low_cpu_speed")) {
-                    _config.setLowCpuSpeedEnabled(0 == strcmp(payload, "on"));
-                    this->publishState("low_cpu_speed", _config.isLowCpuSpeedEnabled() ? "on" : "off");
+                std::unique_ptr<char[]> message(new char[length + 1]);
+                memcpy(message.get(), payload, length);
+                message[length] = '\0';
 
-                    return;
+                if (this->handleMqttCommand(property, message.get())) {
+                    this->inboundHandled++;
+                } else {
+                    this->inboundDropped++;
                 }
-
-                this->handleMqttCommand(property, payload);
             }
 
             static const char* getResetReason() {
@@ -0,0 +1,57 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+namespace FujitsuAC {
+
+    enum class MqttBackend {
+        // PubSubClient, synchronous
+        PUBSUB,
+        // esp-mqtt, own task and persistent session
+        ASYNC
+    };
+
+    class IMqttTransport {
+        public:
+            virtual ~IMqttTransport() = default;
+
+            virtual void setServer(const char *host, uint16_t port) = 0;
+            virtual void setServer(IPAddress ip, uint16_t port) = 0;
+
+            // user is nullptr for anonymous brokers, will message is retained
+            virtual bool connect(
+                const char *clientId,
+                const char *user,
+                const char *password,
+                const char *willTopic,
+                const char *willMessage
+            ) = 0;
+
+            virtual bool connected() = 0;
+            virtual void loop() = 0;
+
+            virtual bool publish(const char *topic, const char *payload, bool retained = false) = 0;
+            virtual bool subscribe(const char *topic, uint8_t qos = 0) = 0;
+
+            // inbound messages lost before reaching the callback, because the hand-over queue
+            // was full or the message did not fit it. Synchronous backends never drop.
+            virtual uint32_t getInboxFullCount() { return 0; }
+            virtual uint32_t getOversizedCount() { return 0; }
+
+            void setCallback(std::function<void(char* topic, uint8_t* payload, unsigned int length)> callback) {
+                this->callback = callback;
+            }
+
+        protected:
+            std::function<void(char* topic, uint8_t* payload, unsigned int length)> callback;
+    };
+
+}
\ No newline at end of file
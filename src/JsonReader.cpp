@@ -0,0 +1,134 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include "JsonReader.h"
+
+namespace FujitsuAC {
+
+    bool JsonReader::forEachMember(
+        const char *json,
+        std::function<bool(const char *key, const char *value)> onMember
+    ) {
+        char key[maxKeyLength + 1];
+        char value[maxValueLength + 1];
+
+        json = skipWhitespace(json);
+
+        if ('{' != *json) {
+            return false;
+        }
+
+        json = skipWhitespace(json + 1);
+
+        if ('}' == *json) {
+            return '\0' == *skipWhitespace(json + 1);
+        }
+
+        while (true) {
+            json = readString(json, key, sizeof(key));
+
+            if (nullptr == json) {
+                return false;
+            }
+
+            json = skipWhitespace(json);
+
+            if (':' != *json) {
+                return false;
+            }
+
+            json = skipWhitespace(json + 1);
+            json = '"' == *json
+                ? readString(json, value, sizeof(value))
+                : readLiteral(json, value, sizeof(value))
+            ;
+
+            if (nullptr == json || !onMember(key, value)) {
+                return false;
+            }
+
+            json = skipWhitespace(json);
+
+            if ('}' == *json) {
+                return '\0' == *skipWhitespace(json + 1);
+            }
+
+            if (',' != *json) {
+                return false;
+            }
+
+            json = skipWhitespace(json + 1);
+        }
+    }
+
+    const char* JsonReader::skipWhitespace(const char *json) {
+        while (' ' == *json || '\t' == *json || '\r' == *json || '\n' == *json) {
+            json++;
+        }
+
+        return json;
+    }
+
+    const char* JsonReader::readString(const char *json, char *out, size_t size) {
+        if ('"' != *json) {
+            return nullptr;
+        }
+
+        json++;
+        size_t length = 0;
+
+        while ('"' != *json) {
+            if ('\0' == *json || length >= size - 1) {
+                return nullptr;
+            }
+
+            if ('\\' == *json) {
+                // only simple escapes, \uXXXX is not expected in commands
+                json++;
+
+                if ('\0' == *json) {
+                    return nullptr;
+                }
+            }
+
+            out[length++] = *json++;
+        }
+
+        out[length] = '\0';
+
+        return json + 1;
+    }
+
+    const char* JsonReader::readLiteral(const char *json, char *out, size_t size) {
+        size_t length = 0;
+
+        while (
+            '\0' != *json
+            && ',' != *json
+            && '}' != *json
+            && ' ' != *json
+            && '\t' != *json
+            && '\r' != *json
+            && '\n' != *json
+        ) {
+            if ('{' == *json || '[' == *json || length >= size - 1) {
+                return nullptr;
+            }
+
+            out[length++] = *json++;
+        }
+
+        if (0 == length) {
+            return nullptr;
+        }
+
+        out[length] = '\0';
+
+        return json;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+namespace FujitsuAC {
+
+    // Reads flat JSON objects like {"mode": "heat", "temp": 22.5}.
+    // Nested objects and arrays are not supported.
+    class JsonReader {
+        public:
+            static constexpr size_t maxKeyLength = 31;
+            static constexpr size_t maxValueLength = 63;
+
+            // Calls onMember for every member with the unquoted value. Returns false on
+            // a syntax error or when onMember returns false
+            static bool forEachMember(
+                const char *json,
+                std::function<bool(const char *key, const char *value)> onMember
+            );
+
+        private:
+            static const char* skipWhitespace(const char *json);
+            static const char* readString(const char *json, char *out, size_t size);
+            static const char* readLiteral(const char *json, char *out, size_t size);
+    };
+
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include "JsonWriter.h"
+
+namespace FujitsuAC {
+
+    // the last byte before the terminator is kept for the closing brace
+    JsonWriter::JsonWriter(char *buffer, size_t size): _buffer(buffer), _size(size - 1) {
+        this->append('{');
+    }
+
+    bool JsonWriter::add(const char *key, const char *value, bool isNumeric) {
+        size_t length = _length;
+
+        bool isWritten = (0 == _count || this->append(','))
+            && this->appendString(key)
+            && this->append(':')
+            && (isNumeric && isNumber(value) ? this->appendRaw(value) : this->appendString(value))
+        ;
+
+        if (!isWritten) {
+            _length = length;
+            _buffer[_length] = '\0';
+
+            return false;
+        }
+
+        _count++;
+
+        return true;
+    }
+
+    bool JsonWriter::end() {
+        _size++;
+
+        return this->append('}');
+    }
+
+    bool JsonWriter::isNumber(const char *value) {
+        const char *c = value;
+
+        if ('-' == *c) {
+            c++;
+        }
+
+        if (!isdigit(*c) || ('0' == c[0] && isdigit(c[1]))) {
+            // JSON numbers have no leading zeros
+            return false;
+        }
+
+        while (isdigit(*c)) {
+            c++;
+        }
+
+        if ('.' == *c) {
+            c++;
+
+            if (!isdigit(*c)) {
+                return false;
+            }
+
+            while (isdigit(*c)) {
+                c++;
+            }
+        }
+
+        return '\0' == *c;
+    }
+
+    bool JsonWriter::append(char c) {
+        // one byte is always kept for the terminator
+        if (_length + 1 >= _size) {
+            return false;
+        }
+
+        _buffer[_length++] = c;
+        _buffer[_length] = '\0';
+
+        return true;
+    }
+
+    bool JsonWriter::appendRaw(const char *value) {
+        while ('\0' != *value) {
+            if (!this->append(*value++)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool JsonWriter::appendString(const char *value) {
+        if (!this->append('"')) {
+            return false;
+        }
+
+        for (; '\0' != *value; value++) {
+            char c = *value;
+
+            if ('"' == c || '\\' == c) {
+                if (!this->append('\\') || !this->append(c)) {
+                    return false;
+                }
+
+                continue;
+            }
+
+            if ((uint8_t) c < 0x20) {
+                // control characters have no place in a state value
+                c = ' ';
+            }
+
+            if (!this->append(c)) {
+                return false;
+            }
+        }
+
+        return this->append('"');
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+namespace FujitsuAC {
+
+    // Writes a flat JSON object member by member into a fixed buffer.
+    // Values are written as strings unless the caller marks them numeric.
+    class JsonWriter {
+        public:
+            JsonWriter(char *buffer, size_t size);
+
+            // false when the member does not fit, the object is left as it was.
+            // A numeric value that is not a valid JSON number is still written as a string
+            bool add(const char *key, const char *value, bool isNumeric = false);
+            // closes the object, call once
+            bool end();
+
+            const char* c_str() const { return _buffer; }
+            size_t getLength() const { return _length; }
+            size_t getCount() const { return _count; }
+
+            static bool isNumber(const char *value);
+
+        private:
+            char *_buffer;
+            size_t _size;
+            size_t _length = 0;
+            size_t _count = 0;
+
+            bool append(char c);
+            bool appendRaw(const char *value);
+            bool appendString(const char *value);
+    };
+
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+// Debug messages above FUJITSU_LOG_LEVEL are compiled out, set it with a build flag,
+// e.g. -DFUJITSU_LOG_LEVEL=FUJITSU_LOG_WARNING
+#define FUJITSU_LOG_NONE 0
+#define FUJITSU_LOG_ERROR 1
+#define FUJITSU_LOG_WARNING 2
+#define FUJITSU_LOG_INFO 3
+#define FUJITSU_LOG_DEBUG 4
+
+#ifndef FUJITSU_LOG_LEVEL
+#define FUJITSU_LOG_LEVEL FUJITSU_LOG_INFO
+#endif
+
+namespace FujitsuAC {
+
+    // Level of a debug topic: "error", "warning", "changed" (debug), "status" (always
+    // published, it is a state) and everything else is info
+    constexpr int logLevelOf(const char *name) {
+        auto equals = [](const char *a, const char *b) {
+            while (*a && *a == *b) {
+                a++;
+                b++;
+            }
+
+            return *a == *b;
+        };
+
+        return equals(name, "status") ? FUJITSU_LOG_NONE
+            : equals(name, "error") ? FUJITSU_LOG_ERROR
+            : equals(name, "warning") ? FUJITSU_LOG_WARNING
+            : equals(name, "changed") ? FUJITSU_LOG_DEBUG
+            : FUJITSU_LOG_INFO
+        ;
+    }
+
+    constexpr bool isLogEnabled(const char *name) {
+        return logLevelOf(name) <= FUJITSU_LOG_LEVEL;
+    }
+
+}
\ No newline at end of file
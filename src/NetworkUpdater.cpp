@@ -4,7 +4,6 @@
   
   Project home: https://github.com/Benas09/FujitsuAC
 */
-#pragma once
 
 #include "NetworkUpdater.h"
 
@@ -169,10 +168,14 @@ namespace FujitsuAC {
 		snprintf(msg, sizeof(msg), "NetworkUpdater: %s", chip.c_str());
 		this->debug("info", msg);
 
-		char path[128];
-		snprintf(path, sizeof(path), "/Benas09/FujitsuAC/refs/heads/%s/fw/%s.bin", branch, chip);
+		// branch can be longer than any fixed buffer
+		String path = "/Benas09/FujitsuAC/refs/heads/";
+		path += branch;
+		path += "/fw/";
+		path += chip;
+		path += ".bin";
 
-		t_httpUpdate_return ret = httpUpdate.update(networkClient, "raw.githubusercontent.com", 443, path);
+		t_httpUpdate_return ret = httpUpdate.update(networkClient, "raw.githubusercontent.com", 443, path.c_str());
 
 		switch (ret) {
 			case HTTP_UPDATE_FAILED: 
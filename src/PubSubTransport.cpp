@@ -0,0 +1,72 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include "PubSubTransport.h"
+
+namespace FujitsuAC {
+
+    PubSubTransport::PubSubTransport():
+        _client(),
+        _mqttClient(_client)
+    {
+        _mqttClient.setBufferSize(bufferSize);
+        // keep a single attempt short, the AC is not serviced while it blocks
+        _client.setConnectionTimeout(connectTimeoutMillis);
+        _mqttClient.setSocketTimeout(connackTimeoutSeconds);
+
+        _mqttClient.setCallback([this](char* topic, byte* payload, unsigned int length) {
+            if (this->callback) {
+                this->callback(topic, payload, length);
+            }
+        });
+    }
+
+    void PubSubTransport::setServer(const char *host, uint16_t port) {
+        _mqttClient.setServer(host, port);
+    }
+
+    void PubSubTransport::setServer(IPAddress ip, uint16_t port) {
+        _mqttClient.setServer(ip, port);
+    }
+
+    bool PubSubTransport::connect(
+        const char *clientId,
+        const char *user,
+        const char *password,
+        const char *willTopic,
+        const char *willMessage
+    ) {
+        return _mqttClient.connect(clientId, user, password, willTopic, 0, true, willMessage);
+    }
+
+    bool PubSubTransport::connected() {
+        return _mqttClient.connected();
+    }
+
+    void PubSubTransport::loop() {
+        _mqttClient.loop();
+    }
+
+    bool PubSubTransport::publish(const char *topic, const char *payload, bool retained) {
+        size_t length = strlen(payload);
+
+        if (strlen(topic) + length + 7 > bufferSize) {
+            // stream payloads that do not fit the buffer (device discovery)
+            return _mqttClient.beginPublish(topic, length, retained)
+                && _mqttClient.write((const uint8_t*) payload, length) == length
+                && _mqttClient.endPublish()
+            ;
+        }
+
+        return _mqttClient.publish(topic, payload, retained);
+    }
+
+    bool PubSubTransport::subscribe(const char *topic, uint8_t qos) {
+        return _mqttClient.subscribe(topic, qos);
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <WiFi.h>
+#include <PubSubClient.h>
+#include "IMqttTransport.h"
+
+namespace FujitsuAC {
+
+    // Default synchronous backend, connect and publish block on the socket.
+    // A connect attempt blocks the loop for at most connectTimeoutMillis for the TCP
+    // handshake plus connackTimeoutSeconds for the broker to answer.
+    class PubSubTransport : public IMqttTransport {
+        public:
+            PubSubTransport();
+
+            void setServer(const char *host, uint16_t port) override;
+            void setServer(IPAddress ip, uint16_t port) override;
+
+            bool connect(
+                const char *clientId,
+                const char *user,
+                const char *password,
+                const char *willTopic,
+                const char *willMessage
+            ) override;
+
+            bool connected() override;
+            void loop() override;
+
+            bool publish(const char *topic, const char *payload, bool retained = false) override;
+            bool subscribe(const char *topic, uint8_t qos = 0) override;
+
+        private:
+            static constexpr uint16_t bufferSize = 2048;
+            static constexpr uint32_t connectTimeoutMillis = 2000;
+            static constexpr uint16_t connackTimeoutSeconds = 2;
+
+            WiFiClient _client;
+            PubSubClient _mqttClient;
+    };
+
+}
\ No newline at end of file
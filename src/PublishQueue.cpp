@@ -0,0 +1,168 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include "PublishQueue.h"
+
+namespace FujitsuAC {
+
+    PublishQueue::PublishQueue(Clock &clock): _clock(clock) {
+        for (size_t i = 0; i < capacity; i++) {
+            _entries[i].name[0] = '\0';
+        }
+
+        _tokens = _maxTokens;
+        _lastRefillMillis = _clock.millis();
+    }
+
+    void PublishQueue::setRate(uint16_t messagesPerSecond, uint16_t burst) {
+        _messagesPerSecond = messagesPerSecond;
+        _maxTokens = (uint32_t) std::max<uint16_t>(burst, 1) * 1000;
+        _tokens = std::min(_tokens, _maxTokens);
+    }
+
+    PublishQueue::PushResult PublishQueue::push(const char *name, const char *value) {
+        Entry *entry = this->find(name);
+
+        if (strlen(name) >= sizeof(entry->name) || strlen(value) >= sizeof(entry->value)) {
+            // an older value must not overwrite the one published directly
+            this->remove(name);
+
+            return PushResult::TOO_LONG;
+        }
+
+        if (nullptr != entry) {
+            strlcpy(entry->value, value, sizeof(entry->value));
+            _metrics.coalesced++;
+
+            return PushResult::QUEUED;
+        }
+
+        entry = this->find("");
+
+        if (nullptr == entry) {
+            _metrics.dropped++;
+
+            return PushResult::DROPPED;
+        }
+
+        strlcpy(entry->name, name, sizeof(entry->name));
+        strlcpy(entry->value, value, sizeof(entry->value));
+        entry->sequence = _sequence++;
+
+        _metrics.depth++;
+        _metrics.maxDepth = std::max(_metrics.maxDepth, _metrics.depth);
+
+        return PushResult::QUEUED;
+    }
+
+    void PublishQueue::remove(const char *name) {
+        Entry *entry = this->find(name);
+
+        if (nullptr == entry) {
+            return;
+        }
+
+        entry->name[0] = '\0';
+        _metrics.depth--;
+    }
+
+    void PublishQueue::drain(std::function<bool(const char *name, const char *value)> publish) {
+        this->refill();
+
+        while (_metrics.depth > 0 && _tokens >= 1000) {
+            Entry *entry = this->oldest();
+
+            if (!publish(entry->name, entry->value)) {
+                return;
+            }
+
+            entry->name[0] = '\0';
+            _metrics.depth--;
+            _metrics.published++;
+            _tokens -= 1000;
+        }
+    }
+
+    void PublishQueue::drainBatch(
+        std::function<bool(const char *name, const char *value)> add,
+        std::function<bool()> publish
+    ) {
+        this->refill();
+
+        if (0 == _metrics.depth || _tokens < 1000) {
+            return;
+        }
+
+        // the order inside one message does not matter, entries left out go with the next one
+        Entry *batch[capacity];
+        size_t size = 0;
+
+        for (size_t i = 0; i < capacity; i++) {
+            if ('\0' == _entries[i].name[0]) {
+                continue;
+            }
+
+            if (!add(_entries[i].name, _entries[i].value)) {
+                break;
+            }
+
+            batch[size++] = &_entries[i];
+        }
+
+        if (0 == size || !publish()) {
+            return;
+        }
+
+        for (size_t i = 0; i < size; i++) {
+            batch[i]->name[0] = '\0';
+        }
+
+        _metrics.depth -= size;
+        _metrics.published += size;
+        _tokens -= 1000;
+    }
+
+    PublishQueue::Entry* PublishQueue::find(const char *name) {
+        for (size_t i = 0; i < capacity; i++) {
+            if (0 == strcmp(_entries[i].name, name)) {
+                return &_entries[i];
+            }
+        }
+
+        return nullptr;
+    }
+
+    PublishQueue::Entry* PublishQueue::oldest() {
+        Entry *oldest = nullptr;
+
+        for (size_t i = 0; i < capacity; i++) {
+            if ('\0' == _entries[i].name[0]) {
+                continue;
+            }
+
+            // wrap-safe comparison of sequence numbers
+            if (nullptr == oldest || (int32_t) (_entries[i].sequence - oldest->sequence) < 0) {
+                oldest = &_entries[i];
+            }
+        }
+
+        return oldest;
+    }
+
+    void PublishQueue::refill() {
+        uint32_t now = _clock.millis();
+        uint32_t elapsed = now - _lastRefillMillis;
+
+        if (0 == elapsed) {
+            return;
+        }
+
+        _lastRefillMillis = now;
+        _tokens = (uint32_t) std::min<uint64_t>((uint64_t) _tokens + (uint64_t) elapsed * _messagesPerSecond, _maxTokens);
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "Clock.h"
+
+namespace FujitsuAC {
+
+    // Outbound state messages keyed by name, the latest value wins.
+    // Drained with a token bucket so bursts do not block the loop task.
+    class PublishQueue {
+        public:
+            enum class PushResult {
+                QUEUED,
+                // name or value does not fit a slot, caller has to publish directly
+                TOO_LONG,
+                // queue is full, the value is lost
+                DROPPED
+            };
+
+            struct Metrics {
+                uint16_t depth;
+                uint16_t maxDepth;
+                uint32_t coalesced;
+                uint32_t dropped;
+                uint32_t published;
+            };
+
+            PublishQueue(Clock &clock = Clock::system());
+
+            void setRate(uint16_t messagesPerSecond, uint16_t burst);
+
+            PushResult push(const char *name, const char *value);
+            void remove(const char *name);
+
+            // publish returns false when the message could not be sent, it stays queued
+            void drain(std::function<bool(const char *name, const char *value)> publish);
+
+            // Moves entries into one message until add returns false, then sends it with
+            // publish. Costs a single token, entries stay queued when publish fails
+            void drainBatch(
+                std::function<bool(const char *name, const char *value)> add,
+                std::function<bool()> publish
+            );
+
+            const Metrics& getMetrics() { return _metrics; }
+
+        private:
+            static constexpr size_t capacity = 96;
+
+            struct Entry {
+                char name[24];
+                char value[32];
+                uint32_t sequence;
+            };
+
+            Clock &_clock;
+
+            Entry _entries[capacity];
+            Metrics _metrics = {};
+
+            uint32_t _sequence = 0;
+
+            uint16_t _messagesPerSecond = 40;
+            // in thousandths of a message
+            uint32_t _tokens = 0;
+            uint32_t _maxTokens = 20000;
+            uint32_t _lastRefillMillis = 0;
+
+            Entry* find(const char *name);
+            Entry* oldest();
+            void refill();
+    };
+
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include "ReportingPolicy.h"
+
+namespace FujitsuAC {
+
+    ReportingPolicy::ReportingPolicy(Settings settings): _settings(settings) {}
+
+    bool ReportingPolicy::setSettings(Settings settings) {
+        if (0 != settings.maxIntervalSeconds && settings.maxIntervalSeconds < settings.minIntervalSeconds) {
+            return false;
+        }
+
+        _settings = settings;
+
+        return true;
+    }
+
+    bool ReportingPolicy::shouldReport(int32_t value, uint32_t now) {
+        if (!_isReported) {
+            return true;
+        }
+
+        uint32_t elapsed = now - _lastReportMillis;
+
+        if (0 != _settings.maxIntervalSeconds && elapsed >= _settings.maxIntervalSeconds * 1000UL) {
+            return true;
+        }
+
+        // with a deadband of 0 any change is reported, but an unchanged value is not
+        return elapsed >= _settings.minIntervalSeconds * 1000UL
+            && value != _lastValue
+            && abs(value - _lastValue) >= _settings.deadband
+        ;
+    }
+
+    void ReportingPolicy::onReported(int32_t value, uint32_t now) {
+        _isReported = true;
+        _lastValue = value;
+        _lastReportMillis = now;
+    }
+
+    void ReportingPolicy::reset() {
+        _isReported = false;
+    }
+
+}
\ No newline at end of file
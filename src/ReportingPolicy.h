@@ -0,0 +1,46 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+namespace FujitsuAC {
+
+    // Decides when a measured value is worth publishing: changes bigger than the
+    // deadband are reported at most once per minimum interval, and the current
+    // value is repeated after the maximum interval even when it did not change
+    class ReportingPolicy {
+        public:
+            struct Settings {
+                uint16_t minIntervalSeconds;
+                // 0 disables the heartbeat
+                uint16_t maxIntervalSeconds;
+                // in units of the reported value, 0 reports every change
+                uint16_t deadband;
+            };
+
+            ReportingPolicy(Settings settings);
+
+            const Settings& getSettings() { return _settings; }
+            bool setSettings(Settings settings);
+
+            bool shouldReport(int32_t value, uint32_t now);
+            void onReported(int32_t value, uint32_t now);
+
+            // next value is reported right away
+            void reset();
+
+        private:
+            Settings _settings;
+
+            bool _isReported = false;
+            int32_t _lastValue = 0;
+            uint32_t _lastReportMillis = 0;
+    };
+
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include "SceneStore.h"
+
+namespace FujitsuAC {
+
+    SceneStore::SceneStore(Config &config): _config(config) {}
+
+    void SceneStore::load() {
+        if (!_config.loadBlob("scenes", blobVersion, _scenes, sizeof(_scenes))) {
+            memset(_scenes, 0, sizeof(_scenes));
+
+            return;
+        }
+
+        for (size_t i = 0; i < maxScenes; i++) {
+            _scenes[i].name[maxNameLength] = '\0';
+            _scenes[i].size = std::min<uint8_t>(_scenes[i].size, maxRegisters);
+        }
+    }
+
+    const SceneStore::Scene* SceneStore::find(const char *name) const {
+        for (size_t i = 0; i < maxScenes; i++) {
+            if ('\0' != _scenes[i].name[0] && 0 == strcmp(_scenes[i].name, name)) {
+                return &_scenes[i];
+            }
+        }
+
+        return nullptr;
+    }
+
+    bool SceneStore::save(const char *name, const RegistryTable::Register *registers, size_t size) {
+        if (!isValidName(name) || 0 == size || size > maxRegisters) {
+            return false;
+        }
+
+        Scene *scene = this->findSlot(name);
+
+        if (nullptr == scene) {
+            scene = this->findSlot("");
+        }
+
+        if (nullptr == scene) {
+            return false;
+        }
+
+        strlcpy(scene->name, name, sizeof(scene->name));
+        scene->size = size;
+        memcpy(scene->registers, registers, size * sizeof(RegistryTable::Register));
+
+        this->persist();
+
+        return true;
+    }
+
+    bool SceneStore::remove(const char *name) {
+        Scene *scene = this->findSlot(name);
+
+        if ('\0' == name[0] || nullptr == scene) {
+            return false;
+        }
+
+        memset(scene, 0, sizeof(Scene));
+        this->persist();
+
+        return true;
+    }
+
+    size_t SceneStore::getCount() const {
+        size_t count = 0;
+
+        for (size_t i = 0; i < maxScenes; i++) {
+            if ('\0' != _scenes[i].name[0]) {
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+    const SceneStore::Scene* SceneStore::getScene(size_t index) const {
+        for (size_t i = 0; i < maxScenes; i++) {
+            if ('\0' == _scenes[i].name[0]) {
+                continue;
+            }
+
+            if (0 == index--) {
+                return &_scenes[i];
+            }
+        }
+
+        return nullptr;
+    }
+
+    bool SceneStore::isValidName(const char *name) {
+        // names end up in discovery JSON, keep them free of characters that need escaping
+        size_t length = strlen(name);
+
+        if (0 == length || length > maxNameLength) {
+            return false;
+        }
+
+        for (size_t i = 0; i < length; i++) {
+            if (!isalnum((unsigned char) name[i]) && '_' != name[i] && '-' != name[i] && ' ' != name[i]) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    SceneStore::Scene* SceneStore::findSlot(const char *name) {
+        for (size_t i = 0; i < maxScenes; i++) {
+            if (0 == strcmp(_scenes[i].name, name)) {
+                return &_scenes[i];
+            }
+        }
+
+        return nullptr;
+    }
+
+    void SceneStore::persist() {
+        _config.saveBlob("scenes", blobVersion, _scenes, sizeof(_scenes));
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include "RegistryTable.h"
+
+namespace FujitsuAC {
+
+    // Named sets of register values, persisted in NVS as one blob
+    class SceneStore {
+        public:
+            static constexpr size_t maxScenes = 8;
+            static constexpr size_t maxRegisters = 12;
+            static constexpr size_t maxNameLength = 15;
+
+            struct Scene {
+                char name[maxNameLength + 1];
+                uint8_t size;
+                RegistryTable::Register registers[maxRegisters];
+            };
+
+            SceneStore(Config &config);
+
+            void load();
+
+            const Scene* find(const char *name) const;
+            bool save(const char *name, const RegistryTable::Register *registers, size_t size);
+            bool remove(const char *name);
+
+            size_t getCount() const;
+            const Scene* getScene(size_t index) const;
+
+            static bool isValidName(const char *name);
+
+        private:
+            static constexpr uint16_t blobVersion = 1;
+
+            Config &_config;
+            Scene _scenes[maxScenes] = {};
+
+            Scene* findSlot(const char *name);
+            void persist();
+    };
+
+}
\ No newline at end of file
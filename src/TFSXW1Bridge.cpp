@@ -5,20 +5,26 @@
   Project home: https://github.com/Benas09/FujitsuAC
 */
 
-#pragma once
-
+#include <cmath>
 #include "TFSXW1Bridge.h"
+#include "JsonReader.h"
 
 namespace FujitsuAC {
     TFSXW1Bridge::TFSXW1Bridge(
         Config &config,
-        PubSubClient &mqttClient
+        IMqttTransport &mqttClient,
+        Clock &clock
     ):
         IMqttBridge(
             config,
-            mqttClient
-        )
-    {}
+            mqttClient,
+            clock
+        ),
+        _scenes(config)
+    {
+        _scenes.load();
+        this->loadReportingSettings();
+    }
 
     void TFSXW1Bridge::loop() {
         IMqttBridge::loop();
@@ -30,6 +36,7 @@ namespace FujitsuAC {
         }
 
         _controller->loop();
+        this->reportPendingTemperatures();
 
         if (!this->isPoweringOn) {
             return;
@@ -41,7 +48,7 @@ namespace FujitsuAC {
             return;
         }
 
-        uint32_t now = millis();
+        uint32_t now = _clock.millis();
 
         if ((now - this->powerOnRetryStartedMillis) >= this->powerOnRetryTimeoutMillis) {
             this->stopPowerOnRetry();
@@ -56,10 +63,7 @@ namespace FujitsuAC {
     void TFSXW1Bridge::initializeController() {
         this->debug("info", "TFSXW1: Initialize controller");
 
-        _controller = new TFSXW1Controller(*_uart);
-
-        this->registerBaseEntities();
-        this->registerSwitch(TFSXW1Controller::Address::Power);
+        _controller = new TFSXW1Controller(*_uart, _clock);
 
         _controller->setOnRegisterChangeCallback([this](const RegistryTable::Register* reg) {
             this->onRegisterChange(reg);
@@ -71,30 +75,112 @@ namespace FujitsuAC {
 
         _controller->setup();
 
+        if (this->mqttClient.connected()) {
+            // diagnostic entities were registered on connect already
+            this->registerControllerEntities();
+            this->sendRegisterStates();
+        }
+
+        this->debug("info", "TFSXW1: Controller initialized");
+    }
+
+    void TFSXW1Bridge::onMqttConfigured() {
+        this->publishReportingSettings();
+
+        if (nullptr == _controller) {
+            // entities are registered once the UART wake sequence completes
+            return;
+        }
+
+        this->sendRegisterStates();
+    }
+
+    bool TFSXW1Bridge::isBusIdle() {
+        return nullptr == _controller || !_controller->isWaitingForResponse();
+    }
+
+    void TFSXW1Bridge::describeEntities() {
+        IMqttBridge::describeEntities();
+
+        if (nullptr == _controller) {
+            return;
+        }
+
+        this->registerControllerEntities();
+
+        size_t count;
+        const FeatureRegistryRelation *relations = getFeatureRelations(count);
+
+        for (size_t i = 0; i < count; i++) {
+            if (_controller->isFeatureSupported(relations[i].featureAddress)) {
+                this->registerSwitch(relations[i].registryAddress);
+            }
+        }
+    }
+
+    void TFSXW1Bridge::clearEntityConfigs() {
+        IMqttBridge::clearEntityConfigs();
+
+        size_t count;
+        const DiscoveryEntity *entities = getEntities(count);
+
+        for (size_t i = 0; i < count; i++) {
+            this->clearEntityConfig(entities[i]);
+        }
+    }
+
+    void TFSXW1Bridge::onSnapshotRequested() {
+        if (nullptr == _controller) {
+            return;
+        }
+
+        this->sendRegisterStates();
+    }
+
+    bool TFSXW1Bridge::isNumericState(const char *name) {
+        // registers without a name are published as their raw hex value and stay strings
+        return 0 == strcmp(name, "temp")
+            || 0 == strcmp(name, "actual_temp")
+            || 0 == strcmp(name, "outdoor_temp")
+            || IMqttBridge::isNumericState(name)
+        ;
+    }
+
+    void TFSXW1Bridge::registerControllerEntities() {
+        this->registerBaseEntities();
+        this->registerSwitch(TFSXW1Controller::Address::Power);
         this->registerClimateEntity();
+        this->registerSceneEntity();
+    }
+
+    void TFSXW1Bridge::sendRegisterStates() {
+        // publish temperatures right away instead of waiting for the report interval
+        _actualTempPolicy.reset();
+        _outdoorTempPolicy.reset();
 
-        //Send initial registry values after Controller initialization
+        //Send current registry values
         size_t registryCount;
         const RegistryTable::Register* registers = _controller->getAllRegisters(registryCount);
 
         for (size_t i = 0; i < registryCount; ++i) {
             if (
-                registers[i].address == TFSXW1Controller::Address::ActualTemp
-                || registers[i].address == TFSXW1Controller::Address::OutdoorTemp
-                || registers[i].address == TFSXW1Controller::Address::SetpointTemp
-            ) {
+                0x0000 == registers[i].value && (
+                    registers[i].address == TFSXW1Controller::Address::ActualTemp
+                    || registers[i].address == TFSXW1Controller::Address::OutdoorTemp
+                    || registers[i].address == TFSXW1Controller::Address::SetpointTemp
+            )) {
+                // not read from the unit yet
                 continue;
             }
 
-            this->onRegisterChange(&registers[i]);
+            // feature entities are part of the discovery already
+            this->publishRegisterState(&registers[i]);
         }
-
-        this->debug("info", "TFSXW1: Controller initialized");
     }
 
     void TFSXW1Bridge::startPowerOnRetry() {
         this->isPoweringOn = true;
-        this->powerOnRetryStartedMillis = millis();
+        this->powerOnRetryStartedMillis = _clock.millis();
 
         this->debug("info", "Power-on pending");
     }
@@ -105,26 +191,29 @@ namespace FujitsuAC {
     }
 
     void TFSXW1Bridge::registerClimateEntity() {
-        String p = "{";
-        p += "\"name\": \"climate\",";
-        p += "\"unique_id\": \"" + _config.getUniqueId() + "_climate\",";
-        p += "\"icon\": \"mdi:air-conditioner\",";
-
-        p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-        p += "\"payload_available\": \"online\",";
-        p += "\"payload_not_available\": \"offline\",";
-
-        p += "\"mode_command_topic\": \"fujitsu/" + _config.getUniqueId() + "/set/mode\",";
-        p += "\"mode_state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/mode\",";
-
-        p += "\"temperature_command_topic\": \"fujitsu/" + _config.getUniqueId() + "/set/temp\",";
-        p += "\"temperature_state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/temp\",";
-
-        p += "\"fan_mode_command_topic\": \"fujitsu/" + _config.getUniqueId() + "/set/fan\",";
-        p += "\"fan_mode_state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/fan\",";
-
-        p += "\"current_temperature_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/actual_temp\",";
-        p += "\"current_humidity_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/humidity\",";
+        String p = "";
+        p += "\"mode_command_topic\": \"fujitsu/";
+        p += _config.getUniqueId();
+        p += "/set/mode\",";
+        this->appendStateTopic(p, "mode_state_topic", "mode_state_template", "mode");
+        p += ",";
+
+        p += "\"temperature_command_topic\": \"fujitsu/";
+        p += _config.getUniqueId();
+        p += "/set/temp\",";
+        this->appendStateTopic(p, "temperature_state_topic", "temperature_state_template", "temp");
+        p += ",";
+
+        p += "\"fan_mode_command_topic\": \"fujitsu/";
+        p += _config.getUniqueId();
+        p += "/set/fan\",";
+        this->appendStateTopic(p, "fan_mode_state_topic", "fan_mode_state_template", "fan");
+        p += ",";
+
+        this->appendStateTopic(p, "current_temperature_topic", "current_temperature_template", "actual_temp");
+        p += ",";
+        this->appendStateTopic(p, "current_humidity_topic", "current_humidity_template", "humidity");
+        p += ",";
 
         p += "\"min_temp\": 18,";
         p += "\"max_temp\": 30,";
@@ -135,14 +224,20 @@ namespace FujitsuAC {
 
         if (_controller->isFeatureSupported(TFSXW1Controller::Address::VerticalSwingSupported)) {
             p += "\"swing_modes\": [\"on\", \"off\"],";
-            p += "\"swing_mode_state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/vertical_swing\",";
-            p += "\"swing_mode_command_topic\": \"fujitsu/" + _config.getUniqueId() + "/set/vertical_swing\",";
+            this->appendStateTopic(p, "swing_mode_state_topic", "swing_mode_state_template", "vertical_swing");
+            p += ",";
+            p += "\"swing_mode_command_topic\": \"fujitsu/";
+            p += _config.getUniqueId();
+            p += "/set/vertical_swing\",";
         }
 
         if (_controller->isFeatureSupported(TFSXW1Controller::Address::HorizontalSwingSupported)) {
             p += "\"swing_horizontal_modes\": [\"on\", \"off\"],";
-            p += "\"swing_horizontal_mode_state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/horizontal_swing\",";
-            p += "\"swing_horizontal_mode_command_topic\": \"fujitsu/" + _config.getUniqueId() + "/set/horizontal_swing\",";
+            this->appendStateTopic(p, "swing_horizontal_mode_state_topic", "swing_horizontal_mode_state_template", "horizontal_swing");
+            p += ",";
+            p += "\"swing_horizontal_mode_command_topic\": \"fujitsu/";
+            p += _config.getUniqueId();
+            p += "/set/horizontal_swing\",";
         }
 
         bool first = true;
@@ -165,65 +260,50 @@ namespace FujitsuAC {
 
         p += "],";
 
-        p += "\"preset_mode_state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/preset\",";
-        p += "\"preset_mode_command_topic\": \"fujitsu/" + _config.getUniqueId() + "/set/preset\",";
-        
-
-        p += this->deviceConfig;
-        p += "}";
+        this->appendStateTopic(p, "preset_mode_state_topic", "preset_mode_state_template", "preset");
+        p += ",";
+        p += "\"preset_mode_command_topic\": \"fujitsu/";
+        p += _config.getUniqueId();
+        p += "/set/preset\"";
 
-        char topic[128];
-        snprintf(topic, sizeof(topic), "homeassistant/climate/%s_climate/config", _config.getUniqueId().c_str());
-        this->mqttClient.publish(topic, p.c_str(), true);
+        this->publishEntity(getEntity("climate"), p.c_str());
     }
 
     void TFSXW1Bridge::registerBaseEntities() {
-        char topic[128];
-
-        String p = "{";
-        p += "\"name\": \"actual_temp\",";
-        p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-        p += "\"payload_available\": \"online\",";
-        p += "\"payload_not_available\": \"offline\",";
-        p += "\"state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/actual_temp\",";
-        p += "\"unit_of_measurement\": \"°C\",";
-        p += "\"unique_id\": \"" + _config.getUniqueId() + "_actual_temp\",";
-        p += "\"device_class\": \"temperature\",";
-        p += this->deviceConfig;
-        p += "}";
-
-        snprintf(topic, sizeof(topic), "homeassistant/sensor/%s_actual_temp/config", _config.getUniqueId().c_str());
-        this->mqttClient.publish(topic, p.c_str(), true);
-
-        p = "{";
-        p += "\"name\": \"outdoor_temp\",";
-        p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-        p += "\"payload_available\": \"online\",";
-        p += "\"payload_not_available\": \"offline\",";
-        p += "\"state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/outdoor_temp\",";
-        p += "\"unit_of_measurement\": \"°C\",";
-        p += "\"unique_id\": \"" + _config.getUniqueId() + "_outdoor_temp\",";
-        p += "\"device_class\": \"temperature\",";
-        p += this->deviceConfig;
-        p += "}";
-
-        snprintf(topic, sizeof(topic), "homeassistant/sensor/%s_outdoor_temp/config", _config.getUniqueId().c_str());
-        this->mqttClient.publish(topic, p.c_str(), true);
+        this->publishEntity(getEntity("actual_temp"));
+        this->publishEntity(getEntity("outdoor_temp"));
 
         this->debug("info", "Base entities registered");
     }
 
+    void TFSXW1Bridge::registerSceneEntity() {
+        if (0 == _scenes.getCount()) {
+            // select without options is not valid, remove the entity
+            this->removeEntity(getEntity("scene"));
+
+            return;
+        }
+
+        String p = "\"options\": [";
+
+        for (size_t i = 0; i < _scenes.getCount(); i++) {
+            if (i > 0) {
+                p += ",";
+            }
+
+            p += '"';
+            p += _scenes.getScene(i)->name;
+            p += '"';
+        }
+
+        p += "]";
+
+        this->publishEntity(getEntity("scene"), p.c_str());
+    }
+
     void TFSXW1Bridge::registerSwitch(TFSXW1Controller::Address address) {
-        String propertyName = String(this->addressToString(address));
-        
-        String p = "{";
-        p += "\"name\": \"" + propertyName + "\",";
-        p += "\"unique_id\": \"" + _config.getUniqueId() + "_" + propertyName + "\",";
-        p += "\"availability_topic\": \"fujitsu/" + _config.getUniqueId() + "/status\",";
-        p += "\"payload_available\": \"online\",";
-        p += "\"payload_not_available\": \"offline\",";
-        p += "\"state_topic\": \"fujitsu/" + _config.getUniqueId() + "/state/" + propertyName + "\",";
-        p += "\"command_topic\": \"fujitsu/" + _config.getUniqueId() + "/set/" + propertyName + "\",";
+        const char *propertyName = this->addressToString(address);
+        String p = "";
 
         if (
             TFSXW1Controller::Address::VerticalAirflow == address
@@ -248,166 +328,564 @@ namespace FujitsuAC {
                 }
             }
 
-            p += "],";
-        } else {
-            p += "\"payload_on\": \"on\",";
-            p += "\"payload_off\": \"off\",";
+            p += "]";
         }
-        
-        p += this->deviceConfig;
-        p += "}";
 
-        char topic[128];
+        this->publishEntity(getEntity(propertyName), p.c_str());
 
-        if (
-            TFSXW1Controller::Address::VerticalAirflow == address
-            || TFSXW1Controller::Address::HorizontalAirflow == address
-        ) {
-            snprintf(topic, sizeof(topic), "homeassistant/select/%s_%s/config", _config.getUniqueId().c_str(), propertyName.c_str());
-        } else {
-            snprintf(topic, sizeof(topic), "homeassistant/switch/%s_%s/config", _config.getUniqueId().c_str(), propertyName.c_str());
+        char message[64];
+        snprintf(message, sizeof(message), "Switch '%s' registered", propertyName);
+
+        this->debug("info", message);
+    }
+
+    const DiscoveryEntity* TFSXW1Bridge::getEntities(size_t &count) {
+        static constexpr DiscoveryEntity entities[] = {
+            {"sensor", "actual_temp", "\"unit_of_measurement\": \"°C\", \"device_class\": \"temperature\"", true, false},
+            {"sensor", "outdoor_temp", "\"unit_of_measurement\": \"°C\", \"device_class\": \"temperature\"", true, false},
+            {"climate", "climate", "\"icon\": \"mdi:air-conditioner\"", false, false},
+            {"select", "scene", "\"icon\": \"mdi:palette\"", true, true},
+            {"switch", "power", "\"payload_on\": \"on\", \"payload_off\": \"off\"", true, true},
+            {"select", "vertical_airflow", "", true, true},
+            {"switch", "vertical_swing", "\"payload_on\": \"on\", \"payload_off\": \"off\"", true, true},
+            {"select", "horizontal_airflow", "", true, true},
+            {"switch", "horizontal_swing", "\"payload_on\": \"on\", \"payload_off\": \"off\"", true, true},
+            {"switch", "powerful", "\"payload_on\": \"on\", \"payload_off\": \"off\"", true, true},
+            {"switch", "economy_mode", "\"payload_on\": \"on\", \"payload_off\": \"off\"", true, true},
+            {"switch", "energy_saving_fan", "\"payload_on\": \"on\", \"payload_off\": \"off\"", true, true},
+            {"switch", "outdoor_unit_low_noise", "\"payload_on\": \"on\", \"payload_off\": \"off\"", true, true},
+            {"switch", "minimum_heat", "\"payload_on\": \"on\", \"payload_off\": \"off\"", true, true},
+            {"switch", "human_sensor", "\"payload_on\": \"on\", \"payload_off\": \"off\"", true, true},
+            {"switch", "coil_dry", "\"payload_on\": \"on\", \"payload_off\": \"off\"", true, true},
+        };
+
+        count = sizeof(entities) / sizeof(entities[0]);
+
+        return entities;
+    }
+
+    const DiscoveryEntity& TFSXW1Bridge::getEntity(const char *name) {
+        size_t count;
+        const DiscoveryEntity *entities = getEntities(count);
+
+        for (size_t i = 0; i < count; i++) {
+            if (0 == strcmp(entities[i].name, name)) {
+                return entities[i];
+            }
         }
 
-        this->mqttClient.publish(topic, p.c_str(), true);
+        // not reached, every registered name is in the table
+        return entities[0];
+    }
 
-        char message[64];
-        snprintf(message, sizeof(message), "Switch '%s' registered", propertyName.c_str());
+    const TFSXW1Bridge::FeatureRegistryRelation* TFSXW1Bridge::getFeatureRelations(size_t &count) {
+        static constexpr FeatureRegistryRelation relations[] = {
+            { TFSXW1Controller::Address::VerticalAirflowDirectionCount, TFSXW1Controller::Address::VerticalAirflow },
+            { TFSXW1Controller::Address::VerticalSwingSupported, TFSXW1Controller::Address::VerticalSwing },
+            { TFSXW1Controller::Address::HorizontalAirflowDirectionCount, TFSXW1Controller::Address::HorizontalAirflow },
+            { TFSXW1Controller::Address::HorizontalSwingSupported, TFSXW1Controller::Address::HorizontalSwing },
+            { TFSXW1Controller::Address::PowerfulSupported, TFSXW1Controller::Address::Powerful },
+            { TFSXW1Controller::Address::EconomyModeSupported, TFSXW1Controller::Address::EconomyMode },
+            { TFSXW1Controller::Address::EnergySavingFanSupported, TFSXW1Controller::Address::EnergySavingFan },
+            { TFSXW1Controller::Address::OutdoorUnitLowNoiseSupported, TFSXW1Controller::Address::OutdoorUnitLowNoise },
+            { TFSXW1Controller::Address::MinimumHeatSupported, TFSXW1Controller::Address::MinimumHeat },
+            { TFSXW1Controller::Address::HumanSensorSupported, TFSXW1Controller::Address::HumanSensor },
+            { TFSXW1Controller::Address::CoilDrySupported, TFSXW1Controller::Address::CoilDry }
+        };
 
-        this->debug("info", message);
+        count = sizeof(relations) / sizeof(relations[0]);
+
+        return relations;
     }
 
-    void TFSXW1Bridge::handleMqttCommand(const char *property, const char* payload) {
-        if (nullptr == _controller) {
-            return;
+    bool TFSXW1Bridge::handleMqttCommand(const char *property, const char* payload) {
+        // Generic commands first, then protocol ones. Parsers are part of the handlers
+        static constexpr Command commands[] = {
+            {"restart", false, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge.onRestartCommand(payload);
+            }},
+            {"clear_credentials", false, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge.onClearCredentialsCommand(payload);
+            }},
+            {"update_firmware", false, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge.onUpdateFirmwareCommand(payload);
+            }},
+            {"leds", false, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge.onLedsCommand(payload);
+            }},
+            {"wifi_sleep", false, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge.onWifiSleepCommand(payload);
+            }},
+            {"low_cpu_speed", false, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge.onLowCpuSpeedCommand(payload);
+            }},
+            {"snapshot", false, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge.onSnapshotCommand(payload);
+            }},
+
+            {"power", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                TFSXW1Enums::Power power = bridge.stringToEnum(TFSXW1Enums::Power::Off, payload);
+
+                if (power == TFSXW1Enums::Power::Off) {
+                    bridge.stopPowerOnRetry();
+                } else if (!bridge._controller->isPoweredOn()) {
+                    bridge.startPowerOnRetry();
+                }
+
+                bridge._controller->setPower(power);
+            }},
+            {"minimum_heat", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge._controller->setMinimumHeat(bridge.stringToEnum(TFSXW1Enums::MinimumHeat::Off, payload));
+            }},
+            {"mode", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                if (0 == strcmp(payload, "off")) {
+                    bridge.stopPowerOnRetry();
+                    bridge._controller->setPower(TFSXW1Enums::Power::Off);
+
+                    return;
+                }
+
+                bridge._controller->setMode(bridge.stringToEnum(TFSXW1Enums::Mode::Auto, payload));
+
+                if (!bridge._controller->isPoweredOn()) {
+                    bridge.startPowerOnRetry();
+                }
+            }},
+            {"temp", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                double temp;
+
+                if (!parseTemp(payload, temp)) {
+                    bridge.debug("warning", "Temp is not a number");
+
+                    return;
+                }
+
+                bridge._controller->setTemp(payload);
+            }},
+            {"fan", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge._controller->setFanSpeed(bridge.stringToEnum(TFSXW1Enums::FanSpeed::Auto, payload));
+            }},
+            {"vertical_airflow", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge._controller->setVerticalAirflow(bridge.stringToEnum(TFSXW1Enums::VerticalAirflow::Position1, payload));
+            }},
+            {"vertical_swing", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge._controller->setVerticalSwing(bridge.stringToEnum(TFSXW1Enums::VerticalSwing::Off, payload));
+            }},
+            {"horizontal_airflow", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge._controller->setHorizontalAirflow(bridge.stringToEnum(TFSXW1Enums::HorizontalAirflow::Position1, payload));
+            }},
+            {"horizontal_swing", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge._controller->setHorizontalSwing(bridge.stringToEnum(TFSXW1Enums::HorizontalSwing::Off, payload));
+            }},
+            {"powerful", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge._controller->setPowerful(bridge.stringToEnum(TFSXW1Enums::Powerful::Off, payload));
+            }},
+            {"economy_mode", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge._controller->setEconomy(bridge.stringToEnum(TFSXW1Enums::EconomyMode::Off, payload));
+            }},
+            {"energy_saving_fan", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge._controller->setEnergySavingFan(bridge.stringToEnum(TFSXW1Enums::EnergySavingFan::Off, payload));
+            }},
+            {"outdoor_unit_low_noise", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge._controller->setOutdoorUnitLowNoise(bridge.stringToEnum(TFSXW1Enums::OutdoorUnitLowNoise::Off, payload));
+            }},
+            {"human_sensor", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge._controller->setHumanSensor(bridge.stringToEnum(TFSXW1Enums::HumanSensor::Off, payload));
+            }},
+            {"coil_dry", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge._controller->setCoilDry(bridge.stringToEnum(TFSXW1Enums::CoilDry::Off, payload));
+            }},
+            {"climate", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge.onClimateCommand(payload);
+            }},
+            {"save_scene", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge.onSaveSceneCommand(payload);
+            }},
+            {"scene", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge.onSceneCommand(payload);
+            }},
+            {"delete_scene", false, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge.onDeleteSceneCommand(payload);
+            }},
+            {"reporting", false, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge.onReportingCommand(payload);
+            }},
+            {"debug_dump", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge.dumpFrames(bridge._controller->getFrameLog());
+            }},
+            {"trace_dump", false, [](TFSXW1Bridge &bridge, const char *payload) {
+                bridge.dumpTrace();
+            }},
+            {"preset", true, [](TFSXW1Bridge &bridge, const char *payload) {
+                if (0 == strcmp(payload, "boost")) {
+                    bridge._controller->setPowerful(TFSXW1Enums::Powerful::On);
+                } else if (0 == strcmp(payload, "eco")) {
+                    bridge._controller->setEconomy(TFSXW1Enums::EconomyMode::On);
+                } else {
+                    if (bridge._controller->isPowerfulEnabled()) {
+                        bridge._controller->setPowerful(TFSXW1Enums::Powerful::Off);
+                    } else if (bridge._controller->isEconomyEnabled()) {
+                        bridge._controller->setEconomy(TFSXW1Enums::EconomyMode::Off);
+                    }
+                }
+            }},
+        };
+
+        static constexpr CommandTable<Command, sizeof(commands) / sizeof(commands[0]), 89> table(commands);
+        static_assert(table.isPerfect(), "Command names collide, choose another table size");
+
+        const Command *command = table.find(property);
+
+        if (nullptr == command) {
+            return false;
         }
 
-        if (0 == strcmp(property, this->addressToString(TFSXW1Controller::Address::Power))) {
-            TFSXW1Enums::Power power = this->stringToEnum(TFSXW1Enums::Power::Off, payload);
+        if (command->requiresController && nullptr == _controller) {
+            // Ignore MQTT commands when controller is not initialized yet
+            return false;
+        }
 
-            if (power == TFSXW1Enums::Power::Off) {
-                this->stopPowerOnRetry();
-            } else if (!_controller->isPoweredOn()) {
-                this->startPowerOnRetry();
+        command->handle(*this, payload);
+
+        return true;
+    }
+
+    void TFSXW1Bridge::onClimateCommand(const char *payload) {
+        // {"mode": "heat", "temp": 22, "fan": "low", "vertical_swing": "off"}
+        TFSXW1Controller::ClimateRequest request;
+
+        auto isSwitchValue = [](const char *value) {
+            return 0 == strcmp(value, "on") || 0 == strcmp(value, "off");
+        };
+
+        auto isPosition = [](const char *value) {
+            return value[0] >= '1' && value[0] <= '6' && '\0' == value[1];
+        };
+
+        // "mode": "off" is checked against "power" once all members are read, in any order
+        bool isModeOff = false;
+
+        bool isValid = JsonReader::forEachMember(payload, [&](const char *key, const char *value) {
+            if (0 == strcmp(key, "power")) {
+                request.hasPower = isSwitchValue(value);
+                request.power = this->stringToEnum(TFSXW1Enums::Power::Off, value);
+
+                return request.hasPower;
             }
 
-            _controller->setPower(power);
+            if (0 == strcmp(key, "mode")) {
+                if (0 == strcmp(value, "off")) {
+                    isModeOff = true;
 
-            return;
-        }
+                    return true;
+                }
 
-        if (0 == strcmp(property, this->addressToString(TFSXW1Controller::Address::MinimumHeat))) {
-            _controller->setMinimumHeat(this->stringToEnum(TFSXW1Enums::MinimumHeat::Off, payload));
+                request.mode = 0 == strcmp(value, "auto")
+                    ? TFSXW1Enums::Mode::Auto
+                    : this->stringToEnum(TFSXW1Enums::Mode::None, value)
+                ;
+                request.hasMode = TFSXW1Enums::Mode::None != request.mode;
 
-            return;
-        }
+                return request.hasMode;
+            }
 
-        if (0 == strcmp(property, this->addressToString(TFSXW1Controller::Address::Mode))) {
-            if (0 == strcmp(payload, "off")) {
-                this->stopPowerOnRetry();
-                _controller->setPower(TFSXW1Enums::Power::Off);
+            if (0 == strcmp(key, "temp")) {
+                request.hasTemp = parseTemp(value, request.temp);
 
-                return;
+                return request.hasTemp;
             }
 
-            _controller->setMode(this->stringToEnum(TFSXW1Enums::Mode::Auto, payload));
+            if (0 == strcmp(key, "fan")) {
+                request.fanSpeed = this->stringToEnum(TFSXW1Enums::FanSpeed::Auto, value);
+                request.hasFanSpeed = TFSXW1Enums::FanSpeed::Auto != request.fanSpeed || 0 == strcmp(value, "auto");
 
-            if (!_controller->isPoweredOn()) {
-                this->startPowerOnRetry();
+                return request.hasFanSpeed;
             }
 
-            return;
+            if (0 == strcmp(key, "vertical_airflow")) {
+                request.hasVerticalAirflow = isPosition(value);
+                request.verticalAirflow = this->stringToEnum(TFSXW1Enums::VerticalAirflow::Position1, value);
+
+                return request.hasVerticalAirflow;
+            }
+
+            if (0 == strcmp(key, "vertical_swing")) {
+                request.hasVerticalSwing = isSwitchValue(value);
+                request.verticalSwing = this->stringToEnum(TFSXW1Enums::VerticalSwing::Off, value);
+
+                return request.hasVerticalSwing;
+            }
+
+            if (0 == strcmp(key, "horizontal_airflow")) {
+                request.hasHorizontalAirflow = isPosition(value);
+                request.horizontalAirflow = this->stringToEnum(TFSXW1Enums::HorizontalAirflow::Position1, value);
+
+                return request.hasHorizontalAirflow;
+            }
+
+            if (0 == strcmp(key, "horizontal_swing")) {
+                request.hasHorizontalSwing = isSwitchValue(value);
+                request.horizontalSwing = this->stringToEnum(TFSXW1Enums::HorizontalSwing::Off, value);
+
+                return request.hasHorizontalSwing;
+            }
+
+            return false;
+        });
+
+        if (isModeOff) {
+            isValid = isValid && !(request.hasPower && TFSXW1Enums::Power::On == request.power);
+
+            request.hasPower = true;
+            request.power = TFSXW1Enums::Power::Off;
         }
 
-        if (0 == strcmp(property, this->addressToString(TFSXW1Controller::Address::SetpointTemp))) {
-            _controller->setTemp(payload);
+        if (!isValid) {
+            this->debug("warning", "Invalid climate command");
 
             return;
         }
 
-        if (0 == strcmp(property, this->addressToString(TFSXW1Controller::Address::FanSpeed))) {
-            _controller->setFanSpeed(this->stringToEnum(TFSXW1Enums::FanSpeed::Auto, payload));
+        if (request.hasMode && !request.hasPower && !_controller->isPoweredOn()) {
+            // turn on in the same frame, like HA does when a mode is selected
+            request.hasPower = true;
+            request.power = TFSXW1Enums::Power::On;
+        }
 
+        if (!_controller->setClimate(request)) {
             return;
         }
 
-        if (0 == strcmp(property, this->addressToString(TFSXW1Controller::Address::VerticalAirflow))) {
-            _controller->setVerticalAirflow(this->stringToEnum(TFSXW1Enums::VerticalAirflow::Position1, payload));
+        if (request.hasPower && TFSXW1Enums::Power::Off == request.power) {
+            this->stopPowerOnRetry();
+        } else if (request.hasPower && !_controller->isPoweredOn()) {
+            this->startPowerOnRetry();
+        }
+    }
+
+    void TFSXW1Bridge::onSaveSceneCommand(const char *payload) {
+        RegistryTable::Register registers[SceneStore::maxRegisters];
+        size_t size = _controller->captureState(registers, SceneStore::maxRegisters);
+
+        if (!_scenes.save(payload, registers, size)) {
+            this->debug("warning", "Scene not saved, invalid name or no free slot");
 
             return;
         }
 
-        if (0 == strcmp(property, this->addressToString(TFSXW1Controller::Address::VerticalSwing))) {
-            _controller->setVerticalSwing(this->stringToEnum(TFSXW1Enums::VerticalSwing::Off, payload));
+        char message[64];
+        snprintf(message, sizeof(message), "Scene '%s' saved", payload);
+        this->debug("info", message);
+
+        this->registerSceneEntity();
+    }
+
+    void TFSXW1Bridge::onSceneCommand(const char *payload) {
+        const SceneStore::Scene *scene = _scenes.find(payload);
+
+        if (nullptr == scene) {
+            this->debug("warning", "Unknown scene");
 
             return;
         }
 
-        if (0 == strcmp(property, this->addressToString(TFSXW1Controller::Address::HorizontalAirflow))) {
-            _controller->setHorizontalAirflow(this->stringToEnum(TFSXW1Enums::HorizontalAirflow::Position1, payload));
-
+        if (!_controller->restoreState(scene->registers, scene->size)) {
             return;
         }
 
-        if (0 == strcmp(property, this->addressToString(TFSXW1Controller::Address::HorizontalSwing))) {
-            _controller->setHorizontalSwing(this->stringToEnum(TFSXW1Enums::HorizontalSwing::Off, payload));
+        for (size_t i = 0; i < scene->size; i++) {
+            if (TFSXW1Controller::Address::Power != scene->registers[i].address) {
+                continue;
+            }
 
-            return;
+            // same retry as a power command, the unit may ignore the first write
+            if (static_cast<uint16_t>(TFSXW1Enums::Power::Off) == scene->registers[i].value) {
+                this->stopPowerOnRetry();
+            } else if (!_controller->isPoweredOn()) {
+                this->startPowerOnRetry();
+            }
         }
 
-        if (0 == strcmp(property, this->addressToString(TFSXW1Controller::Address::Powerful))) {
-            _controller->setPowerful(this->stringToEnum(TFSXW1Enums::Powerful::Off, payload));
+        IMqttBridge::publishState("scene", scene->name);
+    }
+
+    void TFSXW1Bridge::onDeleteSceneCommand(const char *payload) {
+        if (!_scenes.remove(payload)) {
+            this->debug("warning", "Unknown scene");
 
             return;
         }
 
-        if (0 == strcmp(property, this->addressToString(TFSXW1Controller::Address::EconomyMode))) {
-            _controller->setEconomy(this->stringToEnum(TFSXW1Enums::EconomyMode::Off, payload));
+        this->registerSceneEntity();
+    }
+
+    void TFSXW1Bridge::onReportingCommand(const char *payload) {
+        // {"register": "outdoor_temp", "min_interval": 60, "max_interval": 600, "deadband": 5}
+        ReportingPolicy *policy = nullptr;
+        ReportingPolicy::Settings settings = {};
+        bool hasSettings = false;
+
+        auto readNumber = [](const char *value, uint16_t &out) {
+            char *end;
+            unsigned long number = strtoul(value, &end, 10);
+
+            if (!isdigit(value[0]) || '\0' != *end || number > UINT16_MAX) {
+                return false;
+            }
+
+            out = number;
+
+            return true;
+        };
+
+        bool isValid = JsonReader::forEachMember(payload, [&](const char *key, const char *value) {
+            if (0 == strcmp(key, "register")) {
+                if (0 == strcmp(value, "actual_temp")) {
+                    policy = &_actualTempPolicy;
+                } else if (0 == strcmp(value, "outdoor_temp")) {
+                    policy = &_outdoorTempPolicy;
+                }
+
+                if (nullptr != policy && !hasSettings) {
+                    settings = policy->getSettings();
+                    hasSettings = true;
+                }
+
+                return nullptr != policy;
+            }
+
+            if (nullptr == policy) {
+                // register has to come first, other members change its current settings
+                return false;
+            }
+
+            if (0 == strcmp(key, "min_interval")) {
+                return readNumber(value, settings.minIntervalSeconds);
+            }
+
+            if (0 == strcmp(key, "max_interval")) {
+                return readNumber(value, settings.maxIntervalSeconds);
+            }
+
+            if (0 == strcmp(key, "deadband")) {
+                // up to 10 °C
+                return readNumber(value, settings.deadband) && settings.deadband <= 100;
+            }
+
+            return false;
+        });
+
+        if (!isValid || nullptr == policy || !policy->setSettings(settings)) {
+            this->debug("warning", "Invalid reporting command");
 
             return;
         }
 
-        if (0 == strcmp(property, this->addressToString(TFSXW1Controller::Address::EnergySavingFan))) {
-            _controller->setEnergySavingFan(this->stringToEnum(TFSXW1Enums::EnergySavingFan::Off, payload));
+        this->saveReportingSettings();
+        this->publishReportingSettings();
+    }
+
+    void TFSXW1Bridge::loadReportingSettings() {
+        ReportingSettings settings;
 
+        if (!_config.loadBlob("reporting", reportingBlobVersion, &settings, sizeof(settings))) {
             return;
         }
 
-        if (0 == strcmp(property, this->addressToString(TFSXW1Controller::Address::OutdoorUnitLowNoise))) {
-            _controller->setOutdoorUnitLowNoise(this->stringToEnum(TFSXW1Enums::OutdoorUnitLowNoise::Off, payload));
+        // setSettings keeps the defaults when a stored policy is not valid
+        _actualTempPolicy.setSettings(settings.actualTemp);
+        _outdoorTempPolicy.setSettings(settings.outdoorTemp);
+    }
 
-            return;
+    void TFSXW1Bridge::saveReportingSettings() {
+        ReportingSettings settings = {
+            _actualTempPolicy.getSettings(),
+            _outdoorTempPolicy.getSettings()
+        };
+
+        _config.saveBlob("reporting", reportingBlobVersion, &settings, sizeof(settings));
+    }
+
+    void TFSXW1Bridge::publishReportingSettings() {
+        const ReportingPolicy::Settings &actual = _actualTempPolicy.getSettings();
+        const ReportingPolicy::Settings &outdoor = _outdoorTempPolicy.getSettings();
+
+        char message[128];
+        snprintf(
+            message,
+            sizeof(message),
+            "actual_temp: %u/%u s, %u; outdoor_temp: %u/%u s, %u",
+            actual.minIntervalSeconds,
+            actual.maxIntervalSeconds,
+            actual.deadband,
+            outdoor.minIntervalSeconds,
+            outdoor.maxIntervalSeconds,
+            outdoor.deadband
+        );
+
+        this->debug("reporting", message);
+    }
+
+    ReportingPolicy* TFSXW1Bridge::getReportingPolicy(uint16_t address) {
+        switch (address) {
+            case TFSXW1Controller::Address::ActualTemp: return &_actualTempPolicy;
+            case TFSXW1Controller::Address::OutdoorTemp: return &_outdoorTempPolicy;
+            default: return nullptr;
         }
+    }
 
-        if (0 == strcmp(property, this->addressToString(TFSXW1Controller::Address::HumanSensor))) {
-            _controller->setHumanSensor(this->stringToEnum(TFSXW1Enums::HumanSensor::Off, payload));
+    bool TFSXW1Bridge::shouldReport(const RegistryTable::Register *reg) {
+        ReportingPolicy *policy = this->getReportingPolicy(reg->address);
 
-            return;
+        if (nullptr == policy) {
+            return true;
         }
 
-        if (0 == strcmp(property, this->addressToString(TFSXW1Controller::Address::CoilDry))) {
-            _controller->setCoilDry(this->stringToEnum(TFSXW1Enums::CoilDry::Off, payload));
+        // policies work in 0.1 °C
+        int32_t value = ((int32_t) reg->value - 5025) / 10;
+        uint32_t now = _clock.millis();
+
+        if (!policy->shouldReport(value, now)) {
+            return false;
+        }
+
+        policy->onReported(value, now);
+
+        return true;
+    }
 
+    void TFSXW1Bridge::reportPendingTemperatures() {
+        // changes held back by the minimum interval and heartbeats are not
+        // triggered by a register change, so they are checked on every loop
+        if (!this->mqttClient.connected()) {
             return;
         }
 
-        if (0 == strcmp(property, "preset")) {
-            if (0 == strcmp(payload, "boost")) {
-                _controller->setPowerful(TFSXW1Enums::Powerful::On);
-            } else if (0 == strcmp(payload, "eco")) {
-                _controller->setEconomy(TFSXW1Enums::EconomyMode::On);
-            } else {
-                if (_controller->isPowerfulEnabled()) {
-                    _controller->setPowerful(TFSXW1Enums::Powerful::Off);
-                } else if (_controller->isEconomyEnabled()) {
-                    _controller->setEconomy(TFSXW1Enums::EconomyMode::Off);
-                }
+        static constexpr uint16_t addresses[] = {
+            TFSXW1Controller::Address::ActualTemp,
+            TFSXW1Controller::Address::OutdoorTemp
+        };
+
+        for (uint16_t address : addresses) {
+            RegistryTable::Register *reg = _controller->getRegister(address);
+
+            if (0x0000 == reg->value || 0xFFFF == reg->value) {
+                // not read from the unit yet or invalid
+                continue;
             }
 
-            return;
+            if (this->shouldReport(reg)) {
+                this->publishState(reg->address, this->valueToString(reg));
+            }
         }
     }
 
     void TFSXW1Bridge::onRegisterChange(const RegistryTable::Register *reg) {
+        this->publishRegisterState(reg);
+        this->registerFeatureEntity(reg);
+    }
+
+    void TFSXW1Bridge::publishRegisterState(const RegistryTable::Register *reg) {
         if (
             0xFFFF == reg->value && (
                 reg->address == TFSXW1Controller::Address::ActualTemp
@@ -418,14 +896,8 @@ namespace FujitsuAC {
             return;
         }
 
-        if (reg->address == TFSXW1Controller::Address::ActualTemp) {
-            uint32_t now = millis();
-
-            if ((now - this->lastTempReportMillis) < 180000) {
-                return;
-            }
-            
-            this->lastTempReportMillis = now;
+        if (!this->shouldReport(reg)) {
+            return;
         }
 
         this->publishState(reg->address, this->valueToString(reg));
@@ -450,30 +922,16 @@ namespace FujitsuAC {
                 ? "boost"
                 : (_controller->isEconomyEnabled() ? "eco" : "none")
             );
-
-            return;
         }
+    }
 
-        struct FeatureRegistryRelation {
-            TFSXW1Controller::Address featureAddress;
-            TFSXW1Controller::Address registryAddress;
-        };
+    void TFSXW1Bridge::registerFeatureEntity(const RegistryTable::Register *reg) {
+        size_t count;
+        const FeatureRegistryRelation *relations = getFeatureRelations(count);
 
-        static constexpr FeatureRegistryRelation defaults[] = {
-            { TFSXW1Controller::Address::VerticalAirflowDirectionCount, TFSXW1Controller::Address::VerticalAirflow },
-            { TFSXW1Controller::Address::VerticalSwingSupported, TFSXW1Controller::Address::VerticalSwing },
-            { TFSXW1Controller::Address::HorizontalAirflowDirectionCount, TFSXW1Controller::Address::HorizontalAirflow },
-            { TFSXW1Controller::Address::HorizontalSwingSupported, TFSXW1Controller::Address::HorizontalSwing },
-            { TFSXW1Controller::Address::PowerfulSupported, TFSXW1Controller::Address::Powerful },
-            { TFSXW1Controller::Address::EconomyModeSupported, TFSXW1Controller::Address::EconomyMode },
-            { TFSXW1Controller::Address::EnergySavingFanSupported, TFSXW1Controller::Address::EnergySavingFan },
-            { TFSXW1Controller::Address::OutdoorUnitLowNoiseSupported, TFSXW1Controller::Address::OutdoorUnitLowNoise },
-            { TFSXW1Controller::Address::MinimumHeatSupported, TFSXW1Controller::Address::MinimumHeat },
-            { TFSXW1Controller::Address::HumanSensorSupported, TFSXW1Controller::Address::HumanSensor },
-            { TFSXW1Controller::Address::CoilDrySupported, TFSXW1Controller::Address::CoilDry }
-        };
+        for (size_t i = 0; i < count; i++) {
+            const FeatureRegistryRelation &relation = relations[i];
 
-        for (const auto& relation : defaults) {
             if (relation.featureAddress == reg->address) {
                 if (_controller->isFeatureSupported(relation.featureAddress)) {
                     this->registerSwitch(relation.registryAddress);
@@ -481,8 +939,8 @@ namespace FujitsuAC {
                     if (
                         TFSXW1Controller::Address::VerticalSwingSupported == relation.featureAddress
                         || TFSXW1Controller::Address::HorizontalSwingSupported == relation.featureAddress
-                        || TFSXW1Controller::Address::PowerfulSupported
-                        || TFSXW1Controller::Address::EconomyModeSupported
+                        || TFSXW1Controller::Address::PowerfulSupported == relation.featureAddress
+                        || TFSXW1Controller::Address::EconomyModeSupported == relation.featureAddress
                     ) {
                         this->registerClimateEntity();
                     }
@@ -493,9 +951,23 @@ namespace FujitsuAC {
         }
     }
 
-    void TFSXW1Bridge::publishState(uint16_t address, const char* value)
+    bool TFSXW1Bridge::publishState(uint16_t address, const char* value)
     {
-        IMqttBridge::publishState(this->addressToString(address), value);
+        return IMqttBridge::publishState(this->addressToString(address), value);
+    }
+
+    bool TFSXW1Bridge::parseTemp(const char *value, double &temp) {
+        char *end;
+        temp = std::strtod(value, &end);
+
+        // nan, inf and huge values would overflow the conversion to tenths of a degree,
+        // anything far off the 16..30 range of the unit is a typo
+        return end != value
+            && '\0' == *end
+            && std::isfinite(temp)
+            && temp >= 0
+            && temp <= 100
+        ;
     }
 
     const char* TFSXW1Bridge::addressToString(uint16_t address) {
@@ -8,6 +8,9 @@
 #pragma once
 
 #include "IMqttBridge.h"
+#include "CommandTable.h"
+#include "SceneStore.h"
+#include "ReportingPolicy.h"
 #include <Arduino.h>
 #include "RegistryTable.h"
 #include "TFSXW1Controller.h"
@@ -18,35 +21,93 @@ namespace FujitsuAC {
         public:
             TFSXW1Bridge(
                 Config &config,
-                PubSubClient &mqttClient
+                IMqttTransport &mqttClient,
+                Clock &clock = Clock::system()
             );
 
             void loop() override;
             void onRegisterChange(const RegistryTable::Register *reg);
 
+            // nullptr until the UART wake sequence has finished
+            TFSXW1Controller* getController() {
+                return _controller;
+            }
+
         protected:
             const char* getProtocolName() override {
                 return "UTY-TFSXW1";
             }
 
-            void handleMqttCommand(const char *command, const char *property) override;
+            bool handleMqttCommand(const char *property, const char *payload) override;
             void initializeController() override;
+            void onMqttConfigured() override;
+            bool isBusIdle() override;
+            void describeEntities() override;
+            void clearEntityConfigs() override;
+            void onSnapshotRequested() override;
+            bool isNumericState(const char *name) override;
 
         private:
+            struct Command {
+                const char *name;
+                bool requiresController;
+                void (*handle)(TFSXW1Bridge &bridge, const char *payload);
+            };
+
+            // feature register and the register it enables
+            struct FeatureRegistryRelation {
+                TFSXW1Controller::Address featureAddress;
+                TFSXW1Controller::Address registryAddress;
+            };
+
             TFSXW1Controller *_controller = nullptr;
-            uint32_t lastTempReportMillis = -180000;
+            SceneStore _scenes;
+
+            // temperatures in 0.1 °C, persisted as one blob
+            struct ReportingSettings {
+                ReportingPolicy::Settings actualTemp;
+                ReportingPolicy::Settings outdoorTemp;
+            };
+
+            static constexpr uint16_t reportingBlobVersion = 1;
+            ReportingPolicy _actualTempPolicy{{30, 300, 2}};
+            ReportingPolicy _outdoorTempPolicy{{60, 600, 5}};
+
             bool isPoweringOn = false;
             uint32_t powerOnRetryStartedMillis = 0;
             static constexpr uint32_t powerOnRetryTimeoutMillis = 60000;
 
+            void onClimateCommand(const char *payload);
+            void onSaveSceneCommand(const char *payload);
+            void onSceneCommand(const char *payload);
+            void onDeleteSceneCommand(const char *payload);
+            void onReportingCommand(const char *payload);
+
+            void loadReportingSettings();
+            void saveReportingSettings();
+            void publishReportingSettings();
+            ReportingPolicy* getReportingPolicy(uint16_t address);
+            bool shouldReport(const RegistryTable::Register *reg);
+            void reportPendingTemperatures();
+
             void startPowerOnRetry();
             void stopPowerOnRetry();
 
+            void registerControllerEntities();
+            void sendRegisterStates();
+            void publishRegisterState(const RegistryTable::Register *reg);
+            void registerFeatureEntity(const RegistryTable::Register *reg);
             void registerBaseEntities();
             void registerClimateEntity();
+            void registerSceneEntity();
             void registerSwitch(TFSXW1Controller::Address address);
-            void publishState(uint16_t address, const char* value);
+            bool publishState(uint16_t address, const char* value);
+
+            static const DiscoveryEntity* getEntities(size_t &count);
+            static const DiscoveryEntity& getEntity(const char *name);
+            static const FeatureRegistryRelation* getFeatureRelations(size_t &count);
 
+            static bool parseTemp(const char *value, double &temp);
             static const char* addressToString(uint16_t address);
             const char* valueToString(const RegistryTable::Register *reg);
 
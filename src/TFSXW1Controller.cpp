@@ -5,19 +5,20 @@
   Project home: https://github.com/Benas09/FujitsuAC
 */
 
-#pragma once
-
 #include "TFSXW1Controller.h"
+#include "Trace.h"
 
 namespace FujitsuAC {
 
-    TFSXW1Controller::TFSXW1Controller(Stream &uart): IFujitsuController(uart) {}
+    TFSXW1Controller::TFSXW1Controller(Stream &uart, Clock &clock): IFujitsuController(uart, clock) {
+        FUJITSU_TRACE_CLOCK(clock);
+    }
 
     void TFSXW1Controller::setup() {
         this->initRegistryTable();
 
         this->initialized = true;
-        this->lastRequestMillis = millis();
+        this->lastRequestMillis = this->clock.millis();
     }
 
     void TFSXW1Controller::loop() {
@@ -32,12 +33,16 @@ namespace FujitsuAC {
         });
     }
 
+    bool TFSXW1Controller::isWaitingForResponse() {
+        return !this->lastResponseReceived;
+    }
+
     void TFSXW1Controller::sendRequest() {
         if (this->terminated) {
             return;
         }
 
-        uint32_t now = millis();
+        uint32_t now = this->clock.millis();
 
         if (
             !this->lastResponseReceived
@@ -69,9 +74,7 @@ namespace FujitsuAC {
 
                     uint8_t payload[] = {0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFB};
                     this->debug("status", "Init1 Send");
-                    this->debug("send", this->toHexStr(payload, sizeof(payload)));
-
-                    uart.write(payload, sizeof(payload));
+                    this->writeFrame(payload, sizeof(payload));
 
                     break;
                 }
@@ -82,9 +85,7 @@ namespace FujitsuAC {
 
                     uint8_t payload[] = {0x01, 0x00, 0x00, 0x00, 0x04, 0x00, 0x04, 0x00, 0x01, 0xFF, 0xF5};
                     this->debug("status", "Init2 Send");
-                    this->debug("send", this->toHexStr(payload, sizeof(payload)));
-
-                    uart.write(payload, sizeof(payload));
+                    this->writeFrame(payload, sizeof(payload));
 
                     break;
                 }
@@ -158,7 +159,7 @@ namespace FujitsuAC {
             0x00, 
             0x00, 
             0x00, 
-            2 * frame.size,
+            static_cast<uint8_t>(2 * frame.size),
         };
 
         uint16_t checksum = 
@@ -167,7 +168,7 @@ namespace FujitsuAC {
             - (2 * frame.size)
         ;
 
-        for (int i = 0; i < frame.size; i++) {
+        for (size_t i = 0; i < frame.size; i++) {
             Address addr = frame.registries[i];
 
             int index = 5 + i * 2;
@@ -182,7 +183,7 @@ namespace FujitsuAC {
         request[bufferSize - 2] = (checksum >> 8) & 0xFF;
         request[bufferSize - 1] = checksum & 0xFF;
 
-        uart.write(request, bufferSize);
+        this->writeFrame(request, bufferSize);
     }
 
     void TFSXW1Controller::sendRegistries() {
@@ -197,7 +198,7 @@ namespace FujitsuAC {
             0x00, 
             0x00, 
             0x00, 
-            4 * frame.size,
+            static_cast<uint8_t>(4 * frame.size),
         };
 
         uint16_t checksum = 
@@ -206,7 +207,7 @@ namespace FujitsuAC {
             - (4 * frame.size)
         ;
 
-        for (int i = 0; i < frame.size; i++) {
+        for (size_t i = 0; i < frame.size; i++) {
             Address addr = frame.registries[i];
 
             int index = 5 + i * 4;
@@ -225,25 +226,40 @@ namespace FujitsuAC {
         request[bufferSize - 2] = (checksum >> 8) & 0xFF;
         request[bufferSize - 1] = checksum & 0xFF;
 
-        this->debug("send", this->toHexStr(request, bufferSize));
+        FUJITSU_TRACE_INSTANT("command_flush", BUS, frame.size);
+        this->writeFrame(request, bufferSize);
+    }
+
+    void TFSXW1Controller::writeFrame(const uint8_t *frame, size_t size) {
+        this->frameLog.capture(FrameLog::Direction::SENT, frame, size);
 
-        uart.write(request, bufferSize);
+        FUJITSU_TRACE_INSTANT("frame_tx", BUS, frame[0]);
+        FUJITSU_TRACE_BEGIN("bus_wait", BUS, size);
+
+        uart.write(frame, size);
     }
 
     void TFSXW1Controller::onFrame(uint8_t buffer[128], int size, bool isValid) {
+        FUJITSU_TRACE_END("bus_wait", BUS, size);
+        FUJITSU_TRACE_INSTANT("frame_rx", BUS, buffer[0]);
+
+        this->frameLog.capture(
+            isValid ? FrameLog::Direction::RECEIVED : FrameLog::Direction::INVALID,
+            buffer,
+            size
+        );
+
         if (!this->initialized) {
             return;
         }
 
         if (!isValid) {
-            this->debug("received", this->toHexStr(buffer, size));
             this->debug("error", "invalid checksum");
 
             return;
         }
 
         if (this->terminated) {
-            this->debug("received", this->toHexStr(buffer, size));
             this->debug("error", "after termination");
 
             return;
@@ -267,8 +283,6 @@ namespace FujitsuAC {
                     memcmp(buffer, expectedResponseAfterRestart[i], 8) == 0
                 ) {
                     // wait real initialization frame
-                    this->debug("received", this->toHexStr(buffer, size));
-
                     return;
                 }
             }
@@ -276,7 +290,6 @@ namespace FujitsuAC {
             uint8_t expectedResponse[8] = {0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0xFF, 0xFD};
 
             if (size != sizeof(expectedResponse) || memcmp(buffer, expectedResponse, sizeof(expectedResponse)) > 0) {
-                this->debug("received", this->toHexStr(buffer, size));
                 this->debug("error", "Unexpected response. Terminate");
                 this->debug("status", "Terminated Init1");
 
@@ -292,7 +305,6 @@ namespace FujitsuAC {
             uint8_t expectedResponse[8] = {0x01, 0x00, 0x00, 0x00, 0x01, 0x01, 0xFF, 0xFC};
 
             if (size != sizeof(expectedResponse) || memcmp(buffer, expectedResponse, sizeof(expectedResponse)) > 0) {
-                this->debug("received", this->toHexStr(buffer, size));
                 this->debug("error", "Unexpected response. Terminate");
                 this->debug("status", "Terminated Init2");
 
@@ -308,7 +320,6 @@ namespace FujitsuAC {
 
         if (0x03 == buffer[0]) {
             if (0x01 != buffer[5]) {
-                this->debug("received", this->toHexStr(buffer, size));
                 this->debug("error", "Invalid status");
             }
 
@@ -322,8 +333,6 @@ namespace FujitsuAC {
         }
 
         if (0x02 == buffer[0]) {
-            this->debug("received", this->toHexStr(buffer, size));
-
             if (0x01 != buffer[5]) {
                 this->debug("error", "Invalid status");
             }
@@ -349,11 +358,18 @@ namespace FujitsuAC {
             Address address = static_cast<Address>((static_cast<uint16_t>(addrHigh) << 8) | addrLow);
             RegistryTable::Register* reg = this->registryTable->getRegister(address);
 
+            if (nullptr == reg) {
+                // not requested by the controller, the frame is damaged despite its checksum
+                continue;
+            }
+
             if (reg->value != newValue) {
+#if FUJITSU_LOG_LEVEL >= FUJITSU_LOG_DEBUG
                 char hexStr[32];
                 snprintf(hexStr, sizeof(hexStr), "%04X | %04X -> %04X", reg->address, reg->value, newValue);
 
                 this->debug("changed", hexStr);
+#endif
 
                 reg->value = newValue;
 
@@ -723,4 +739,320 @@ namespace FujitsuAC {
         this->frameSendRegistries.registries[0] = Address::SetpointTemp;
         this->frameSendRegistries.values[0] = static_cast<uint16_t>(result);
     }
+
+    bool TFSXW1Controller::setClimate(const ClimateRequest &request) {
+        // everything is validated first, the request is either written as a whole or not at all
+        if (this->frameSendRegistries.size > 0) {
+            this->debug("warning", "Previous command is still pending");
+
+            return false;
+        }
+
+        bool isClimateChanged = request.hasMode
+            || request.hasTemp
+            || request.hasFanSpeed
+            || request.hasVerticalAirflow
+            || request.hasVerticalSwing
+            || request.hasHorizontalAirflow
+            || request.hasHorizontalSwing
+        ;
+
+        if (isClimateChanged && this->isCoilDryEnabled()) {
+            this->debug("info", "Coil dry is on");
+
+            return false;
+        }
+
+        if ((request.hasMode || request.hasTemp || request.hasFanSpeed) && this->isMinimumHeatEnabled()) {
+            this->debug("info", "Minimum heat is on");
+
+            return false;
+        }
+
+        uint16_t mode = request.hasMode
+            ? static_cast<uint16_t>(request.mode)
+            : this->registryTable->getRegister(Address::Mode)->value
+        ;
+
+        int temp = 0;
+
+        if (request.hasTemp) {
+            if (static_cast<uint16_t>(TFSXW1Enums::Mode::Fan) == mode) {
+                this->debug("info", "Fan mode enabled");
+
+                return false;
+            }
+
+            int minTemp = static_cast<uint16_t>(TFSXW1Enums::Mode::Heat) == mode
+                ? 160
+                : 180
+            ;
+
+            temp = static_cast<int>(request.temp * 10 + 0.5);
+            temp = (temp + 2) / 5 * 5;
+
+            if (temp < minTemp || temp > 300) {
+                this->debug("warning", "Temp is out of range");
+
+                return false;
+            }
+        }
+
+        if (request.hasVerticalAirflow) {
+            int position = static_cast<int>(request.verticalAirflow);
+
+            if (position > this->getVerticalAirflowDirectionCount()) {
+                this->debug("warning", "Vertical airflow is not supported");
+
+                return false;
+            }
+
+            if (request.hasVerticalSwing && TFSXW1Enums::VerticalSwing::On == request.verticalSwing) {
+                this->debug("warning", "Vertical airflow and swing given");
+
+                return false;
+            }
+        }
+
+        if (request.hasVerticalSwing && !this->isFeatureSupported(Address::VerticalSwingSupported)) {
+            this->debug("warning", "Vertical swing is not supported");
+
+            return false;
+        }
+
+        if (request.hasHorizontalAirflow) {
+            int position = static_cast<int>(request.horizontalAirflow);
+
+            if (position > this->getHorizontalAirflowDirectionCount()) {
+                this->debug("warning", "Horizontal airflow is not supported");
+
+                return false;
+            }
+
+            if (request.hasHorizontalSwing && TFSXW1Enums::HorizontalSwing::On == request.horizontalSwing) {
+                this->debug("warning", "Horizontal airflow and swing given");
+
+                return false;
+            }
+        }
+
+        if (request.hasHorizontalSwing && !this->isFeatureSupported(Address::HorizontalSwingSupported)) {
+            this->debug("warning", "Horizontal swing is not supported");
+
+            return false;
+        }
+
+        FrameSendRegistries frame = {FrameType::SendRegistries, 0, {}, {}};
+
+        auto add = [&frame](Address address, uint16_t value) {
+            frame.registries[frame.size] = address;
+            frame.values[frame.size] = value;
+            frame.size++;
+        };
+
+        if (request.hasPower) {
+            add(Address::Power, static_cast<uint16_t>(request.power));
+        }
+
+        if (request.hasMode) {
+            add(Address::Mode, mode);
+        }
+
+        if (request.hasTemp) {
+            add(Address::SetpointTemp, static_cast<uint16_t>(temp));
+        }
+
+        if (request.hasFanSpeed) {
+            add(Address::FanSpeed, static_cast<uint16_t>(request.fanSpeed));
+        }
+
+        if (request.hasVerticalAirflow) {
+            add(Address::VerticalSwing, static_cast<uint16_t>(TFSXW1Enums::VerticalSwing::Off));
+            add(Address::VerticalAirflowSetterRegistry, static_cast<uint16_t>(request.verticalAirflow));
+        } else if (request.hasVerticalSwing) {
+            add(Address::VerticalSwing, static_cast<uint16_t>(request.verticalSwing));
+        }
+
+        if (request.hasHorizontalAirflow) {
+            add(Address::HorizontalSwing, static_cast<uint16_t>(TFSXW1Enums::HorizontalSwing::Off));
+            add(Address::HorizontalAirflowSetterRegistry, static_cast<uint16_t>(request.horizontalAirflow));
+        } else if (request.hasHorizontalSwing) {
+            add(Address::HorizontalSwing, static_cast<uint16_t>(request.horizontalSwing));
+        }
+
+        if (0 == frame.size) {
+            return false;
+        }
+
+        // sent after the next FrameA and read back once with CheckRegistries
+        this->frameSendRegistries = frame;
+
+        return true;
+    }
+
+    size_t TFSXW1Controller::captureState(RegistryTable::Register *registers, size_t capacity) {
+        size_t size = 0;
+
+        auto add = [&](Address address, uint16_t value) {
+            if (size < capacity) {
+                registers[size++] = {address, value};
+            }
+        };
+
+        auto addCurrent = [&](Address address) {
+            add(address, this->registryTable->getRegister(address)->value);
+        };
+
+        addCurrent(Address::Power);
+        addCurrent(Address::Mode);
+
+        uint16_t temp = this->registryTable->getRegister(Address::SetpointTemp)->value;
+
+        if (temp >= 160 && temp <= 300) {
+            // 0xFFFF on fan mode
+            add(Address::SetpointTemp, temp);
+        }
+
+        addCurrent(Address::FanSpeed);
+
+        uint16_t verticalAirflow = this->registryTable->getRegister(Address::VerticalAirflow)->value;
+
+        if (
+            this->isFeatureSupported(Address::VerticalSwingSupported)
+            && static_cast<uint16_t>(TFSXW1Enums::VerticalSwing::On) == this->registryTable->getRegister(Address::VerticalSwing)->value
+        ) {
+            add(Address::VerticalSwing, static_cast<uint16_t>(TFSXW1Enums::VerticalSwing::On));
+        } else if (verticalAirflow >= 1 && verticalAirflow <= this->getVerticalAirflowDirectionCount()) {
+            add(Address::VerticalSwing, static_cast<uint16_t>(TFSXW1Enums::VerticalSwing::Off));
+            add(Address::VerticalAirflowSetterRegistry, verticalAirflow);
+        }
+
+        uint16_t horizontalAirflow = this->registryTable->getRegister(Address::HorizontalAirflow)->value;
+
+        if (
+            this->isFeatureSupported(Address::HorizontalSwingSupported)
+            && static_cast<uint16_t>(TFSXW1Enums::HorizontalSwing::On) == this->registryTable->getRegister(Address::HorizontalSwing)->value
+        ) {
+            add(Address::HorizontalSwing, static_cast<uint16_t>(TFSXW1Enums::HorizontalSwing::On));
+        } else if (horizontalAirflow >= 1 && horizontalAirflow <= this->getHorizontalAirflowDirectionCount()) {
+            add(Address::HorizontalSwing, static_cast<uint16_t>(TFSXW1Enums::HorizontalSwing::Off));
+            add(Address::HorizontalAirflowSetterRegistry, horizontalAirflow);
+        }
+
+        if (this->isFeatureSupported(Address::EconomyModeSupported)) {
+            addCurrent(Address::EconomyMode);
+        }
+
+        if (this->isFeatureSupported(Address::PowerfulSupported)) {
+            addCurrent(Address::Powerful);
+        }
+
+        return size;
+    }
+
+    bool TFSXW1Controller::restoreState(const RegistryTable::Register *registers, size_t size) {
+        if (this->frameSendRegistries.size > 0) {
+            this->debug("warning", "Previous command is still pending");
+
+            return false;
+        }
+
+        if (0 == size || size > sizeof(this->frameSendRegistries.registries) / sizeof(this->frameSendRegistries.registries[0])) {
+            return false;
+        }
+
+        if (this->isCoilDryEnabled()) {
+            this->debug("info", "Coil dry is on");
+
+            return false;
+        }
+
+        if (this->isMinimumHeatEnabled()) {
+            this->debug("info", "Minimum heat is on");
+
+            return false;
+        }
+
+        uint16_t mode = this->registryTable->getRegister(Address::Mode)->value;
+
+        for (size_t i = 0; i < size; i++) {
+            if (Address::Mode == registers[i].address) {
+                mode = registers[i].value;
+            }
+        }
+
+        for (size_t i = 0; i < size; i++) {
+            if (!this->isRestorable(registers[i], mode)) {
+                this->debug("warning", "Scene is not supported by this unit");
+
+                return false;
+            }
+        }
+
+        FrameSendRegistries frame = {FrameType::SendRegistries, size, {}, {}};
+
+        for (size_t i = 0; i < size; i++) {
+            frame.registries[i] = static_cast<Address>(registers[i].address);
+            frame.values[i] = registers[i].value;
+        }
+
+        this->frameSendRegistries = frame;
+
+        return true;
+    }
+
+    bool TFSXW1Controller::isRestorable(const RegistryTable::Register &reg, uint16_t mode) {
+        auto isSwitch = [&reg]() {
+            return reg.value <= 1;
+        };
+
+        switch (reg.address) {
+            case Address::Power:
+                return isSwitch();
+
+            case Address::Mode:
+                return reg.value <= static_cast<uint16_t>(TFSXW1Enums::Mode::Heat);
+
+            case Address::SetpointTemp:
+                return static_cast<uint16_t>(TFSXW1Enums::Mode::Fan) != mode
+                    && reg.value >= (static_cast<uint16_t>(TFSXW1Enums::Mode::Heat) == mode ? 160 : 180)
+                    && reg.value <= 300
+                    && 0 == reg.value % 5
+                ;
+
+            case Address::FanSpeed:
+                switch (static_cast<TFSXW1Enums::FanSpeed>(reg.value)) {
+                    case TFSXW1Enums::FanSpeed::Auto:
+                    case TFSXW1Enums::FanSpeed::Quiet:
+                    case TFSXW1Enums::FanSpeed::Low:
+                    case TFSXW1Enums::FanSpeed::Medium:
+                    case TFSXW1Enums::FanSpeed::High:
+                        return true;
+                    default:
+                        return false;
+                }
+
+            case Address::VerticalSwing:
+                return isSwitch() && (0 == reg.value || this->isFeatureSupported(Address::VerticalSwingSupported));
+
+            case Address::VerticalAirflowSetterRegistry:
+                return reg.value >= 1 && reg.value <= this->getVerticalAirflowDirectionCount();
+
+            case Address::HorizontalSwing:
+                return isSwitch() && (0 == reg.value || this->isFeatureSupported(Address::HorizontalSwingSupported));
+
+            case Address::HorizontalAirflowSetterRegistry:
+                return reg.value >= 1 && reg.value <= this->getHorizontalAirflowDirectionCount();
+
+            case Address::EconomyMode:
+                return isSwitch() && this->isFeatureSupported(Address::EconomyModeSupported);
+
+            case Address::Powerful:
+                return isSwitch() && this->isFeatureSupported(Address::PowerfulSupported);
+
+            default:
+                // captureState() never stores anything else
+                return false;
+        }
+    }
 }
\ No newline at end of file
@@ -184,7 +184,34 @@ namespace FujitsuAC {
                 Register44 = 0xF001,
             };
 
-            TFSXW1Controller(Stream &uart);
+            // Optional climate attributes written together in one frame
+            struct ClimateRequest {
+                bool hasPower = false;
+                TFSXW1Enums::Power power = TFSXW1Enums::Power::Off;
+
+                bool hasMode = false;
+                TFSXW1Enums::Mode mode = TFSXW1Enums::Mode::Auto;
+
+                bool hasTemp = false;
+                double temp = 0;
+
+                bool hasFanSpeed = false;
+                TFSXW1Enums::FanSpeed fanSpeed = TFSXW1Enums::FanSpeed::Auto;
+
+                bool hasVerticalAirflow = false;
+                TFSXW1Enums::VerticalAirflow verticalAirflow = TFSXW1Enums::VerticalAirflow::Position1;
+
+                bool hasVerticalSwing = false;
+                TFSXW1Enums::VerticalSwing verticalSwing = TFSXW1Enums::VerticalSwing::Off;
+
+                bool hasHorizontalAirflow = false;
+                TFSXW1Enums::HorizontalAirflow horizontalAirflow = TFSXW1Enums::HorizontalAirflow::Position1;
+
+                bool hasHorizontalSwing = false;
+                TFSXW1Enums::HorizontalSwing horizontalSwing = TFSXW1Enums::HorizontalSwing::Off;
+            };
+
+            TFSXW1Controller(Stream &uart, Clock &clock = Clock::system());
 
             void setup() override;
             void loop() override;
@@ -204,8 +231,14 @@ namespace FujitsuAC {
             void setCoilDry(TFSXW1Enums::CoilDry coilDry);
             void setHumanSensor(TFSXW1Enums::HumanSensor humanSensor);
             void setTemp(const char *temp);
+            bool setClimate(const ClimateRequest &request);
+
+            // Writable registers describing the current state, restoreState() writes them back in one frame
+            size_t captureState(RegistryTable::Register *registers, size_t capacity);
+            bool restoreState(const RegistryTable::Register *registers, size_t size);
 
             bool isPoweredOn();
+            bool isWaitingForResponse();
             bool isFeatureSupported(Address address);
             
             bool isPowerfulEnabled();
@@ -214,6 +247,8 @@ namespace FujitsuAC {
             int getHorizontalAirflowDirectionCount();
 
         private:
+            RegistryTable::Register registries[70];
+
             uint32_t lastRequestMillis = 0;
             bool lastResponseReceived = true;
             bool noResponseNotified = false;
@@ -351,11 +386,14 @@ namespace FujitsuAC {
             void sendRequest();
             void requestRegistries(Frame frame);
             void sendRegistries();
+            void writeFrame(const uint8_t *frame, size_t size);
             void onFrame(uint8_t buffer[128], int size, bool isValid);
+            // scenes come from NVS and may have been saved on another unit
+            bool isRestorable(const RegistryTable::Register &reg, uint16_t mode);
             void updateRegistries(uint8_t buffer[128], int size);
 
             void initRegistryTable() override {
-                static RegistryTable::Register registries[] = {
+                static const RegistryTable::Register defaults[] = {
                     {Address::Initial0, 0x0000},
                     {Address::Initial1, 0x0000},
                     
@@ -433,7 +471,11 @@ namespace FujitsuAC {
                     {Address::Register44, 0x0000},
                 };
 
-                this->registryTable = new RegistryTable(70, registries);
+                static_assert(sizeof(defaults) == sizeof(this->registries), "Register count mismatch");
+
+                // every controller keeps its own values, the defaults are shared
+                memcpy(this->registries, defaults, sizeof(this->registries));
+                this->registryTable = new RegistryTable(70, this->registries);
             }
     };
 
@@ -0,0 +1,117 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#include "Trace.h"
+
+#ifdef FUJITSU_TRACE
+
+namespace FujitsuAC {
+
+    Trace::Event Trace::_events[FUJITSU_TRACE_EVENTS];
+    Clock* Trace::_clock = &Clock::system();
+    size_t Trace::_head = 0;
+    size_t Trace::_count = 0;
+    uint32_t Trace::_overwritten = 0;
+
+    Trace::Scope::Scope(const char *name, Track track, uint32_t minDuration):
+        _name(name),
+        _track(track),
+        _minDuration(minDuration),
+        _start(_clock->micros())
+    {}
+
+    Trace::Scope::~Scope() {
+        uint32_t duration = _clock->micros() - _start;
+
+        if (duration >= _minDuration) {
+            Trace::complete(_name, _track, _start, duration);
+        }
+    }
+
+    void Trace::record(char phase, const char *name, Track track, uint16_t arg) {
+        Event &event = next();
+
+        event.timestamp = _clock->micros();
+        event.duration = 0;
+        event.name = name;
+        event.arg = arg;
+        event.track = track;
+        event.phase = phase;
+    }
+
+    void Trace::complete(const char *name, Track track, uint32_t start, uint32_t duration) {
+        Event &event = next();
+
+        event.timestamp = start;
+        event.duration = duration;
+        event.name = name;
+        event.arg = 0;
+        event.track = track;
+        event.phase = 'X';
+    }
+
+    void Trace::forEach(std::function<void(const Event &event)> onEvent) {
+        size_t tail = (_head + FUJITSU_TRACE_EVENTS - _count) % FUJITSU_TRACE_EVENTS;
+
+        for (size_t i = 0; i < _count; i++) {
+            onEvent(_events[(tail + i) % FUJITSU_TRACE_EVENTS]);
+        }
+    }
+
+    void Trace::clear() {
+        _head = 0;
+        _count = 0;
+    }
+
+    size_t Trace::toJson(const Event &event, char *out, size_t size) {
+        int length;
+
+        if ('X' == event.phase) {
+            length = snprintf(
+                out,
+                size,
+                "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lu,\"dur\":%lu,\"pid\":1,\"tid\":%u}",
+                event.name,
+                (unsigned long) event.timestamp,
+                (unsigned long) event.duration,
+                static_cast<uint8_t>(event.track)
+            );
+        } else {
+            // instants are scoped to their track
+            length = snprintf(
+                out,
+                size,
+                "{\"name\":\"%s\",\"ph\":\"%c\",%s\"ts\":%lu,\"pid\":1,\"tid\":%u,\"args\":{\"arg\":%u}}",
+                event.name,
+                event.phase,
+                'i' == event.phase ? "\"s\":\"t\"," : "",
+                (unsigned long) event.timestamp,
+                static_cast<uint8_t>(event.track),
+                event.arg
+            );
+        }
+
+        return length < 0 ? 0 : std::min<size_t>(length, size - 1);
+    }
+
+    Trace::Event& Trace::next() {
+        Event &event = _events[_head];
+
+        _head = (_head + 1) % FUJITSU_TRACE_EVENTS;
+
+        if (_count < FUJITSU_TRACE_EVENTS) {
+            _count++;
+        } else {
+            _overwritten++;
+        }
+
+        return event;
+    }
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,96 @@
+/*
+  FujitsuAC - ESP32 libary for controlling FujitsuAC through MQTT
+  Copyright (c) 2025 Benas Ragauskas. All rights reserved.
+  
+  Project home: https://github.com/Benas09/FujitsuAC
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "Clock.h"
+
+// Trace points are compiled in with -DFUJITSU_TRACE only
+#ifndef FUJITSU_TRACE_EVENTS
+#define FUJITSU_TRACE_EVENTS 512
+#endif
+
+namespace FujitsuAC {
+
+    // Fixed-size ring of timestamped events from the loop task, exported as
+    // Chrome trace event JSON (chrome://tracing, ui.perfetto.dev)
+    class Trace {
+        public:
+            enum class Track: uint8_t {
+                LOOP = 1,
+                BUS = 2,
+                MQTT = 3,
+            };
+
+            struct Event {
+                // micros() of the trace clock
+                uint32_t timestamp;
+                uint32_t duration;
+                // string literal, only the pointer is stored
+                const char *name;
+                uint16_t arg;
+                Track track;
+                // Chrome phase: 'i' instant, 'B' begin, 'E' end, 'X' complete
+                char phase;
+            };
+
+            // Records a complete event when destroyed, if it took at least minDuration µs
+            class Scope {
+                public:
+                    Scope(const char *name, Track track, uint32_t minDuration = 0);
+                    ~Scope();
+
+                private:
+                    const char *_name;
+                    Track _track;
+                    uint32_t _minDuration;
+                    uint32_t _start;
+            };
+
+            // Time source of the timestamps, the bridge and controller pass their own
+            // so the ring stays on the same timeline as their timers
+            static void setClock(Clock &clock) { _clock = &clock; }
+
+            static void record(char phase, const char *name, Track track, uint16_t arg = 0);
+            static void complete(const char *name, Track track, uint32_t start, uint32_t duration);
+
+            // Calls onEvent for every stored event, oldest first
+            static void forEach(std::function<void(const Event &event)> onEvent);
+            static void clear();
+
+            static size_t getCount() { return _count; }
+            static uint32_t getOverwrittenCount() { return _overwritten; }
+
+            // one trace event object, returns the length without the terminator
+            static size_t toJson(const Event &event, char *out, size_t size);
+
+        private:
+            static Event _events[FUJITSU_TRACE_EVENTS];
+            static Clock *_clock;
+            static size_t _head;
+            static size_t _count;
+            static uint32_t _overwritten;
+
+            static Event& next();
+    };
+
+}
+
+#ifdef FUJITSU_TRACE
+#define FUJITSU_TRACE_INSTANT(name, track, arg) ::FujitsuAC::Trace::record('i', name, ::FujitsuAC::Trace::Track::track, arg)
+#define FUJITSU_TRACE_BEGIN(name, track, arg) ::FujitsuAC::Trace::record('B', name, ::FujitsuAC::Trace::Track::track, arg)
+#define FUJITSU_TRACE_END(name, track, arg) ::FujitsuAC::Trace::record('E', name, ::FujitsuAC::Trace::Track::track, arg)
+#define FUJITSU_TRACE_SCOPE(name, track, minDuration) ::FujitsuAC::Trace::Scope traceScope(name, ::FujitsuAC::Trace::Track::track, minDuration)
+#define FUJITSU_TRACE_CLOCK(clock) ::FujitsuAC::Trace::setClock(clock)
+#else
+#define FUJITSU_TRACE_INSTANT(name, track, arg) ((void) 0)
+#define FUJITSU_TRACE_BEGIN(name, track, arg) ((void) 0)
+#define FUJITSU_TRACE_END(name, track, arg) ((void) 0)
+#define FUJITSU_TRACE_SCOPE(name, track, minDuration) ((void) 0)
+#define FUJITSU_TRACE_CLOCK(clock) ((void) 0)
+#endif
\ No newline at end of file